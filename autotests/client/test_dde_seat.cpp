@@ -0,0 +1,238 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+// Qt
+#include <QtTest>
+
+#include <linux/input.h>
+// client
+#include "../../src/client/connection_thread.h"
+#include "../../src/client/ddeseat.h"
+#include "../../src/client/event_queue.h"
+#include "../../src/client/registry.h"
+// server
+#include "../../src/server/clientconnection.h"
+#include "../../src/server/ddeseat_interface.h"
+#include "../../src/server/display.h"
+
+using namespace KWayland::Client;
+using namespace KWaylandServer;
+
+class TestDDESeat : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void init();
+    void cleanup();
+
+    void testMotionFilterRate();
+    void testMotionFilterRegion();
+    void testResetMotionFilter();
+    void testButtonFlushesMotion();
+    void testButtonsToAllPointers();
+
+private:
+    Display *m_display = nullptr;
+    DDESeatInterface *m_ddeSeatInterface = nullptr;
+    DDEPointerInterface *m_ddePointerInterface = nullptr;
+    ConnectionThread *m_connection = nullptr;
+    QThread *m_thread = nullptr;
+    EventQueue *m_queue = nullptr;
+    DDESeat *m_ddeSeat = nullptr;
+    DDEPointer *m_ddePointer = nullptr;
+};
+
+static const QString s_socketName = QStringLiteral("kwayland-test-dde-seat-0");
+
+void TestDDESeat::init()
+{
+    delete m_display;
+    m_display = new Display(this);
+    m_display->addSocketName(s_socketName);
+    m_display->start();
+    QVERIFY(m_display->isRunning());
+    m_ddeSeatInterface = new DDESeatInterface(m_display, m_display);
+
+    // setup connection
+    m_connection = new KWayland::Client::ConnectionThread;
+    QSignalSpy connectedSpy(m_connection, &ConnectionThread::connected);
+    QVERIFY(connectedSpy.isValid());
+    m_connection->setSocketName(s_socketName);
+
+    m_thread = new QThread(this);
+    m_connection->moveToThread(m_thread);
+    m_thread->start();
+
+    m_connection->initConnection();
+    QVERIFY(connectedSpy.wait());
+
+    m_queue = new EventQueue(this);
+    m_queue->setup(m_connection);
+
+    Registry registry;
+    QSignalSpy interfacesAnnouncedSpy(&registry, &Registry::interfacesAnnounced);
+    QVERIFY(interfacesAnnouncedSpy.isValid());
+    registry.setEventQueue(m_queue);
+    registry.create(m_connection);
+    QVERIFY(registry.isValid());
+    registry.setup();
+    QVERIFY(interfacesAnnouncedSpy.wait());
+
+    m_ddeSeat = registry.createDDESeat(registry.interface(Registry::Interface::DDESeat).name, registry.interface(Registry::Interface::DDESeat).version, this);
+    QVERIFY(m_ddeSeat->isValid());
+
+    QSignalSpy pointerCreatedSpy(m_ddeSeatInterface, &DDESeatInterface::ddePointerCreated);
+    QVERIFY(pointerCreatedSpy.isValid());
+    m_ddePointer = m_ddeSeat->createDDePointer(this);
+    QVERIFY(pointerCreatedSpy.wait());
+    m_ddePointerInterface = pointerCreatedSpy.first().first().value<DDEPointerInterface *>();
+    QVERIFY(m_ddePointerInterface);
+}
+
+void TestDDESeat::cleanup()
+{
+#define CLEANUP(variable)                                                                                                                                      \
+    if (variable) {                                                                                                                                            \
+        delete variable;                                                                                                                                       \
+        variable = nullptr;                                                                                                                                    \
+    }
+    CLEANUP(m_ddePointer)
+    CLEANUP(m_ddeSeat)
+    CLEANUP(m_queue)
+    if (m_connection) {
+        m_connection->deleteLater();
+        m_connection = nullptr;
+    }
+    if (m_thread) {
+        m_thread->quit();
+        m_thread->wait();
+        delete m_thread;
+        m_thread = nullptr;
+    }
+
+    CLEANUP(m_display)
+#undef CLEANUP
+
+    // these are the children of the display
+    m_ddeSeatInterface = nullptr;
+    m_ddePointerInterface = nullptr;
+}
+
+void TestDDESeat::testMotionFilterRate()
+{
+    // this test verifies that motion faster than the rate limit is coalesced into the latest position
+    QCOMPARE(m_display->connections().count(), 1);
+    m_ddePointerInterface->setMotionFilter(m_display->connections().constFirst(), 10);
+
+    QSignalSpy motionSpy(m_ddePointer, &DDEPointer::motion);
+    QVERIFY(motionSpy.isValid());
+    m_ddeSeatInterface->setPointerPos(QPointF(1, 1));
+    QVERIFY(motionSpy.wait());
+    QCOMPARE(motionSpy.count(), 1);
+    QCOMPARE(motionSpy.last().first().toPointF(), QPointF(1, 1));
+
+    // these are within the interval, only the latest one is delivered once it elapsed
+    m_ddeSeatInterface->setPointerPos(QPointF(2, 2));
+    m_ddeSeatInterface->setPointerPos(QPointF(3, 3));
+    QVERIFY(motionSpy.wait());
+    QCOMPARE(motionSpy.count(), 2);
+    QCOMPARE(motionSpy.last().first().toPointF(), QPointF(3, 3));
+    QVERIFY(!motionSpy.wait(200));
+}
+
+void TestDDESeat::testMotionFilterRegion()
+{
+    // this test verifies that only motion inside the region and the first motion leaving it is sent
+    m_ddePointerInterface->setMotionFilter(m_display->connections().constFirst(), 0, QRegion(0, 0, 10, 10));
+
+    QSignalSpy motionSpy(m_ddePointer, &DDEPointer::motion);
+    QVERIFY(motionSpy.isValid());
+    m_ddeSeatInterface->setPointerPos(QPointF(5, 5));
+    m_ddeSeatInterface->setPointerPos(QPointF(20, 20));
+    m_ddeSeatInterface->setPointerPos(QPointF(30, 30));
+    m_ddeSeatInterface->setPointerPos(QPointF(6, 6));
+    QTRY_COMPARE(motionSpy.count(), 3);
+    QCOMPARE(motionSpy.at(0).first().toPointF(), QPointF(5, 5));
+    QCOMPARE(motionSpy.at(1).first().toPointF(), QPointF(20, 20));
+    QCOMPARE(motionSpy.at(2).first().toPointF(), QPointF(6, 6));
+}
+
+void TestDDESeat::testResetMotionFilter()
+{
+    // this test verifies that resetting the filter delivers the held back motion and all motion after it
+    ClientConnection *client = m_display->connections().constFirst();
+    m_ddePointerInterface->setMotionFilter(client, 1);
+
+    QSignalSpy motionSpy(m_ddePointer, &DDEPointer::motion);
+    QVERIFY(motionSpy.isValid());
+    m_ddeSeatInterface->setPointerPos(QPointF(1, 1));
+    m_ddeSeatInterface->setPointerPos(QPointF(2, 2));
+    QVERIFY(motionSpy.wait());
+    QCOMPARE(motionSpy.count(), 1);
+
+    // the interval is one second, the held back motion must not wait for it
+    m_ddePointerInterface->resetMotionFilter(client);
+    m_ddeSeatInterface->setPointerPos(QPointF(3, 3));
+    m_ddeSeatInterface->setPointerPos(QPointF(4, 4));
+    QTRY_COMPARE_WITH_TIMEOUT(motionSpy.count(), 4, 500);
+    QCOMPARE(motionSpy.at(1).first().toPointF(), QPointF(2, 2));
+    QCOMPARE(motionSpy.at(2).first().toPointF(), QPointF(3, 3));
+    QCOMPARE(motionSpy.at(3).first().toPointF(), QPointF(4, 4));
+}
+
+void TestDDESeat::testButtonFlushesMotion()
+{
+    // this test verifies that a held back motion is delivered before a button event
+    m_ddePointerInterface->setMotionFilter(m_display->connections().constFirst(), 1);
+
+    QSignalSpy motionSpy(m_ddePointer, &DDEPointer::motion);
+    QVERIFY(motionSpy.isValid());
+    QSignalSpy buttonSpy(m_ddePointer, &DDEPointer::buttonStateChanged);
+    QVERIFY(buttonSpy.isValid());
+    int motionsBeforeButton = -1;
+    connect(m_ddePointer, &DDEPointer::buttonStateChanged, this, [&motionSpy, &motionsBeforeButton]() {
+        motionsBeforeButton = motionSpy.count();
+    });
+
+    m_ddeSeatInterface->setPointerPos(QPointF(1, 1));
+    m_ddeSeatInterface->setPointerPos(QPointF(2, 2));
+    m_ddeSeatInterface->pointerButtonPressed(BTN_LEFT);
+    QVERIFY(buttonSpy.wait());
+    QCOMPARE(motionsBeforeButton, 2);
+    QCOMPARE(motionSpy.last().first().toPointF(), QPointF(2, 2));
+    QCOMPARE(buttonSpy.first().first().toPointF(), QPointF(2, 2));
+}
+
+void TestDDESeat::testButtonsToAllPointers()
+{
+    // this test verifies that button and axis events reach every dde_pointer, like motion does
+    QSignalSpy motionSpy(m_ddePointer, &DDEPointer::motion);
+    QVERIFY(motionSpy.isValid());
+    QScopedPointer<DDEPointer> secondPointer(m_ddeSeat->createDDePointer());
+    QSignalSpy secondMotionSpy(secondPointer.data(), &DDEPointer::motion);
+    QVERIFY(secondMotionSpy.isValid());
+    QSignalSpy secondButtonSpy(secondPointer.data(), &DDEPointer::buttonStateChanged);
+    QVERIFY(secondButtonSpy.isValid());
+    QSignalSpy secondAxisSpy(secondPointer.data(), &DDEPointer::axisChanged);
+    QVERIFY(secondAxisSpy.isValid());
+    QSignalSpy buttonSpy(m_ddePointer, &DDEPointer::buttonStateChanged);
+    QVERIFY(buttonSpy.isValid());
+
+    // make sure the second pointer exists on the server
+    secondPointer->getMotion();
+    QVERIFY(motionSpy.wait());
+
+    m_ddeSeatInterface->setPointerPos(QPointF(5, 5));
+    m_ddeSeatInterface->pointerButtonPressed(BTN_LEFT);
+    m_ddeSeatInterface->pointerButtonReleased(BTN_LEFT);
+    m_ddeSeatInterface->pointerAxis(Qt::Vertical, 10);
+    QVERIFY(secondAxisSpy.wait());
+    QCOMPARE(secondMotionSpy.last().first().toPointF(), QPointF(5, 5));
+    QCOMPARE(secondButtonSpy.count(), 2);
+    QCOMPARE(secondButtonSpy.at(0).at(2).value<DDEPointer::ButtonState>(), DDEPointer::ButtonState::Pressed);
+    QCOMPARE(secondButtonSpy.at(1).at(2).value<DDEPointer::ButtonState>(), DDEPointer::ButtonState::Released);
+    QCOMPARE(buttonSpy.count(), 2);
+}
+
+QTEST_GUILESS_MAIN(TestDDESeat)
+#include "test_dde_seat.moc"
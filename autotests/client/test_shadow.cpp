@@ -32,6 +32,8 @@ private Q_SLOTS:
     void testCreateShadow();
     void testShadowElements();
     void testSurfaceDestroy();
+    void testContentKeys();
+    void testContentKeyWhileAccessingOtherBuffer();
 
 private:
     Display *m_display = nullptr;
@@ -271,5 +273,136 @@ void ShadowTest::testSurfaceDestroy()
     QCOMPARE(shadowDestroyedSpy.count(), 1);
 }
 
+void ShadowTest::testContentKeys()
+{
+    // this test verifies that shadows with identical tiles share their keys and that the keys
+    // get released once no shadow uses them any longer
+    QSignalSpy surfaceCreatedSpy(m_compositorInterface, &CompositorInterface::surfaceCreated);
+    QVERIFY(surfaceCreatedSpy.isValid());
+    QScopedPointer<Surface> surface1(m_compositor->createSurface());
+    QVERIFY(surfaceCreatedSpy.wait());
+    QScopedPointer<Surface> surface2(m_compositor->createSurface());
+    QVERIFY(surfaceCreatedSpy.wait());
+    auto serverSurface1 = surfaceCreatedSpy.first().first().value<SurfaceInterface *>();
+    auto serverSurface2 = surfaceCreatedSpy.last().first().value<SurfaceInterface *>();
+    QSignalSpy shadowChangedSpy1(serverSurface1, &SurfaceInterface::shadowChanged);
+    QVERIFY(shadowChangedSpy1.isValid());
+    QSignalSpy shadowChangedSpy2(serverSurface2, &SurfaceInterface::shadowChanged);
+    QVERIFY(shadowChangedSpy2.isValid());
+
+    QImage topImage(QSize(10, 10), QImage::Format_ARGB32_Premultiplied);
+    topImage.fill(Qt::black);
+    QImage leftImage(QSize(11, 11), QImage::Format_ARGB32_Premultiplied);
+    leftImage.fill(Qt::darkGray);
+
+    // both shadows get their own buffers with the same content
+    QScopedPointer<Shadow> shadow1(m_shadow->createShadow(surface1.data()));
+    shadow1->attachTop(m_shm->createBuffer(topImage));
+    shadow1->attachLeft(m_shm->createBuffer(leftImage));
+    shadow1->commit();
+    surface1->commit(Surface::CommitFlag::None);
+    QVERIFY(shadowChangedSpy1.wait());
+    QScopedPointer<Shadow> shadow2(m_shadow->createShadow(surface2.data()));
+    shadow2->attachTop(m_shm->createBuffer(topImage));
+    shadow2->attachLeft(m_shm->createBuffer(leftImage));
+    shadow2->commit();
+    surface2->commit(Surface::CommitFlag::None);
+    QVERIFY(shadowChangedSpy2.wait());
+
+    auto serverShadow1 = serverSurface1->shadow();
+    QVERIFY(serverShadow1);
+    auto serverShadow2 = serverSurface2->shadow();
+    QVERIFY(serverShadow2);
+    QVERIFY(serverShadow1->top() != serverShadow2->top());
+
+    const QByteArray topKey = serverShadow1->tileKey(ShadowInterface::Tile::Top);
+    QVERIFY(!topKey.isEmpty());
+    QCOMPARE(serverShadow2->tileKey(ShadowInterface::Tile::Top), topKey);
+    const QByteArray leftKey = serverShadow1->tileKey(ShadowInterface::Tile::Left);
+    QVERIFY(!leftKey.isEmpty());
+    QVERIFY(leftKey != topKey);
+    QVERIFY(serverShadow1->tileKey(ShadowInterface::Tile::Right).isEmpty());
+
+    const QByteArray contentKey = serverShadow1->contentKey();
+    QVERIFY(!contentKey.isEmpty());
+    QCOMPARE(serverShadow2->contentKey(), contentKey);
+    QCOMPARE(m_shadowInterface->keyUseCount(contentKey), 2);
+    QCOMPARE(m_shadowInterface->keyUseCount(topKey), 2);
+    QCOMPARE(m_shadowInterface->keyUseCount(leftKey), 2);
+
+    // destroying one of the shadows keeps the keys in use
+    QSignalSpy keyReleasedSpy(m_shadowInterface, &ShadowManagerInterface::keyReleased);
+    QVERIFY(keyReleasedSpy.isValid());
+    QSignalSpy shadowDestroyedSpy(serverShadow2.data(), &QObject::destroyed);
+    QVERIFY(shadowDestroyedSpy.isValid());
+    shadow2.reset();
+    QVERIFY(shadowDestroyedSpy.wait());
+    QVERIFY(keyReleasedSpy.isEmpty());
+    QCOMPARE(m_shadowInterface->keyUseCount(contentKey), 1);
+    QCOMPARE(m_shadowInterface->keyUseCount(topKey), 1);
+
+    // replacing a tile of the remaining shadow releases the old keys
+    QImage otherTopImage(QSize(10, 10), QImage::Format_ARGB32_Premultiplied);
+    otherTopImage.fill(Qt::white);
+    shadow1->attachTop(m_shm->createBuffer(otherTopImage));
+    shadow1->commit();
+    QVERIFY(keyReleasedSpy.wait());
+    QTRY_COMPARE(keyReleasedSpy.count(), 2);
+    QCOMPARE(keyReleasedSpy.at(0).first().toByteArray(), topKey);
+    QCOMPARE(keyReleasedSpy.at(1).first().toByteArray(), contentKey);
+    QCOMPARE(m_shadowInterface->keyUseCount(contentKey), 0);
+    QCOMPARE(m_shadowInterface->keyUseCount(leftKey), 1);
+
+    const QByteArray otherTopKey = serverShadow1->tileKey(ShadowInterface::Tile::Top);
+    QVERIFY(!otherTopKey.isEmpty());
+    QVERIFY(otherTopKey != topKey);
+    QVERIFY(serverShadow1->contentKey() != contentKey);
+}
+
+void ShadowTest::testContentKeyWhileAccessingOtherBuffer()
+{
+    // this test verifies that a key requested while the data of another shm buffer is accessed
+    // is not cached as empty
+    QSignalSpy surfaceCreatedSpy(m_compositorInterface, &CompositorInterface::surfaceCreated);
+    QVERIFY(surfaceCreatedSpy.isValid());
+    QScopedPointer<Surface> surface(m_compositor->createSurface());
+    QVERIFY(surfaceCreatedSpy.wait());
+    auto serverSurface = surfaceCreatedSpy.first().first().value<SurfaceInterface *>();
+    QSignalSpy shadowChangedSpy(serverSurface, &SurfaceInterface::shadowChanged);
+    QVERIFY(shadowChangedSpy.isValid());
+
+    QImage topImage(QSize(10, 10), QImage::Format_ARGB32_Premultiplied);
+    topImage.fill(Qt::black);
+    QImage leftImage(QSize(11, 11), QImage::Format_ARGB32_Premultiplied);
+    leftImage.fill(Qt::darkGray);
+    QScopedPointer<Shadow> shadow(m_shadow->createShadow(surface.data()));
+    shadow->attachTop(m_shm->createBuffer(topImage));
+    shadow->attachLeft(m_shm->createBuffer(leftImage));
+    shadow->commit();
+    surface->commit(Surface::CommitFlag::None);
+    QVERIFY(shadowChangedSpy.wait());
+    auto serverShadow = serverSurface->shadow();
+    QVERIFY(serverShadow);
+
+    // only one shm buffer can be accessed at a time
+    QImage left = qobject_cast<ShmClientBuffer *>(serverShadow->left())->data();
+    QVERIFY(!left.isNull());
+    QVERIFY(serverShadow->tileKey(ShadowInterface::Tile::Top).isEmpty());
+    QVERIFY(serverShadow->contentKey().isEmpty());
+    // the accessed buffer itself can still be read
+    const QByteArray leftKey = serverShadow->tileKey(ShadowInterface::Tile::Left);
+    QVERIFY(!leftKey.isEmpty());
+
+    left = QImage();
+    const QByteArray topKey = serverShadow->tileKey(ShadowInterface::Tile::Top);
+    QVERIFY(!topKey.isEmpty());
+    QVERIFY(topKey != leftKey);
+    const QByteArray contentKey = serverShadow->contentKey();
+    QVERIFY(!contentKey.isEmpty());
+    QCOMPARE(m_shadowInterface->keyUseCount(topKey), 1);
+    QCOMPARE(m_shadowInterface->keyUseCount(leftKey), 1);
+    QCOMPARE(m_shadowInterface->keyUseCount(contentKey), 1);
+}
+
 QTEST_GUILESS_MAIN(ShadowTest)
 #include "test_shadow.moc"
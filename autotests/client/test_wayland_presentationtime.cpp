@@ -0,0 +1,250 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+// Qt
+#include <QtTest>
+// KWin
+#include "../../src/client/compositor.h"
+#include "../../src/client/connection_thread.h"
+#include "../../src/client/event_queue.h"
+#include "../../src/client/presentationtime.h"
+#include "../../src/client/registry.h"
+#include "../../src/client/surface.h"
+#include "../../src/server/compositor_interface.h"
+#include "../../src/server/display.h"
+#include "../../src/server/presentationtime_interface.h"
+#include "../../src/server/surface_interface.h"
+
+#include <time.h>
+
+using namespace KWayland::Client;
+using namespace std::chrono_literals;
+
+class TestPresentationTime : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TestPresentationTime(QObject *parent = nullptr);
+private Q_SLOTS:
+    void init();
+    void cleanup();
+
+    void testClockId();
+    void testPresented();
+    void testDiscarded();
+    void testSuperseded();
+
+private:
+    KWaylandServer::SurfaceInterface *createSurface(QScopedPointer<Surface> &surface);
+
+    KWaylandServer::Display *m_display;
+    KWaylandServer::CompositorInterface *m_compositorInterface;
+    KWaylandServer::PresentationTimeInterface *m_presentationTimeInterface;
+    KWayland::Client::ConnectionThread *m_connection;
+    KWayland::Client::Compositor *m_compositor;
+    KWayland::Client::PresentationTime *m_presentationTime;
+    KWayland::Client::EventQueue *m_queue;
+    QThread *m_thread;
+};
+
+static const QString s_socketName = QStringLiteral("kwayland-test-wayland-presentationtime-0");
+// the compositor reports the presentation with a made up clock
+static const quint32 s_fakeClockId = CLOCK_MONOTONIC_RAW;
+
+TestPresentationTime::TestPresentationTime(QObject *parent)
+    : QObject(parent)
+    , m_display(nullptr)
+    , m_compositorInterface(nullptr)
+    , m_presentationTimeInterface(nullptr)
+    , m_connection(nullptr)
+    , m_compositor(nullptr)
+    , m_presentationTime(nullptr)
+    , m_queue(nullptr)
+    , m_thread(nullptr)
+{
+}
+
+void TestPresentationTime::init()
+{
+    using namespace KWaylandServer;
+    delete m_display;
+    m_display = new Display(this);
+    m_display->addSocketName(s_socketName);
+    m_display->start();
+    QVERIFY(m_display->isRunning());
+
+    m_compositorInterface = new CompositorInterface(m_display, m_display);
+    m_presentationTimeInterface = new PresentationTimeInterface(m_display, m_display);
+    QCOMPARE(m_presentationTimeInterface->clockId(), quint32(CLOCK_MONOTONIC));
+    m_presentationTimeInterface->setClockId(s_fakeClockId);
+
+    // setup connection
+    m_connection = new KWayland::Client::ConnectionThread;
+    QSignalSpy connectedSpy(m_connection, &ConnectionThread::connected);
+    QVERIFY(connectedSpy.isValid());
+    m_connection->setSocketName(s_socketName);
+
+    m_thread = new QThread(this);
+    m_connection->moveToThread(m_thread);
+    m_thread->start();
+
+    m_connection->initConnection();
+    QVERIFY(connectedSpy.wait());
+
+    m_queue = new KWayland::Client::EventQueue(this);
+    m_queue->setup(m_connection);
+    QVERIFY(m_queue->isValid());
+
+    Registry registry;
+    QSignalSpy interfacesAnnouncedSpy(&registry, &Registry::interfacesAnnounced);
+    QVERIFY(interfacesAnnouncedSpy.isValid());
+    registry.setEventQueue(m_queue);
+    registry.create(m_connection->display());
+    QVERIFY(registry.isValid());
+    registry.setup();
+    QVERIFY(interfacesAnnouncedSpy.wait());
+
+    const auto compositor = registry.interface(Registry::Interface::Compositor);
+    m_compositor = registry.createCompositor(compositor.name, compositor.version, this);
+    QVERIFY(m_compositor->isValid());
+
+    const auto presentation = registry.interface(Registry::Interface::PresentationTime);
+    QVERIFY(presentation.name != 0);
+    m_presentationTime = registry.createPresentationTime(presentation.name, presentation.version, this);
+    QVERIFY(m_presentationTime->isValid());
+}
+
+void TestPresentationTime::cleanup()
+{
+#define CLEANUP(variable)                                                                                                                                      \
+    if (variable) {                                                                                                                                            \
+        delete variable;                                                                                                                                       \
+        variable = nullptr;                                                                                                                                    \
+    }
+    CLEANUP(m_compositor)
+    CLEANUP(m_presentationTime)
+    CLEANUP(m_queue)
+    if (m_connection) {
+        m_connection->deleteLater();
+        m_connection = nullptr;
+    }
+    if (m_thread) {
+        m_thread->quit();
+        m_thread->wait();
+        delete m_thread;
+        m_thread = nullptr;
+    }
+    CLEANUP(m_display)
+#undef CLEANUP
+
+    // these are the children of the display
+    m_compositorInterface = nullptr;
+    m_presentationTimeInterface = nullptr;
+}
+
+KWaylandServer::SurfaceInterface *TestPresentationTime::createSurface(QScopedPointer<Surface> &surface)
+{
+    QSignalSpy serverSurfaceCreated(m_compositorInterface, &KWaylandServer::CompositorInterface::surfaceCreated);
+    surface.reset(m_compositor->createSurface());
+    if (!serverSurfaceCreated.wait()) {
+        return nullptr;
+    }
+    return serverSurfaceCreated.first().first().value<KWaylandServer::SurfaceInterface *>();
+}
+
+void TestPresentationTime::testClockId()
+{
+    // the clock id is announced right after binding
+    if (m_presentationTime->clockId() == 0) {
+        QSignalSpy clockIdSpy(m_presentationTime, &PresentationTime::clockIdAnnounced);
+        QVERIFY(clockIdSpy.wait());
+        QCOMPARE(clockIdSpy.first().first().value<quint32>(), s_fakeClockId);
+    }
+    QCOMPARE(m_presentationTime->clockId(), s_fakeClockId);
+}
+
+void TestPresentationTime::testPresented()
+{
+    QScopedPointer<Surface> surface;
+    KWaylandServer::SurfaceInterface *serverSurface = createSurface(surface);
+    QVERIFY(serverSurface);
+    QSignalSpy committedSpy(serverSurface, &KWaylandServer::SurfaceInterface::committed);
+
+    QScopedPointer<PresentationFeedback> feedback(m_presentationTime->createFeedback(surface.data()));
+    QVERIFY(feedback->isValid());
+    QSignalSpy presentedSpy(feedback.data(), &PresentationFeedback::presented);
+    QSignalSpy discardedSpy(feedback.data(), &PresentationFeedback::discarded);
+    surface->commit(Surface::CommitFlag::None);
+    QVERIFY(committedSpy.wait());
+    QVERIFY(serverSurface->hasPresentationFeedback());
+
+    // report the presentation with timestamps of the fake clock
+    const std::chrono::nanoseconds timestamp = 0x123456789s + 987654321ns;
+    const std::chrono::nanoseconds refresh = 16666666ns;
+    const quint64 sequence = 0x100000002;
+    serverSurface->presented(nullptr,
+                             timestamp,
+                             refresh,
+                             sequence,
+                             KWaylandServer::SurfaceInterface::PresentationKind::VSync | KWaylandServer::SurfaceInterface::PresentationKind::HwClock);
+    QVERIFY(!serverSurface->hasPresentationFeedback());
+
+    QVERIFY(presentedSpy.wait());
+    QVERIFY(discardedSpy.isEmpty());
+    QVERIFY(!feedback->isValid());
+    QCOMPARE(feedback->timestamp(), timestamp);
+    QCOMPARE(feedback->refresh(), refresh);
+    QCOMPARE(feedback->sequence(), sequence);
+    QCOMPARE(feedback->kinds(), PresentationFeedback::Kind::VSync | PresentationFeedback::Kind::HwClock);
+    QVERIFY(!feedback->output());
+}
+
+void TestPresentationTime::testDiscarded()
+{
+    QScopedPointer<Surface> surface;
+    KWaylandServer::SurfaceInterface *serverSurface = createSurface(surface);
+    QVERIFY(serverSurface);
+    QSignalSpy committedSpy(serverSurface, &KWaylandServer::SurfaceInterface::committed);
+
+    QScopedPointer<PresentationFeedback> feedback(m_presentationTime->createFeedback(surface.data()));
+    QSignalSpy presentedSpy(feedback.data(), &PresentationFeedback::presented);
+    QSignalSpy discardedSpy(feedback.data(), &PresentationFeedback::discarded);
+    surface->commit(Surface::CommitFlag::None);
+    QVERIFY(committedSpy.wait());
+
+    serverSurface->discardPresentationFeedback();
+    QVERIFY(!serverSurface->hasPresentationFeedback());
+    QVERIFY(discardedSpy.wait());
+    QVERIFY(presentedSpy.isEmpty());
+    QVERIFY(!feedback->isValid());
+}
+
+void TestPresentationTime::testSuperseded()
+{
+    // a content update that is replaced before being presented gets discarded
+    QScopedPointer<Surface> surface;
+    KWaylandServer::SurfaceInterface *serverSurface = createSurface(surface);
+    QVERIFY(serverSurface);
+    QSignalSpy committedSpy(serverSurface, &KWaylandServer::SurfaceInterface::committed);
+
+    QScopedPointer<PresentationFeedback> first(m_presentationTime->createFeedback(surface.data()));
+    QSignalSpy firstPresentedSpy(first.data(), &PresentationFeedback::presented);
+    QSignalSpy firstDiscardedSpy(first.data(), &PresentationFeedback::discarded);
+    surface->commit(Surface::CommitFlag::None);
+    QVERIFY(committedSpy.wait());
+
+    QScopedPointer<PresentationFeedback> second(m_presentationTime->createFeedback(surface.data()));
+    QSignalSpy secondPresentedSpy(second.data(), &PresentationFeedback::presented);
+    surface->commit(Surface::CommitFlag::None);
+    QVERIFY(firstDiscardedSpy.wait());
+    QVERIFY(firstPresentedSpy.isEmpty());
+
+    serverSurface->presented(nullptr, 10ms, 0ns, 0, KWaylandServer::SurfaceInterface::PresentationKinds());
+    QVERIFY(secondPresentedSpy.wait());
+    QCOMPARE(second->timestamp(), 10ms);
+    QCOMPARE(second->kinds(), PresentationFeedback::Kinds());
+    QCOMPARE(firstPresentedSpy.count(), 0);
+}
+
+QTEST_GUILESS_MAIN(TestPresentationTime)
+#include "test_wayland_presentationtime.moc"
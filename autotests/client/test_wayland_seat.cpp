@@ -6,6 +6,7 @@
 // Qt
 #include <QtTest>
 // KWin
+#include "../../src/server/clientconnection.h"
 #include "../../src/server/compositor_interface.h"
 #include "../../src/server/datadevicemanager_interface.h"
 #include "../../src/server/datasource_interface.h"
@@ -75,6 +76,8 @@ private Q_SLOTS:
     void testSelection();
     void testDataDeviceForKeyboardSurface();
     void testTouch();
+    void testTouchFrame();
+    void testImmediateInputFlush();
     void testKeymap();
 
 private:
@@ -2065,6 +2068,147 @@ void TestWaylandSeat::testTouch()
     QCOMPARE(touch->sequence().first()->position(), QPointF(0, 0));
 }
 
+void TestWaylandSeat::testTouchFrame()
+{
+    using namespace KWayland::Client;
+    using namespace KWaylandServer;
+
+    QSignalSpy touchSpy(m_seat, &KWayland::Client::Seat::hasTouchChanged);
+    QVERIFY(touchSpy.isValid());
+    m_seatInterface->setHasTouch(true);
+    QVERIFY(touchSpy.wait());
+
+    QSignalSpy surfaceCreatedSpy(m_compositorInterface, &KWaylandServer::CompositorInterface::surfaceCreated);
+    QVERIFY(surfaceCreatedSpy.isValid());
+    QScopedPointer<Surface> s(m_compositor->createSurface());
+    QVERIFY(surfaceCreatedSpy.wait());
+    SurfaceInterface *serverSurface = surfaceCreatedSpy.first().first().value<KWaylandServer::SurfaceInterface *>();
+    QVERIFY(serverSurface);
+    m_seatInterface->setFocusedTouchSurface(serverSurface, QPointF(10, 20));
+
+    QScopedPointer<Touch> touch(m_seat->createTouch());
+    QVERIFY(touch->isValid());
+
+    // Process wl_touch bind request.
+    wl_display_flush(m_connection->display());
+    QCoreApplication::processEvents();
+
+    QSignalSpy frameEndedSpy(touch.data(), &KWayland::Client::Touch::frameEnded);
+    QVERIFY(frameEndedSpy.isValid());
+    QSignalSpy sequenceEndedSpy(touch.data(), &KWayland::Client::Touch::sequenceEnded);
+    QVERIFY(sequenceEndedSpy.isValid());
+    QSignalSpy touchMovedSpy(m_seatInterface, &SeatInterface::touchMoved);
+    QVERIFY(touchMovedSpy.isValid());
+
+    using Point = SeatInterface::TouchPoint;
+
+    // all ten fingers go down within one frame
+    QVector<Point> points;
+    for (int i = 0; i < 10; ++i) {
+        points.append(Point{i, Point::State::Down, QPointF(10 + i, 20 + i)});
+    }
+    m_seatInterface->setTimestamp(1);
+    m_seatInterface->notifyTouchFrame(points);
+    QVERIFY(frameEndedSpy.wait());
+    QCOMPARE(frameEndedSpy.count(), 1);
+    QVERIFY(m_seatInterface->isTouchSequence());
+    QCOMPARE(m_seatInterface->firstTouchPointPosition(), QPointF(10, 20));
+    QCOMPARE(touch->sequence().count(), 10);
+    for (int i = 0; i < 10; ++i) {
+        QCOMPARE(touch->sequence().at(i)->id(), i);
+        QCOMPARE(touch->sequence().at(i)->position(), QPointF(i, i));
+        QVERIFY(touch->sequence().at(i)->isDown());
+    }
+
+    // move all of them, a point that never went down is skipped
+    points.clear();
+    for (int i = 0; i < 10; ++i) {
+        points.append(Point{i, Point::State::Motion, QPointF(20 + i, 30)});
+    }
+    points.append(Point{42, Point::State::Motion, QPointF(0, 0)});
+    m_seatInterface->setTimestamp(2);
+    m_seatInterface->notifyTouchFrame(points);
+    QVERIFY(frameEndedSpy.wait());
+    QCOMPARE(frameEndedSpy.count(), 2);
+    QCOMPARE(touchMovedSpy.count(), 10);
+    QCOMPARE(m_seatInterface->firstTouchPointPosition(), QPointF(20, 30));
+    for (int i = 0; i < 10; ++i) {
+        QCOMPARE(touch->sequence().at(i)->position(), QPointF(10 + i, 10));
+        QCOMPARE(touch->sequence().at(i)->time(), 2u);
+    }
+
+    // lift the fingers in a different order than they went down
+    points.clear();
+    for (int i = 9; i >= 0; --i) {
+        points.append(Point{i, Point::State::Up, QPointF()});
+    }
+    m_seatInterface->setTimestamp(3);
+    m_seatInterface->notifyTouchFrame(points);
+    QVERIFY(frameEndedSpy.wait());
+    QCOMPARE(frameEndedSpy.count(), 3);
+    QCOMPARE(sequenceEndedSpy.count(), 1);
+    QVERIFY(!m_seatInterface->isTouchSequence());
+    for (int i = 0; i < 10; ++i) {
+        QVERIFY(!touch->sequence().at(i)->isDown());
+    }
+}
+
+void TestWaylandSeat::testImmediateInputFlush()
+{
+    using namespace KWayland::Client;
+    using namespace KWaylandServer;
+
+    QSignalSpy hasPointerChangedSpy(m_seat, &Seat::hasPointerChanged);
+    m_seatInterface->setHasPointer(true);
+    QVERIFY(hasPointerChangedSpy.wait());
+    QScopedPointer<Pointer> pointer(m_seat->createPointer());
+    QVERIFY(pointer);
+
+    QSignalSpy surfaceCreatedSpy(m_compositorInterface, &CompositorInterface::surfaceCreated);
+    QScopedPointer<Surface> surface(m_compositor->createSurface());
+    QVERIFY(surfaceCreatedSpy.wait());
+    auto serverSurface = surfaceCreatedSpy.first().first().value<SurfaceInterface *>();
+    QVERIFY(serverSurface);
+    QImage image(QSize(100, 100), QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::black);
+    surface->attachBuffer(m_shm->createBuffer(image));
+    surface->damage(image.rect());
+    surface->commit(Surface::CommitFlag::None);
+    QSignalSpy committedSpy(serverSurface, &SurfaceInterface::committed);
+    QVERIFY(committedSpy.wait());
+
+    m_seatInterface->setFocusedPointerSurface(serverSurface);
+    QSignalSpy frameSpy(pointer.data(), &Pointer::frame);
+    QVERIFY(frameSpy.wait());
+
+    // the statistics tell whether the events are still waiting in the outgoing buffer
+    m_display->setClientStatisticsEnabled(true);
+    ClientConnection *connection = serverSurface->client();
+    connection->flush();
+    QVERIFY(m_seatInterface->isImmediateInputFlush());
+
+    m_seatInterface->setImmediateInputFlush(false);
+    QVERIFY(!m_seatInterface->isImmediateInputFlush());
+    m_seatInterface->setTimestamp(1);
+    m_seatInterface->notifyPointerMotion(QPointF(10, 10));
+    m_seatInterface->notifyPointerFrame();
+    QVERIFY(connection->statistics().pendingEventBytes > 0);
+    QVERIFY(frameSpy.wait());
+    QCOMPARE(connection->statistics().pendingEventBytes, quint64(0));
+
+    // the frame writes motion and frame to the socket right away
+    m_seatInterface->setImmediateInputFlush(true);
+    const quint64 events = connection->statistics().events;
+    m_seatInterface->setTimestamp(2);
+    m_seatInterface->notifyPointerMotion(QPointF(20, 20));
+    QVERIFY(connection->statistics().pendingEventBytes > 0);
+    m_seatInterface->notifyPointerFrame();
+    QCOMPARE(connection->statistics().events, events + 2);
+    QCOMPARE(connection->statistics().pendingEventBytes, quint64(0));
+    QVERIFY(frameSpy.wait());
+    QCOMPARE(pointer->enteredSurface(), surface.data());
+}
+
 void TestWaylandSeat::testKeymap()
 {
     using namespace KWayland::Client;
@@ -2113,6 +2257,26 @@ void TestWaylandSeat::testKeymap()
     address = reinterpret_cast<char *>(file.map(0, keymapChangedSpy.first().last().value<quint32>()));
     QVERIFY(address);
     QCOMPARE(qstrcmp(address, "bar"), 0);
+    file.close();
+
+    // a keymap compressed by releasing the caches still reaches new keyboards
+    const QByteArray longKeymap = QByteArrayLiteral("xkb_keymap { xkb_keycodes { include \"evdev+aliases(qwerty)\" }; };\n").repeated(100);
+    keymapChangedSpy.clear();
+    m_seatInterface->keyboard()->setKeymap(longKeymap);
+    QVERIFY(keymapChangedSpy.wait());
+    QVERIFY(m_display->releaseCaches(Display::MemoryPressure::Moderate) > 0);
+
+    QScopedPointer<Keyboard> secondKeyboard(m_seat->createKeyboard());
+    QSignalSpy secondKeymapChangedSpy(secondKeyboard.data(), &Keyboard::keymapChanged);
+    QVERIFY(secondKeymapChangedSpy.isValid());
+    QVERIFY(secondKeymapChangedSpy.wait());
+    fd = secondKeymapChangedSpy.first().first().toInt();
+    QVERIFY(fd != -1);
+    QCOMPARE(secondKeymapChangedSpy.first().last().value<quint32>(), quint32(longKeymap.size()));
+    QVERIFY(file.open(fd, QIODevice::ReadOnly));
+    address = reinterpret_cast<char *>(file.map(0, longKeymap.size()));
+    QVERIFY(address);
+    QCOMPARE(QByteArray(address, longKeymap.size()), longKeymap);
 }
 
 QTEST_GUILESS_MAIN(TestWaylandSeat)
@@ -0,0 +1,217 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+// Qt
+#include <QtTest>
+// KWin
+#include "../../src/client/compositor.h"
+#include "../../src/client/connection_thread.h"
+#include "../../src/client/event_queue.h"
+#include "../../src/client/registry.h"
+#include "../../src/client/singlepixelbuffer.h"
+#include "../../src/client/surface.h"
+#include "../../src/server/compositor_interface.h"
+#include "../../src/server/display.h"
+#include "../../src/server/singlepixelbufferv1clientbuffer.h"
+#include "../../src/server/surface_interface.h"
+
+#include <wayland-client-protocol.h>
+
+using namespace KWayland::Client;
+
+class TestSinglePixelBuffer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TestSinglePixelBuffer(QObject *parent = nullptr);
+private Q_SLOTS:
+    void init();
+    void cleanup();
+
+    void testAttach_data();
+    void testAttach();
+    void testDestroyBuffer();
+
+private:
+    KWaylandServer::SurfaceInterface *createSurface(QScopedPointer<Surface> &surface);
+
+    KWaylandServer::Display *m_display;
+    KWaylandServer::CompositorInterface *m_compositorInterface;
+    KWaylandServer::SinglePixelBufferV1ClientBufferIntegration *m_singlePixelBufferIntegration;
+    KWayland::Client::ConnectionThread *m_connection;
+    KWayland::Client::Compositor *m_compositor;
+    KWayland::Client::SinglePixelBufferManager *m_singlePixelBufferManager;
+    KWayland::Client::EventQueue *m_queue;
+    QThread *m_thread;
+};
+
+static const QString s_socketName = QStringLiteral("kwayland-test-wayland-singlepixelbuffer-0");
+
+TestSinglePixelBuffer::TestSinglePixelBuffer(QObject *parent)
+    : QObject(parent)
+    , m_display(nullptr)
+    , m_compositorInterface(nullptr)
+    , m_singlePixelBufferIntegration(nullptr)
+    , m_connection(nullptr)
+    , m_compositor(nullptr)
+    , m_singlePixelBufferManager(nullptr)
+    , m_queue(nullptr)
+    , m_thread(nullptr)
+{
+}
+
+void TestSinglePixelBuffer::init()
+{
+    using namespace KWaylandServer;
+    delete m_display;
+    m_display = new Display(this);
+    m_display->addSocketName(s_socketName);
+    m_display->start();
+    QVERIFY(m_display->isRunning());
+
+    m_compositorInterface = new CompositorInterface(m_display, m_display);
+    m_singlePixelBufferIntegration = new SinglePixelBufferV1ClientBufferIntegration(m_display);
+
+    // setup connection
+    m_connection = new KWayland::Client::ConnectionThread;
+    QSignalSpy connectedSpy(m_connection, &ConnectionThread::connected);
+    QVERIFY(connectedSpy.isValid());
+    m_connection->setSocketName(s_socketName);
+
+    m_thread = new QThread(this);
+    m_connection->moveToThread(m_thread);
+    m_thread->start();
+
+    m_connection->initConnection();
+    QVERIFY(connectedSpy.wait());
+
+    m_queue = new KWayland::Client::EventQueue(this);
+    m_queue->setup(m_connection);
+    QVERIFY(m_queue->isValid());
+
+    Registry registry;
+    QSignalSpy interfacesAnnouncedSpy(&registry, &Registry::interfacesAnnounced);
+    QVERIFY(interfacesAnnouncedSpy.isValid());
+    registry.setEventQueue(m_queue);
+    registry.create(m_connection->display());
+    QVERIFY(registry.isValid());
+    registry.setup();
+    QVERIFY(interfacesAnnouncedSpy.wait());
+
+    const auto compositor = registry.interface(Registry::Interface::Compositor);
+    m_compositor = registry.createCompositor(compositor.name, compositor.version, this);
+    QVERIFY(m_compositor->isValid());
+
+    const auto manager = registry.interface(Registry::Interface::SinglePixelBufferManager);
+    QVERIFY(manager.name != 0);
+    m_singlePixelBufferManager = registry.createSinglePixelBufferManager(manager.name, manager.version, this);
+    QVERIFY(m_singlePixelBufferManager->isValid());
+}
+
+void TestSinglePixelBuffer::cleanup()
+{
+#define CLEANUP(variable)                                                                                                                                      \
+    if (variable) {                                                                                                                                            \
+        delete variable;                                                                                                                                       \
+        variable = nullptr;                                                                                                                                    \
+    }
+    CLEANUP(m_compositor)
+    CLEANUP(m_singlePixelBufferManager)
+    CLEANUP(m_queue)
+    if (m_connection) {
+        m_connection->deleteLater();
+        m_connection = nullptr;
+    }
+    if (m_thread) {
+        m_thread->quit();
+        m_thread->wait();
+        delete m_thread;
+        m_thread = nullptr;
+    }
+    CLEANUP(m_display)
+#undef CLEANUP
+
+    // these are the children of the display
+    m_compositorInterface = nullptr;
+    m_singlePixelBufferIntegration = nullptr;
+}
+
+KWaylandServer::SurfaceInterface *TestSinglePixelBuffer::createSurface(QScopedPointer<Surface> &surface)
+{
+    QSignalSpy serverSurfaceCreated(m_compositorInterface, &KWaylandServer::CompositorInterface::surfaceCreated);
+    surface.reset(m_compositor->createSurface());
+    if (!serverSurfaceCreated.wait()) {
+        return nullptr;
+    }
+    return serverSurfaceCreated.first().first().value<KWaylandServer::SurfaceInterface *>();
+}
+
+void TestSinglePixelBuffer::testAttach_data()
+{
+    QTest::addColumn<QColor>("color");
+    QTest::addColumn<quint64>("expectedColor");
+    QTest::addColumn<bool>("hasAlphaChannel");
+
+    QTest::newRow("opaque") << QColor(255, 0, 0) << quint64(QRgba64::fromRgba64(0xffff, 0, 0, 0xffff)) << false;
+    QTest::newRow("transparent") << QColor(0, 0, 0, 0) << quint64(QRgba64::fromRgba64(0, 0, 0, 0)) << true;
+    // the color is sent premultiplied
+    QTest::newRow("translucent") << QColor::fromRgba64(0xffff, 0x8000, 0, 0x8000) << quint64(QRgba64::fromRgba64(0x8000, 0x4000, 0, 0x8000)) << true;
+}
+
+void TestSinglePixelBuffer::testAttach()
+{
+    QScopedPointer<Surface> surface;
+    KWaylandServer::SurfaceInterface *serverSurface = createSurface(surface);
+    QVERIFY(serverSurface);
+    QSignalSpy committedSpy(serverSurface, &KWaylandServer::SurfaceInterface::committed);
+
+    QFETCH(QColor, color);
+    wl_buffer *buffer = m_singlePixelBufferManager->createBuffer(color);
+    QVERIFY(buffer);
+    surface->attachBuffer(buffer);
+    surface->damage(QRect(0, 0, 1, 1));
+    surface->commit(Surface::CommitFlag::None);
+    QVERIFY(committedSpy.wait());
+
+    auto serverBuffer = qobject_cast<KWaylandServer::SinglePixelBufferV1ClientBuffer *>(serverSurface->buffer());
+    QVERIFY(serverBuffer);
+    QCOMPARE(serverBuffer->size(), QSize(1, 1));
+    QCOMPARE(serverSurface->bufferSize(), QSize(1, 1));
+    QCOMPARE(serverBuffer->origin(), KWaylandServer::ClientBuffer::Origin::TopLeft);
+    QTEST(quint64(serverBuffer->color()), "expectedColor");
+    QTEST(serverBuffer->hasAlphaChannel(), "hasAlphaChannel");
+
+    wl_buffer_destroy(buffer);
+}
+
+void TestSinglePixelBuffer::testDestroyBuffer()
+{
+    wl_buffer *buffer = m_singlePixelBufferManager->createBuffer(Qt::blue);
+    QVERIFY(buffer);
+    m_connection->flush();
+
+    // the server buffer goes away together with the client resource
+    QScopedPointer<Surface> surface;
+    KWaylandServer::SurfaceInterface *serverSurface = createSurface(surface);
+    QVERIFY(serverSurface);
+    QSignalSpy committedSpy(serverSurface, &KWaylandServer::SurfaceInterface::committed);
+    surface->attachBuffer(buffer);
+    surface->commit(Surface::CommitFlag::None);
+    QVERIFY(committedSpy.wait());
+    QPointer<KWaylandServer::ClientBuffer> serverBuffer = serverSurface->buffer();
+    QVERIFY(serverBuffer);
+
+    // attach nothing, so that the surface releases its reference
+    surface->attachBuffer(static_cast<wl_buffer *>(nullptr));
+    surface->commit(Surface::CommitFlag::None);
+    QVERIFY(committedSpy.wait());
+    QVERIFY(!serverSurface->buffer());
+
+    QSignalSpy destroyedSpy(serverBuffer.data(), &QObject::destroyed);
+    wl_buffer_destroy(buffer);
+    m_connection->flush();
+    QVERIFY(destroyedSpy.wait());
+}
+
+QTEST_GUILESS_MAIN(TestSinglePixelBuffer)
+#include "test_wayland_singlepixelbuffer.moc"
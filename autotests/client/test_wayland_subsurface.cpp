@@ -8,6 +8,8 @@
 // KWin
 #include "../../src/server/compositor_interface.h"
 #include "../../src/server/display.h"
+#include "../../src/server/occlusiontracker.h"
+#include "../../src/server/output_interface.h"
 #include "../../src/server/subcompositor_interface.h"
 #include "../../src/server/surface_interface.h"
 #include "../../src/client/compositor.h"
@@ -47,6 +49,9 @@ private Q_SLOTS:
     void testSurfaceAt();
     void testDestroyAttachedBuffer();
     void testDestroyParentSurface();
+    void testOutputFrameRendered();
+    void testPaintList();
+    void testOcclusionTracker();
 
 private:
     KWaylandServer::Display *m_display;
@@ -1066,5 +1071,173 @@ void TestSubSurface::testDestroyParentSurface()
     QVERIFY(destroySpy.wait());
 }
 
+void TestSubSurface::testOutputFrameRendered()
+{
+    // this test verifies that frame callbacks of a surface tree can be dispatched per output
+    using namespace KWayland::Client;
+    using namespace KWaylandServer;
+
+    QSignalSpy surfaceCreatedSpy(m_compositorInterface, &CompositorInterface::surfaceCreated);
+    QVERIFY(surfaceCreatedSpy.isValid());
+
+    QScopedPointer<Surface> surface(m_compositor->createSurface());
+    QVERIFY(surfaceCreatedSpy.wait());
+    auto childSurface = surfaceCreatedSpy.first().first().value<SurfaceInterface *>();
+    QVERIFY(childSurface);
+
+    QScopedPointer<Surface> parent(m_compositor->createSurface());
+    QVERIFY(surfaceCreatedSpy.wait());
+    auto parentSurface = surfaceCreatedSpy.last().first().value<SurfaceInterface *>();
+    QVERIFY(parentSurface);
+    QScopedPointer<SubSurface> subSurface(m_subCompositor->createSubSurface(QPointer<Surface>(surface.data()), QPointer<Surface>(parent.data())));
+
+    QSignalSpy childFrameRenderedSpy(surface.data(), &Surface::frameRendered);
+    QVERIFY(childFrameRenderedSpy.isValid());
+    QSignalSpy parentFrameRenderedSpy(parent.data(), &Surface::frameRendered);
+    QVERIFY(parentFrameRenderedSpy.isValid());
+    QSignalSpy parentCommittedSpy(parentSurface, &SurfaceInterface::committed);
+    QVERIFY(parentCommittedSpy.isValid());
+
+    // the child state is applied together with the parent
+    surface->commit(Surface::CommitFlag::FrameCallback);
+    parent->commit(Surface::CommitFlag::FrameCallback);
+    QVERIFY(parentCommittedSpy.wait());
+    QVERIFY(childSurface->hasFrameCallbacks());
+    QVERIFY(parentSurface->hasFrameCallbacks());
+
+    // the compositor lists both surfaces of the tree as painted
+    OutputInterface output(m_display);
+    // a surface destroyed during painting may leave a null entry behind
+    output.frameRendered({childSurface, nullptr, parentSurface}, 10);
+    QVERIFY(!childSurface->hasFrameCallbacks());
+    QVERIFY(!parentSurface->hasFrameCallbacks());
+
+    QVERIFY(parentFrameRenderedSpy.wait());
+    if (childFrameRenderedSpy.isEmpty()) {
+        QVERIFY(childFrameRenderedSpy.wait());
+    }
+    QCOMPARE(childFrameRenderedSpy.count(), 1);
+    QCOMPARE(parentFrameRenderedSpy.count(), 1);
+}
+
+void TestSubSurface::testPaintList()
+{
+    // this test verifies that the flattened surface tree follows commits of the tree
+    using namespace KWayland::Client;
+    using namespace KWaylandServer;
+
+    QSignalSpy surfaceCreatedSpy(m_compositorInterface, &CompositorInterface::surfaceCreated);
+    QVERIFY(surfaceCreatedSpy.isValid());
+
+    QScopedPointer<Surface> surface(m_compositor->createSurface());
+    QVERIFY(surfaceCreatedSpy.wait());
+    auto childSurface = surfaceCreatedSpy.first().first().value<SurfaceInterface *>();
+    QVERIFY(childSurface);
+
+    QScopedPointer<Surface> parent(m_compositor->createSurface());
+    QVERIFY(surfaceCreatedSpy.wait());
+    auto parentSurface = surfaceCreatedSpy.last().first().value<SurfaceInterface *>();
+    QVERIFY(parentSurface);
+    QScopedPointer<SubSurface> subSurface(m_subCompositor->createSubSurface(QPointer<Surface>(surface.data()), QPointer<Surface>(parent.data())));
+    QSignalSpy parentCommittedSpy(parentSurface, &SurfaceInterface::committed);
+    QVERIFY(parentCommittedSpy.isValid());
+
+    // nothing is mapped yet
+    QVERIFY(parentSurface->paintList().isEmpty());
+
+    QImage image(QSize(50, 50), QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::black);
+    surface->attachBuffer(m_shm->createBuffer(image));
+    surface->setOpaqueRegion(m_compositor->createRegion(QRegion(0, 0, 50, 50)).get());
+    surface->commit(Surface::CommitFlag::None);
+    subSurface->setPosition(QPoint(10, 20));
+    parent->attachBuffer(m_shm->createBuffer(image));
+    parent->commit(Surface::CommitFlag::None);
+    QVERIFY(parentCommittedSpy.wait());
+
+    const QVector<SurfacePaintNode> &paintList = parentSurface->paintList();
+    QCOMPARE(paintList.count(), 2);
+    QCOMPARE(paintList[0].surface, parentSurface);
+    QCOMPARE(paintList[0].offset, QPoint(0, 0));
+    QCOMPARE(paintList[0].buffer, parentSurface->buffer());
+    QCOMPARE(paintList[0].opaque, QRegion());
+    QCOMPARE(paintList[1].surface, childSurface);
+    QCOMPARE(paintList[1].offset, QPoint(10, 20));
+    QCOMPARE(paintList[1].buffer, childSurface->buffer());
+    QCOMPARE(paintList[1].opaque, QRegion(0, 0, 50, 50));
+
+    // without commits the cached list is returned
+    QCOMPARE(parentSurface->paintList().constData(), paintList.constData());
+
+    // moving the child below the parent updates the list
+    subSurface->placeBelow(QPointer<Surface>(parent.data()));
+    subSurface->setPosition(QPoint(-5, 5));
+    parent->commit(Surface::CommitFlag::None);
+    QVERIFY(parentCommittedSpy.wait());
+    QCOMPARE(parentSurface->paintList().count(), 2);
+    QCOMPARE(parentSurface->paintList()[0].surface, childSurface);
+    QCOMPARE(parentSurface->paintList()[0].offset, QPoint(-5, 5));
+    QCOMPARE(parentSurface->paintList()[1].surface, parentSurface);
+
+    // destroying the sub-surface removes the child
+    QSignalSpy childRemovedSpy(parentSurface, &SurfaceInterface::childSubSurfaceRemoved);
+    QVERIFY(childRemovedSpy.isValid());
+    subSurface.reset();
+    QVERIFY(childRemovedSpy.wait());
+    QCOMPARE(parentSurface->paintList().count(), 1);
+    QCOMPARE(parentSurface->paintList()[0].surface, parentSurface);
+}
+
+void TestSubSurface::testOcclusionTracker()
+{
+    // this test verifies that the tracker follows sub-surfaces which get mapped after the tree was tracked
+    using namespace KWayland::Client;
+    using namespace KWaylandServer;
+
+    QSignalSpy surfaceCreatedSpy(m_compositorInterface, &CompositorInterface::surfaceCreated);
+    QVERIFY(surfaceCreatedSpy.isValid());
+
+    QScopedPointer<Surface> surface(m_compositor->createSurface());
+    QVERIFY(surfaceCreatedSpy.wait());
+    auto childSurface = surfaceCreatedSpy.first().first().value<SurfaceInterface *>();
+    QVERIFY(childSurface);
+
+    QScopedPointer<Surface> parent(m_compositor->createSurface());
+    QVERIFY(surfaceCreatedSpy.wait());
+    auto parentSurface = surfaceCreatedSpy.last().first().value<SurfaceInterface *>();
+    QVERIFY(parentSurface);
+    QScopedPointer<SubSurface> subSurface(m_subCompositor->createSubSurface(QPointer<Surface>(surface.data()), QPointer<Surface>(parent.data())));
+    subSurface->setMode(SubSurface::Mode::Desynchronized);
+    QSignalSpy parentCommittedSpy(parentSurface, &SurfaceInterface::committed);
+    QVERIFY(parentCommittedSpy.isValid());
+
+    QImage image(QSize(50, 50), QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::black);
+    parent->attachBuffer(m_shm->createBuffer(image));
+    parent->commit(Surface::CommitFlag::None);
+    QVERIFY(parentCommittedSpy.wait());
+    QVERIFY(!childSurface->isMapped());
+
+    OcclusionTracker tracker;
+    tracker.setStack({{parentSurface, QPoint(10, 10)}});
+    QCOMPARE(tracker.visibleRegion(parentSurface), QRegion(10, 10, 50, 50));
+
+    // the unmapped child is not painted, but mapping it grows the tree
+    QSignalSpy childMappedSpy(childSurface, &SurfaceInterface::mapped);
+    QVERIFY(childMappedSpy.isValid());
+    surface->attachBuffer(m_shm->createBuffer(QImage(QSize(100, 100), QImage::Format_ARGB32_Premultiplied)));
+    surface->commit(Surface::CommitFlag::None);
+    QVERIFY(childMappedSpy.wait());
+    QCOMPARE(tracker.visibleRegion(parentSurface), QRegion(10, 10, 100, 100));
+
+    // and unmapping it shrinks the tree again
+    QSignalSpy childUnmappedSpy(childSurface, &SurfaceInterface::unmapped);
+    QVERIFY(childUnmappedSpy.isValid());
+    surface->attachBuffer(Buffer::Ptr());
+    surface->commit(Surface::CommitFlag::None);
+    QVERIFY(childUnmappedSpy.wait());
+    QCOMPARE(tracker.visibleRegion(parentSurface), QRegion(10, 10, 50, 50));
+}
+
 QTEST_GUILESS_MAIN(TestSubSurface)
 #include "test_wayland_subsurface.moc"
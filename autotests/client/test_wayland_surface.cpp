@@ -9,9 +9,11 @@
 #include <QtTest>
 // KWin
 #include "../../src/server/clientbuffer.h"
+#include "../../src/server/clientconnection.h"
 #include "../../src/server/compositor_interface.h"
 #include "../../src/server/display.h"
 #include "../../src/server/idleinhibit_v1_interface.h"
+#include "../../src/server/occlusiontracker.h"
 #include "../../src/server/shmclientbuffer.h"
 #include "../../src/server/surface_interface.h"
 #include "../../src/client/compositor.h"
@@ -39,15 +41,19 @@ private Q_SLOTS:
 
     void testStaticAccessor();
     void testDamage();
+    void testDamageSince();
     void testFrameCallback();
+    void testOccludedFrameCallback();
     void testAttachBuffer();
     void testMultipleSurfaces();
     void testOpaque();
+    void testOcclusionTracker();
     void testInput();
     void testScale();
     void testUnmapOfNotMappedSurface();
     void testSurfaceAt();
     void testDestroyAttachedBuffer();
+    void testReleaseDestroyedBufferCache();
     void testDestroyWithPendingCallback();
     void testOutput();
     void testDisconnect();
@@ -333,6 +339,66 @@ void TestWaylandSurface::testDamage()
     QVERIFY(serverSurface->isMapped());
 }
 
+void TestWaylandSurface::testDamageSince()
+{
+    QSignalSpy serverSurfaceCreated(m_compositorInterface, &KWaylandServer::CompositorInterface::surfaceCreated);
+    QScopedPointer<KWayland::Client::Surface> s(m_compositor->createSurface());
+    QVERIFY(serverSurfaceCreated.wait());
+    KWaylandServer::SurfaceInterface *serverSurface = serverSurfaceCreated.first().first().value<KWaylandServer::SurfaceInterface *>();
+    QVERIFY(serverSurface);
+    QCOMPARE(serverSurface->commitSequence(), quint64(0));
+    QCOMPARE(serverSurface->damageSince(0), QRegion());
+    QSignalSpy committedSpy(serverSurface, &KWaylandServer::SurfaceInterface::committed);
+
+    // the first buffer damages the whole surface
+    QImage img(QSize(100, 100), QImage::Format_ARGB32_Premultiplied);
+    img.fill(Qt::black);
+    s->attachBuffer(m_shm->createBuffer(img));
+    s->damage(QRect(0, 0, 100, 100));
+    s->commit(KWayland::Client::Surface::CommitFlag::None);
+    QVERIFY(committedSpy.wait());
+    QCOMPARE(serverSurface->commitSequence(), quint64(1));
+    QCOMPARE(serverSurface->damageSince(0), QRegion(0, 0, 100, 100));
+    QCOMPARE(serverSurface->damageSince(1), QRegion());
+
+    // damage of later commits is accumulated, attaching a buffer damages it entirely
+    s->attachBuffer(m_shm->createBuffer(img));
+    s->damage(QRect(0, 0, 10, 10));
+    s->commit(KWayland::Client::Surface::CommitFlag::None);
+    QVERIFY(committedSpy.wait());
+    s->commit(KWayland::Client::Surface::CommitFlag::None);
+    QVERIFY(committedSpy.wait());
+    QCOMPARE(serverSurface->commitSequence(), quint64(3));
+    QCOMPARE(serverSurface->damageSince(2), QRegion());
+    QCOMPARE(serverSurface->damageSince(1), QRegion(0, 0, 100, 100));
+
+    // a commit without a new buffer doesn't damage anything
+    s->commit(KWayland::Client::Surface::CommitFlag::None);
+    QVERIFY(committedSpy.wait());
+    QCOMPARE(serverSurface->commitSequence(), quint64(4));
+    QCOMPARE(serverSurface->damageSince(3), QRegion());
+    QCOMPARE(serverSurface->damage(), QRegion(0, 0, 100, 100));
+
+    // a resize damages the whole surface
+    img = QImage(QSize(120, 80), QImage::Format_ARGB32_Premultiplied);
+    img.fill(Qt::black);
+    s->attachBuffer(m_shm->createBuffer(img));
+    s->damage(QRect(0, 0, 10, 10));
+    s->commit(KWayland::Client::Surface::CommitFlag::None);
+    QVERIFY(committedSpy.wait());
+    QCOMPARE(serverSurface->damageSince(4), QRegion(0, 0, 120, 100));
+    QCOMPARE(serverSurface->damageSince(2), QRegion(0, 0, 120, 100));
+
+    // commits that are too old are not remembered, everything has to be repainted
+    for (int i = 0; i < 10; ++i) {
+        s->commit(KWayland::Client::Surface::CommitFlag::None);
+        QVERIFY(committedSpy.wait());
+    }
+    QCOMPARE(serverSurface->commitSequence(), quint64(15));
+    QCOMPARE(serverSurface->damageSince(14), QRegion());
+    QCOMPARE(serverSurface->damageSince(1), QRegion(0, 0, 120, 80));
+}
+
 void TestWaylandSurface::testFrameCallback()
 {
     QSignalSpy serverSurfaceCreated(m_compositorInterface, &KWaylandServer::CompositorInterface::surfaceCreated);
@@ -360,6 +426,71 @@ void TestWaylandSurface::testFrameCallback()
     QVERIFY(!frameRenderedSpy.isEmpty());
 }
 
+void TestWaylandSurface::testOccludedFrameCallback()
+{
+    QSignalSpy serverSurfaceCreated(m_compositorInterface, &KWaylandServer::CompositorInterface::surfaceCreated);
+    QVERIFY(serverSurfaceCreated.isValid());
+    QScopedPointer<KWayland::Client::Surface> s(m_compositor->createSurface());
+    QVERIFY(serverSurfaceCreated.wait());
+    KWaylandServer::SurfaceInterface *serverSurface = serverSurfaceCreated.first().first().value<KWaylandServer::SurfaceInterface *>();
+    QVERIFY(serverSurface);
+    QCOMPARE(serverSurface->occludedFrameCallbackInterval(), 1000u);
+
+    QSignalSpy committedSpy(serverSurface, &KWaylandServer::SurfaceInterface::committed);
+    QVERIFY(committedSpy.isValid());
+    QSignalSpy frameRenderedSpy(s.data(), &KWayland::Client::Surface::frameRendered);
+    QVERIFY(frameRenderedSpy.isValid());
+
+    QImage img(QSize(10, 10), QImage::Format_ARGB32_Premultiplied);
+    img.fill(Qt::black);
+    s->attachBuffer(m_shm->createBuffer(img));
+    s->damage(QRect(0, 0, 10, 10));
+    s->commit();
+    QVERIFY(committedSpy.wait());
+
+    serverSurface->setOccluded(true);
+    serverSurface->setOccludedFrameCallbackInterval(100);
+    QVERIFY(serverSurface->isOccluded());
+
+    // the first frame is not throttled
+    serverSurface->frameRendered(10);
+    QVERIFY(!serverSurface->hasFrameCallbacks());
+    QVERIFY(frameRenderedSpy.wait());
+    QCOMPARE(serverSurface->suppressedFrameCallbackCount(), quint64(0));
+
+    // the following ones are held back until the interval has passed
+    s->commit();
+    QVERIFY(committedSpy.wait());
+    QVERIFY(serverSurface->hasFrameCallbacks());
+    serverSurface->frameRendered(50);
+    QVERIFY(serverSurface->hasFrameCallbacks());
+    QCOMPARE(serverSurface->suppressedFrameCallbackCount(), quint64(1));
+    // the same callback held back again is not counted twice
+    serverSurface->frameRendered(60);
+    QVERIFY(serverSurface->hasFrameCallbacks());
+    QCOMPARE(serverSurface->suppressedFrameCallbackCount(), quint64(1));
+    serverSurface->frameRendered(110);
+    QVERIFY(!serverSurface->hasFrameCallbacks());
+    QVERIFY(frameRenderedSpy.wait());
+    QCOMPARE(frameRenderedSpy.count(), 2);
+
+    // with an interval of zero callbacks are only sent once the surface becomes visible
+    serverSurface->setOccludedFrameCallbackInterval(0);
+    s->commit();
+    QVERIFY(committedSpy.wait());
+    serverSurface->frameRendered(10000);
+    QVERIFY(serverSurface->hasFrameCallbacks());
+    QCOMPARE(serverSurface->suppressedFrameCallbackCount(), quint64(2));
+    serverSurface->frameRendered(10005);
+    QCOMPARE(serverSurface->suppressedFrameCallbackCount(), quint64(2));
+    serverSurface->setOccluded(false);
+    QVERIFY(!serverSurface->isOccluded());
+    serverSurface->frameRendered(10010);
+    QVERIFY(!serverSurface->hasFrameCallbacks());
+    QVERIFY(frameRenderedSpy.wait());
+    QCOMPARE(frameRenderedSpy.count(), 3);
+}
+
 void TestWaylandSurface::testAttachBuffer()
 {
     // create the surface
@@ -655,6 +786,71 @@ void TestWaylandSurface::testOpaque()
     QCOMPARE(serverSurface->opaque(), QRegion());
 }
 
+void TestWaylandSurface::testOcclusionTracker()
+{
+    using namespace KWaylandServer;
+    QSignalSpy serverSurfaceCreated(m_compositorInterface, &CompositorInterface::surfaceCreated);
+    QVERIFY(serverSurfaceCreated.isValid());
+
+    QImage img(QSize(100, 100), QImage::Format_ARGB32_Premultiplied);
+    img.fill(Qt::black);
+    QScopedPointer<KWayland::Client::Surface> bottom(m_compositor->createSurface());
+    QScopedPointer<KWayland::Client::Surface> middle(m_compositor->createSurface());
+    QScopedPointer<KWayland::Client::Surface> top(m_compositor->createSurface());
+    bottom->attachBuffer(m_shm->createBuffer(img));
+    bottom->damage(QRect(0, 0, 100, 100));
+    bottom->commit(KWayland::Client::Surface::CommitFlag::None);
+    middle->attachBuffer(m_shm->createBuffer(img));
+    middle->damage(QRect(0, 0, 100, 100));
+    middle->setOpaqueRegion(m_compositor->createRegion(QRegion(0, 0, 100, 100)).get());
+    middle->commit(KWayland::Client::Surface::CommitFlag::None);
+    top->attachBuffer(m_shm->createBuffer(img.copy(0, 0, 50, 50)));
+    top->damage(QRect(0, 0, 50, 50));
+    top->commit(KWayland::Client::Surface::CommitFlag::None);
+
+    while (serverSurfaceCreated.count() < 3) {
+        QVERIFY(serverSurfaceCreated.wait());
+    }
+    auto bottomSurface = serverSurfaceCreated.at(0).first().value<SurfaceInterface *>();
+    auto middleSurface = serverSurfaceCreated.at(1).first().value<SurfaceInterface *>();
+    auto topSurface = serverSurfaceCreated.at(2).first().value<SurfaceInterface *>();
+    QSignalSpy topCommittedSpy(topSurface, &SurfaceInterface::committed);
+    if (!topSurface->isMapped()) {
+        QVERIFY(topCommittedSpy.wait());
+    }
+    QVERIFY(bottomSurface->isMapped());
+    QVERIFY(middleSurface->isMapped());
+
+    OcclusionTracker tracker;
+    tracker.setStack({{bottomSurface, QPoint(0, 0)}, {middleSurface, QPoint(50, 0)}, {topSurface, QPoint(0, 0)}});
+    QCOMPARE(tracker.stack().count(), 3);
+    QCOMPARE(tracker.visibleRegion(topSurface), QRegion(0, 0, 50, 50));
+    QCOMPARE(tracker.visibleRegion(middleSurface), QRegion(50, 0, 100, 100));
+    QCOMPARE(tracker.visibleRegion(bottomSurface), QRegion(0, 0, 50, 100));
+    QVERIFY(!tracker.isOccluded(bottomSurface));
+
+    // a surface that stops being opaque uncovers the surfaces below it
+    QSignalSpy middleCommittedSpy(middleSurface, &SurfaceInterface::committed);
+    middle->setOpaqueRegion(nullptr);
+    middle->commit(KWayland::Client::Surface::CommitFlag::None);
+    QVERIFY(middleCommittedSpy.wait());
+    QCOMPARE(tracker.visibleRegion(bottomSurface), QRegion(0, 0, 100, 100));
+    QCOMPARE(tracker.visibleRegion(topSurface), QRegion(0, 0, 50, 50));
+
+    // moving an opaque surface on top hides the bottom surface completely
+    middle->setOpaqueRegion(m_compositor->createRegion(QRegion(0, 0, 100, 100)).get());
+    middle->commit(KWayland::Client::Surface::CommitFlag::None);
+    QVERIFY(middleCommittedSpy.wait());
+    tracker.setStack({{bottomSurface, QPoint(0, 0)}, {middleSurface, QPoint(0, 0)}, {topSurface, QPoint(0, 0)}});
+    QVERIFY(tracker.isOccluded(bottomSurface));
+    QCOMPARE(tracker.visibleRegion(middleSurface), QRegion(0, 0, 100, 100).subtracted(QRegion(0, 0, 50, 50)));
+
+    // surfaces that are not part of the stack have no visible region
+    tracker.setStack({{middleSurface, QPoint(0, 0)}});
+    QVERIFY(tracker.isOccluded(bottomSurface));
+    QCOMPARE(tracker.visibleRegion(middleSurface), QRegion(0, 0, 100, 100));
+}
+
 void TestWaylandSurface::testInput()
 {
     using namespace KWayland::Client;
@@ -908,6 +1104,52 @@ void TestWaylandSurface::testDestroyAttachedBuffer()
     QTRY_VERIFY(serverSurface->buffer()->isDestroyed());
 }
 
+void TestWaylandSurface::testReleaseDestroyedBufferCache()
+{
+    // this test verifies that the saved contents of a destroyed shm buffer are only dropped under critical memory pressure
+    using namespace KWayland::Client;
+    using namespace KWaylandServer;
+    QSignalSpy serverSurfaceCreated(m_compositorInterface, &CompositorInterface::surfaceCreated);
+    QVERIFY(serverSurfaceCreated.isValid());
+    QScopedPointer<Surface> s(m_compositor->createSurface());
+    QVERIFY(serverSurfaceCreated.wait());
+    SurfaceInterface *serverSurface = serverSurfaceCreated.first().first().value<KWaylandServer::SurfaceInterface *>();
+
+    QSignalSpy damagedSpy(serverSurface, &SurfaceInterface::damaged);
+    QVERIFY(damagedSpy.isValid());
+    QImage image(QSize(100, 100), QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::red);
+    s->attachBuffer(m_shm->createBuffer(image));
+    s->damage(QRect(0, 0, 100, 100));
+    s->commit(Surface::CommitFlag::None);
+    QVERIFY(damagedSpy.wait());
+    ClientBuffer *buffer = serverSurface->buffer();
+    QVERIFY(buffer);
+    buffer->ref();
+    auto shmBuffer = qobject_cast<ShmClientBuffer *>(buffer);
+    QVERIFY(shmBuffer);
+
+    // nothing is saved while the client still has the buffer
+    QCOMPARE(m_display->releaseCaches(Display::MemoryPressure::Critical), qint64(0));
+    QCOMPARE(shmBuffer->data(), image);
+
+    // destroy the buffer, the contents stay accessible
+    delete m_shm;
+    m_shm = nullptr;
+    QTRY_VERIFY(buffer->isDestroyed());
+    QCOMPARE(shmBuffer->data(), image);
+    QCOMPARE(m_display->releaseCaches(Display::MemoryPressure::Moderate), qint64(0));
+    QCOMPARE(shmBuffer->data(), image);
+
+    // a copy held by the compositor outlives the release
+    const QImage held = shmBuffer->data();
+    QCOMPARE(m_display->releaseCaches(Display::MemoryPressure::Critical), qint64(100 * 100 * 4));
+    QVERIFY(shmBuffer->data().isNull());
+    QCOMPARE(held, image);
+    QCOMPARE(m_display->releaseCaches(Display::MemoryPressure::Critical), qint64(0));
+    buffer->unref();
+}
+
 void TestWaylandSurface::testDestroyWithPendingCallback()
 {
     // this test tries to verify that destroying a surface with a pending callback works correctly
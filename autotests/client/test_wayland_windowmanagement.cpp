@@ -53,6 +53,7 @@ private Q_SLOTS:
     void testParentWindow();
     void testGeometry();
     void testIcon();
+    void testIconAfterReleasingCaches();
     void testPid();
     void testApplicationMenu();
 
@@ -590,6 +591,31 @@ void TestWindowManagement::testIcon()
     QCOMPARE(m_window->icon().name(), QStringLiteral("wayland"));
 }
 
+void TestWindowManagement::testIconAfterReleasingCaches()
+{
+    using namespace KWayland::Client;
+
+    QImage p(32, 32, QImage::Format_ARGB32_Premultiplied);
+    p.fill(Qt::blue);
+    const QIcon dummyIcon(QPixmap::fromImage(p));
+
+    QScopedPointer<KWaylandServer::PlasmaWindowInterface> newWindowInterface(m_windowManagementInterface->createWindow(this, QUuid::createUuid()));
+    newWindowInterface->setIcon(dummyIcon);
+    // the pixmap gets replaced by its serialized form, which is much smaller
+    QVERIFY(m_display->releaseCaches(KWaylandServer::Display::MemoryPressure::Moderate) > 0);
+
+    QSignalSpy windowSpy(m_windowManagement, &KWayland::Client::PlasmaWindowManagement::windowCreated);
+    QVERIFY(windowSpy.wait());
+    QScopedPointer<PlasmaWindow> newWindow(windowSpy.first().first().value<KWayland::Client::PlasmaWindow *>());
+    QVERIFY(newWindow);
+    QSignalSpy iconChangedSpy(newWindow.data(), &PlasmaWindow::iconChanged);
+    QVERIFY(iconChangedSpy.isValid());
+    if (newWindow->icon().isNull()) {
+        QVERIFY(iconChangedSpy.wait());
+    }
+    QCOMPARE(newWindow->icon().pixmap(32, 32), dummyIcon.pixmap(32, 32));
+}
+
 void TestWindowManagement::testPid()
 {
     using namespace KWayland::Client;
@@ -25,6 +25,8 @@
 #include "../../src/server/surface_interface.h"
 #include "../../src/server/xdgshell_interface.h"
 
+#include <wayland-xdg-shell-client-protocol.h>
+
 using namespace KWayland::Client;
 using namespace KWaylandServer;
 
@@ -56,6 +58,10 @@ private Q_SLOTS:
     void testConfigureStates_data();
     void testConfigureStates();
     void testConfigureMultipleAcks();
+    void testConfigurePacing();
+    void testConfigureCollapse();
+    void testConfigureCollapseKeepsSize();
+    void testDisableConfigureCollapse();
 
 private:
     XdgShellInterface *m_xdgShellInterface = nullptr;
@@ -250,6 +256,21 @@ void XdgShellTest::testTitle()
     QCOMPARE(titleChangedSpy.count(), 1);
     QCOMPARE(titleChangedSpy.first().first().toString(), QStringLiteral("foo"));
     QCOMPARE(serverXdgToplevel->windowTitle(), QStringLiteral("foo"));
+
+    // invalid UTF-8 is decoded to the replacement character
+    xdg_toplevel_set_title(*xdgSurface, "\xff");
+    QVERIFY(titleChangedSpy.wait());
+    QCOMPARE(titleChangedSpy.count(), 2);
+    QCOMPARE(serverXdgToplevel->windowTitle(), QStringLiteral("\ufffd"));
+
+    // a title that differs in its raw bytes but decodes to the same string is ignored,
+    // non-ASCII titles are decoded from UTF-8
+    xdg_toplevel_set_title(*xdgSurface, "\xfe");
+    xdgSurface->setTitle(QStringLiteral("f\u00f6\u00f6 \u2014 bar"));
+    QVERIFY(titleChangedSpy.wait());
+    QCOMPARE(titleChangedSpy.count(), 3);
+    QCOMPARE(titleChangedSpy.at(2).first().toString(), QStringLiteral("f\u00f6\u00f6 \u2014 bar"));
+    QCOMPARE(serverXdgToplevel->windowTitle(), QStringLiteral("f\u00f6\u00f6 \u2014 bar"));
 }
 
 void XdgShellTest::testWindowClass()
@@ -607,5 +628,156 @@ void XdgShellTest::testConfigureMultipleAcks()
     QCOMPARE(xdgSurface->size(), QSize(30, 40));
 }
 
+void XdgShellTest::testConfigurePacing()
+{
+    qRegisterMetaType<XdgShellSurface::States>();
+    qRegisterMetaType<XdgToplevelInterface::States>();
+    // this test verifies that size configures are held back while the client hasn't committed the previous one
+    SURFACE
+
+    QSignalSpy configureSpy(xdgSurface.data(), &XdgShellSurface::configureRequested);
+    QVERIFY(configureSpy.isValid());
+    QSignalSpy pacedSpy(serverXdgToplevel, &XdgToplevelInterface::pacedConfigureSent);
+    QVERIFY(pacedSpy.isValid());
+
+    XdgSurfaceInterface *serverXdgSurface = serverXdgToplevel->xdgSurface();
+    QVERIFY(!serverXdgSurface->isConfigurePacingEnabled());
+    serverXdgSurface->setConfigurePacingEnabled(true);
+    QVERIFY(serverXdgSurface->isConfigurePacingEnabled());
+    QVERIFY(!serverXdgSurface->hasOutstandingConfigure());
+
+    const quint32 serial1 = serverXdgToplevel->sendConfigure(QSize(10, 20), XdgToplevelInterface::States());
+    QVERIFY(serial1 != 0);
+    QVERIFY(serverXdgSurface->hasOutstandingConfigure());
+
+    // new sizes are held back, only the newest one is kept
+    QCOMPARE(serverXdgToplevel->sendConfigure(QSize(20, 30), XdgToplevelInterface::States()), 0u);
+    QCOMPARE(serverXdgToplevel->sendConfigure(QSize(30, 40), XdgToplevelInterface::States()), 0u);
+
+    QVERIFY(configureSpy.wait());
+    QCOMPARE(configureSpy.count(), 1);
+    QCOMPARE(configureSpy.first().at(0).toSize(), QSize(10, 20));
+    QCOMPARE(configureSpy.first().at(2).value<quint32>(), serial1);
+
+    // acknowledging without committing keeps the configure outstanding
+    xdgSurface->ackConfigure(serial1);
+    m_connection->flush();
+    QVERIFY(!configureSpy.wait(100));
+    QVERIFY(serverXdgSurface->hasOutstandingConfigure());
+
+    // committing the acknowledged configure releases the held back one
+    surface->commit(Surface::CommitFlag::None);
+    QVERIFY(pacedSpy.wait());
+    QCOMPARE(pacedSpy.count(), 1);
+    const quint32 serial2 = pacedSpy.first().at(0).value<quint32>();
+    QVERIFY(serial2 != 0);
+    QVERIFY(serial2 != serial1);
+    QCOMPARE(pacedSpy.first().at(1).toSize(), QSize(30, 40));
+
+    QVERIFY(configureSpy.wait());
+    QCOMPARE(configureSpy.count(), 2);
+    QCOMPARE(configureSpy.last().at(0).toSize(), QSize(30, 40));
+    QCOMPARE(configureSpy.last().at(2).value<quint32>(), serial2);
+
+    // a configure that doesn't change the size is not held back
+    const quint32 serial3 = serverXdgToplevel->sendConfigure(QSize(30, 40), XdgToplevelInterface::State::Activated);
+    QVERIFY(serial3 != 0);
+    QVERIFY(configureSpy.wait());
+    QCOMPARE(configureSpy.count(), 3);
+
+    // disabling pacing sends the held back configure immediately
+    QCOMPARE(serverXdgToplevel->sendConfigure(QSize(40, 50), XdgToplevelInterface::States()), 0u);
+    serverXdgSurface->setConfigurePacingEnabled(false);
+    QCOMPARE(pacedSpy.count(), 2);
+    QCOMPARE(pacedSpy.last().at(1).toSize(), QSize(40, 50));
+    QVERIFY(configureSpy.wait());
+    QCOMPARE(configureSpy.count(), 4);
+    QCOMPARE(configureSpy.last().at(0).toSize(), QSize(40, 50));
+}
+
+void XdgShellTest::testConfigureCollapse()
+{
+    qRegisterMetaType<XdgShellSurface::States>();
+    // this test verifies that configure events dispatched together are collapsed into the newest one
+    SURFACE
+
+    QVERIFY(!xdgSurface->isConfigureCollapseEnabled());
+    xdgSurface->setConfigureCollapseEnabled(true);
+    QVERIFY(xdgSurface->isConfigureCollapseEnabled());
+
+    QSignalSpy configureSpy(xdgSurface.data(), &XdgShellSurface::configureRequested);
+    QVERIFY(configureSpy.isValid());
+    QSignalSpy sizeChangedSpy(xdgSurface.data(), &XdgShellSurface::sizeChanged);
+    QVERIFY(sizeChangedSpy.isValid());
+    QSignalSpy ackSpy(serverXdgToplevel->xdgSurface(), &XdgSurfaceInterface::configureAcknowledged);
+    QVERIFY(ackSpy.isValid());
+
+    serverXdgToplevel->sendConfigure(QSize(10, 20), XdgToplevelInterface::States());
+    serverXdgToplevel->sendConfigure(QSize(20, 30), XdgToplevelInterface::States());
+    serverXdgToplevel->sendConfigure(QSize(30, 40), XdgToplevelInterface::State::Activated);
+    const quint32 serial = m_display->serial();
+
+    QVERIFY(configureSpy.wait());
+    QCOMPARE(configureSpy.count(), 1);
+    QCOMPARE(configureSpy.first().at(0).toSize(), QSize(30, 40));
+    QCOMPARE(configureSpy.first().at(1).value<XdgShellSurface::States>(), XdgShellSurface::State::Activated);
+    QCOMPARE(configureSpy.first().at(2).value<quint32>(), serial);
+    QCOMPARE(sizeChangedSpy.count(), 1);
+    QCOMPARE(xdgSurface->size(), QSize(30, 40));
+
+    xdgSurface->ackConfigure(serial);
+    surface->commit(Surface::CommitFlag::None);
+    QVERIFY(ackSpy.wait());
+    QCOMPARE(ackSpy.count(), 1);
+    QCOMPARE(ackSpy.first().first().value<quint32>(), serial);
+}
+
+void XdgShellTest::testConfigureCollapseKeepsSize()
+{
+    qRegisterMetaType<XdgShellSurface::States>();
+    // this test verifies that a collapsed configure leaving the size to the client keeps the size of a skipped one
+    SURFACE
+
+    xdgSurface->setConfigureCollapseEnabled(true);
+    QSignalSpy configureSpy(xdgSurface.data(), &XdgShellSurface::configureRequested);
+    QVERIFY(configureSpy.isValid());
+
+    serverXdgToplevel->sendConfigure(QSize(10, 20), XdgToplevelInterface::States());
+    serverXdgToplevel->sendConfigure(QSize(0, 0), XdgToplevelInterface::State::Activated);
+
+    QVERIFY(configureSpy.wait());
+    QCOMPARE(configureSpy.count(), 1);
+    QCOMPARE(configureSpy.first().at(0).toSize(), QSize(0, 0));
+    QCOMPARE(configureSpy.first().at(1).value<XdgShellSurface::States>(), XdgShellSurface::State::Activated);
+    QCOMPARE(xdgSurface->size(), QSize(10, 20));
+}
+
+void XdgShellTest::testDisableConfigureCollapse()
+{
+    qRegisterMetaType<XdgShellSurface::States>();
+    // this test verifies that disabling the collapsing emits a collapsed configure before the newer ones
+    SURFACE
+
+    xdgSurface->setConfigureCollapseEnabled(true);
+    QSignalSpy configureSpy(xdgSurface.data(), &XdgShellSurface::configureRequested);
+    QVERIFY(configureSpy.isValid());
+    // the close event is dispatched between the configure events
+    connect(xdgSurface.data(), &XdgShellSurface::closeRequested, this, [&xdgSurface]() {
+        xdgSurface->setConfigureCollapseEnabled(false);
+    });
+
+    serverXdgToplevel->sendConfigure(QSize(10, 20), XdgToplevelInterface::States());
+    serverXdgToplevel->sendClose();
+    serverXdgToplevel->sendConfigure(QSize(20, 30), XdgToplevelInterface::States());
+
+    QTRY_COMPARE(configureSpy.count(), 2);
+    QVERIFY(!xdgSurface->isConfigureCollapseEnabled());
+    QCOMPARE(configureSpy.at(0).at(0).toSize(), QSize(10, 20));
+    QCOMPARE(configureSpy.at(1).at(0).toSize(), QSize(20, 30));
+    QVERIFY(configureSpy.at(0).at(2).value<quint32>() < configureSpy.at(1).at(2).value<quint32>());
+    QCOMPARE(xdgSurface->size(), QSize(20, 30));
+    QVERIFY(!configureSpy.wait(100));
+}
+
 QTEST_GUILESS_MAIN(XdgShellTest)
 #include "test_xdg_shell.moc"
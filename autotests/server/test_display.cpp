@@ -4,12 +4,23 @@
     SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
 */
 // Qt
+#include <QImage>
+#include <QThread>
 #include <QtTest>
 // WaylandServer
 #include "../../src/server/clientconnection.h"
+#include "../../src/server/compositor_interface.h"
 #include "../../src/server/display.h"
 #include "../../src/server/output_interface.h"
 #include "../../src/server/outputmanagement_v2_interface.h"
+#include "../../src/server/surface_interface.h"
+// WaylandClient
+#include "../../src/client/compositor.h"
+#include "../../src/client/connection_thread.h"
+#include "../../src/client/event_queue.h"
+#include "../../src/client/registry.h"
+#include "../../src/client/shm_pool.h"
+#include "../../src/client/surface.h"
 // Wayland
 #include <wayland-server.h>
 // system
@@ -30,8 +41,79 @@ private Q_SLOTS:
     void testConnectNoSocket();
     void testOutputManagement();
     void testAutoSocketName();
+    void testClientStatistics();
+    void testFloodingClient();
 };
 
+/**
+ * A client connected on its own thread, with wl_compositor and wl_shm bound.
+ */
+class TestClient
+{
+public:
+    ~TestClient();
+
+    bool connectToServer(const QString &socketName);
+
+    KWayland::Client::ConnectionThread *connection = nullptr;
+    KWayland::Client::Compositor *compositor = nullptr;
+    KWayland::Client::ShmPool *shm = nullptr;
+
+private:
+    QThread *m_thread = nullptr;
+    KWayland::Client::EventQueue *m_queue = nullptr;
+    KWayland::Client::Registry *m_registry = nullptr;
+};
+
+TestClient::~TestClient()
+{
+    delete shm;
+    delete compositor;
+    delete m_registry;
+    delete m_queue;
+    if (m_thread) {
+        m_thread->quit();
+        m_thread->wait();
+        delete m_thread;
+    }
+    delete connection;
+}
+
+bool TestClient::connectToServer(const QString &socketName)
+{
+    using namespace KWayland::Client;
+    connection = new ConnectionThread;
+    QSignalSpy connectedSpy(connection, &ConnectionThread::connected);
+    connection->setSocketName(socketName);
+
+    m_thread = new QThread;
+    connection->moveToThread(m_thread);
+    m_thread->start();
+
+    connection->initConnection();
+    if (!connectedSpy.wait()) {
+        return false;
+    }
+
+    m_queue = new EventQueue;
+    m_queue->setup(connection);
+
+    m_registry = new Registry;
+    QSignalSpy interfacesAnnouncedSpy(m_registry, &Registry::interfacesAnnounced);
+    m_registry->setEventQueue(m_queue);
+    m_registry->create(connection);
+    m_registry->setup();
+    if (!interfacesAnnouncedSpy.wait()) {
+        return false;
+    }
+
+    const Registry::AnnouncedInterface compositorInterface = m_registry->interface(Registry::Interface::Compositor);
+    compositor = m_registry->createCompositor(compositorInterface.name, compositorInterface.version);
+    const Registry::AnnouncedInterface shmInterface = m_registry->interface(Registry::Interface::Shm);
+    shm = m_registry->createShmPool(shmInterface.name, shmInterface.version);
+    return compositor->isValid() && shm->isValid();
+}
+
 void TestWaylandServerDisplay::testSocketName()
 {
     Display display;
@@ -209,5 +291,154 @@ void TestWaylandServerDisplay::testAutoSocketName()
     QCOMPARE(socketNameChangedSpy1.count(), 1);
 }
 
+void TestWaylandServerDisplay::testClientStatistics()
+{
+    qRegisterMetaType<QHash<ClientConnection *, ClientStatistics>>();
+    Display display;
+    display.addSocketName(QStringLiteral("kwin-wayland-server-display-test-statistics-0"));
+    display.start();
+    display.createShm();
+    CompositorInterface compositorInterface(&display);
+
+    TestClient client;
+    QVERIFY(client.connectToServer(display.socketNames().constFirst()));
+
+    QVERIFY(!display.isClientStatisticsEnabled());
+    display.setClientStatisticsEnabled(true);
+    QVERIFY(display.isClientStatisticsEnabled());
+    QCOMPARE(display.connections().count(), 1);
+    ClientConnection *connection = display.connections().first();
+    QCOMPARE(connection->statistics().requests, quint64(0));
+    QCOMPARE(connection->statistics().commits, quint64(0));
+
+    QSignalSpy serverSurfaceCreated(&compositorInterface, &CompositorInterface::surfaceCreated);
+    QScopedPointer<KWayland::Client::Surface> s(client.compositor->createSurface());
+    QVERIFY(serverSurfaceCreated.wait());
+    SurfaceInterface *serverSurface = serverSurfaceCreated.first().first().value<SurfaceInterface *>();
+    QVERIFY(serverSurface);
+    QSignalSpy committedSpy(serverSurface, &SurfaceInterface::committed);
+    QSignalSpy frameRenderedSpy(s.data(), &KWayland::Client::Surface::frameRendered);
+
+    QImage img(QSize(16, 16), QImage::Format_ARGB32_Premultiplied);
+    img.fill(Qt::black);
+    auto b = client.shm->createBuffer(img);
+    for (int i = 0; i < 3; ++i) {
+        s->attachBuffer(b);
+        s->damage(QRect(0, 0, 16, 16));
+        s->commit(i == 2 ? KWayland::Client::Surface::CommitFlag::FrameCallback : KWayland::Client::Surface::CommitFlag::None);
+    }
+    while (committedSpy.count() < 3) {
+        QVERIFY(committedSpy.wait());
+    }
+
+    ClientStatistics statistics = connection->statistics();
+    QCOMPARE(statistics.commits, quint64(3));
+    // create_surface, three times attach, damage and commit and the frame callback
+    QVERIFY(statistics.requests >= 11);
+    QCOMPARE(statistics.resources.value(QByteArrayLiteral("wl_surface")), 1);
+    QCOMPARE(statistics.resources.value(QByteArrayLiteral("wl_callback")), 1);
+    QVERIFY(statistics.resources.value(QByteArrayLiteral("wl_buffer")) >= 1);
+    QVERIFY(statistics.shmBufferBytes >= quint64(16 * 16 * 4));
+
+    // wl_callback.done and wl_display.delete_id, each with a header and one argument
+    const quint64 events = statistics.events;
+    const quint64 eventBytes = statistics.eventBytes;
+    serverSurface->frameRendered(10);
+    QVERIFY(frameRenderedSpy.wait());
+    statistics = connection->statistics();
+    QCOMPARE(statistics.events, events + 2);
+    QCOMPARE(statistics.eventBytes, eventBytes + 24);
+    QCOMPARE(statistics.resources.value(QByteArrayLiteral("wl_callback")), 0);
+    connection->flush();
+    QCOMPARE(connection->statistics().pendingEventBytes, quint64(0));
+
+    QSignalSpy snapshotSpy(&display, &Display::clientStatisticsSnapshot);
+    display.setClientStatisticsInterval(10);
+    QCOMPARE(display.clientStatisticsInterval(), 10);
+    QVERIFY(snapshotSpy.wait());
+    const auto snapshot = snapshotSpy.first().first().value<QHash<ClientConnection *, ClientStatistics>>();
+    QCOMPARE(snapshot.count(), 1);
+    QCOMPARE(snapshot.value(connection).commits, quint64(3));
+
+    // disabling keeps the counters, but does not update them any more
+    display.setClientStatisticsEnabled(false);
+    QVERIFY(!display.isClientStatisticsEnabled());
+    s->commit(KWayland::Client::Surface::CommitFlag::None);
+    QVERIFY(committedSpy.wait());
+    QCOMPARE(connection->statistics().commits, quint64(3));
+    snapshotSpy.clear();
+    QVERIFY(!snapshotSpy.wait(50));
+}
+
+void TestWaylandServerDisplay::testFloodingClient()
+{
+    // a client flooding the display must neither delay the requests of the other clients nor
+    // use up the whole dispatch budget
+    Display display;
+    display.addSocketName(QStringLiteral("kwin-wayland-server-display-test-flooding-0"));
+    display.start();
+    display.createShm();
+    CompositorInterface compositorInterface(&display);
+
+    const int requestBudget = 2000;
+    display.setDispatchBudget(requestBudget, std::chrono::microseconds::zero());
+    QCOMPARE(display.dispatchRequestBudget(), requestBudget);
+    QCOMPARE(display.dispatchTimeBudget(), std::chrono::microseconds::zero());
+
+    TestClient floodClient;
+    QVERIFY(floodClient.connectToServer(display.socketNames().constFirst()));
+    TestClient client;
+    QVERIFY(client.connectToServer(display.socketNames().constFirst()));
+
+    QSignalSpy serverSurfaceCreated(&compositorInterface, &CompositorInterface::surfaceCreated);
+    QScopedPointer<KWayland::Client::Surface> floodSurface(floodClient.compositor->createSurface());
+    QVERIFY(serverSurfaceCreated.wait());
+    QScopedPointer<KWayland::Client::Surface> surface(client.compositor->createSurface());
+    QVERIFY(serverSurfaceCreated.wait());
+    SurfaceInterface *serverFloodSurface = serverSurfaceCreated.first().first().value<SurfaceInterface *>();
+    SurfaceInterface *serverSurface = serverSurfaceCreated.last().first().value<SurfaceInterface *>();
+    QSignalSpy floodCommittedSpy(serverFloodSurface, &SurfaceInterface::committed);
+    QSignalSpy committedSpy(serverSurface, &SurfaceInterface::committed);
+    quint64 commitIteration = 0;
+    connect(serverSurface, &SurfaceInterface::committed, this, [&display, &commitIteration]() {
+        commitIteration = display.dispatchStatistics().iterations;
+    });
+
+    // the flood takes more than twenty reads of the connection buffer, the burst of the other
+    // client two, so without a budget its commit is only processed in the second iteration
+    const int floodCount = 4000;
+    for (int i = 0; i < floodCount; ++i) {
+        floodSurface->damage(QRect(i % 100, 0, 1, 1));
+    }
+    floodSurface->commit(KWayland::Client::Surface::CommitFlag::None);
+    floodClient.connection->flush();
+    const int burstCount = 300;
+    for (int i = 0; i < burstCount; ++i) {
+        surface->damage(QRect(i % 100, 0, 1, 1));
+    }
+    surface->commit(KWayland::Client::Surface::CommitFlag::None);
+    client.connection->flush();
+
+    display.resetDispatchStatistics();
+    QVERIFY(committedSpy.wait());
+    QCOMPARE(commitIteration, quint64(1));
+    QVERIFY(floodCommittedSpy.isEmpty());
+
+    // the iteration ended once only the flooding client was left, before the budget was used up
+    DispatchStatistics statistics = display.dispatchStatistics();
+    QCOMPARE(statistics.iterations, quint64(1));
+    QVERIFY(statistics.requests >= quint64(burstCount + 1));
+    QVERIFY(statistics.requests < quint64(requestBudget));
+    QCOMPARE(statistics.deferredIterations, quint64(1));
+
+    QVERIFY(floodCommittedSpy.wait());
+    statistics = display.dispatchStatistics();
+    QVERIFY(statistics.requests >= quint64(floodCount + burstCount + 2));
+    QVERIFY(statistics.iterations > 1);
+    QVERIFY(statistics.rounds >= statistics.iterations);
+    QVERIFY(statistics.deferredClients >= statistics.deferredIterations);
+    QVERIFY(statistics.longestIteration > std::chrono::nanoseconds::zero());
+}
+
 QTEST_GUILESS_MAIN(TestWaylandServerDisplay)
 #include "test_display.moc"
@@ -154,6 +154,7 @@ private Q_SLOTS:
     void testAdd();
     void testActivate();
     void testContext();
+    void testSurroundingText();
     void testGrabkeyboard();
     void testContentHints_data();
     void testContentHints();
@@ -442,6 +443,52 @@ void TestInputMethodInterface::testContext()
     QVERIFY(!m_inputMethod->context());
 }
 
+void TestInputMethodInterface::testSurroundingText()
+{
+    // this test verifies that unchanged surrounding text is not sent again
+    QVERIFY(m_inputMethodIface);
+    QSignalSpy inputMethodActivateSpy(m_inputMethod, &InputMethodV1::activated);
+    QVERIFY(inputMethodActivateSpy.isValid());
+    QSignalSpy inputMethodDeactivateSpy(m_inputMethod, &InputMethodV1::deactivated);
+    QVERIFY(inputMethodDeactivateSpy.isValid());
+
+    m_inputMethodIface->sendActivate();
+    QVERIFY(inputMethodActivateSpy.wait());
+
+    KWaylandServer::InputMethodContextV1Interface *serverContext = m_inputMethodIface->context();
+    QVERIFY(serverContext);
+    InputMethodV1Context *imContext = m_inputMethod->context();
+    QVERIFY(imContext);
+
+    QSignalSpy surroundingTextSpy(imContext, &InputMethodV1Context::surrounding_text);
+    QVERIFY(surroundingTextSpy.isValid());
+    serverContext->sendSurroundingText("Hello Plasma!", 2, 4);
+    QVERIFY(surroundingTextSpy.wait());
+    QCOMPARE(surroundingTextSpy.count(), 1);
+
+    // the same text is skipped, the UTF-8 variant is sent as is
+    serverContext->sendSurroundingText("Hello Plasma!", 2, 4);
+    serverContext->sendSurroundingTextUtf8(QByteArrayLiteral("Hello Plasma M\xc3\xb6bile!"), 6, 6);
+    QVERIFY(surroundingTextSpy.wait());
+    QCOMPARE(surroundingTextSpy.count(), 2);
+    QCOMPARE(surroundingTextSpy.last().at(0).value<QString>(), QString::fromUtf8("Hello Plasma M\u00f6bile!"));
+    QCOMPARE(surroundingTextSpy.last().at(1).value<quint32>(), 6);
+    QCOMPARE(surroundingTextSpy.last().at(2).value<quint32>(), 6);
+
+    // a reset makes the input method forget the surrounding text, so it is sent again
+    QSignalSpy resetSpy(imContext, &InputMethodV1Context::reset);
+    QVERIFY(resetSpy.isValid());
+    serverContext->sendReset();
+    serverContext->sendSurroundingTextUtf8(QByteArrayLiteral("Hello Plasma M\xc3\xb6bile!"), 6, 6);
+    QVERIFY(surroundingTextSpy.wait());
+    QCOMPARE(resetSpy.count(), 1);
+    QCOMPARE(surroundingTextSpy.count(), 3);
+
+    m_inputMethodIface->sendDeactivate();
+    QVERIFY(inputMethodDeactivateSpy.wait());
+    QVERIFY(!m_inputMethodIface->context());
+}
+
 void TestInputMethodInterface::testGrabkeyboard()
 {
     QVERIFY(m_inputMethodIface);
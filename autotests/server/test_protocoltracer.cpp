@@ -0,0 +1,196 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThread>
+#include <QtTest>
+
+#include "../../src/server/compositor_interface.h"
+#include "../../src/server/display.h"
+#include "../../src/server/protocoltracer_p.h"
+
+#include "../../src/client/compositor.h"
+#include "../../src/client/connection_thread.h"
+#include "../../src/client/event_queue.h"
+#include "../../src/client/registry.h"
+#include "../../src/client/surface.h"
+
+using namespace KWaylandServer;
+
+class TestProtocolTracer : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init();
+    void cleanup();
+
+    void testDisabled();
+    void testRecord();
+    void testRingBuffer();
+    void testClear();
+    void testGeneratedHooks();
+};
+
+static const QString s_socketName = QStringLiteral("kwin-wayland-server-protocoltracer-test-0");
+
+static QJsonArray traceEvents(const QByteArray &phase)
+{
+    const QJsonDocument document = QJsonDocument::fromJson(ProtocolTracer::toChromeTrace());
+    const QJsonArray events = document.object().value(QStringLiteral("traceEvents")).toArray();
+    QJsonArray filtered;
+    for (const QJsonValue &event : events) {
+        if (event.toObject().value(QStringLiteral("ph")).toString() == QLatin1String(phase)) {
+            filtered.append(event);
+        }
+    }
+    return filtered;
+}
+
+static void recordMessages(int count)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; ++i) {
+        ProtocolTraceScope::record(ProtocolTraceScope::Request, "wl_surface", "commit", 6, i, start, start + std::chrono::microseconds(1));
+    }
+}
+
+void TestProtocolTracer::init()
+{
+    ProtocolTracer::clear();
+    ProtocolTracer::setEnabled(true);
+}
+
+void TestProtocolTracer::cleanup()
+{
+    ProtocolTracer::setEnabled(false);
+    ProtocolTracer::clear();
+}
+
+void TestProtocolTracer::testDisabled()
+{
+    ProtocolTracer::setEnabled(false);
+    QVERIFY(!ProtocolTracer::isEnabled());
+    {
+        // a disabled scope does not look at the client at all
+        ProtocolTraceScope scope(ProtocolTraceScope::Request, "wl_surface", "commit", 6, nullptr);
+    }
+    QVERIFY(traceEvents("X").isEmpty());
+}
+
+void TestProtocolTracer::testRecord()
+{
+    QVERIFY(ProtocolTracer::isEnabled());
+    const auto start = std::chrono::steady_clock::now();
+    ProtocolTraceScope::record(ProtocolTraceScope::Request, "wl_surface", "attach", 1, 42, start, start + std::chrono::nanoseconds(2500));
+    ProtocolTraceScope::record(ProtocolTraceScope::Event, "wl_callback", "done", 0, 42, start, start + std::chrono::microseconds(3));
+
+    const QJsonArray events = traceEvents("X");
+    QCOMPARE(events.count(), 2);
+
+    const QJsonObject request = events.at(0).toObject();
+    QCOMPARE(request.value(QStringLiteral("name")).toString(), QStringLiteral("wl_surface.attach"));
+    QCOMPARE(request.value(QStringLiteral("cat")).toString(), QStringLiteral("request"));
+    QCOMPARE(request.value(QStringLiteral("tid")).toInt(), 42);
+    QCOMPARE(request.value(QStringLiteral("pid")).toInt(), int(QCoreApplication::applicationPid()));
+    QCOMPARE(request.value(QStringLiteral("dur")).toDouble(), 2.5);
+    QCOMPARE(request.value(QStringLiteral("args")).toObject().value(QStringLiteral("opcode")).toInt(), 1);
+
+    const QJsonObject event = events.at(1).toObject();
+    QCOMPARE(event.value(QStringLiteral("name")).toString(), QStringLiteral("wl_callback.done"));
+    QCOMPARE(event.value(QStringLiteral("cat")).toString(), QStringLiteral("event"));
+    QCOMPARE(event.value(QStringLiteral("ts")).toDouble(), request.value(QStringLiteral("ts")).toDouble());
+    QCOMPARE(event.value(QStringLiteral("dur")).toDouble(), 3.0);
+
+    // the client gets a named track
+    const QJsonArray metadata = traceEvents("M");
+    QCOMPARE(metadata.count(), 1);
+    QCOMPARE(metadata.at(0).toObject().value(QStringLiteral("args")).toObject().value(QStringLiteral("name")).toString(), QStringLiteral("client 42"));
+}
+
+void TestProtocolTracer::testRingBuffer()
+{
+    // only the most recent messages are kept
+    recordMessages(ProtocolTracer::capacity() + 10);
+
+    const QJsonArray events = traceEvents("X");
+    QCOMPARE(events.count(), ProtocolTracer::capacity());
+    QCOMPARE(events.first().toObject().value(QStringLiteral("tid")).toInt(), 10);
+    QCOMPARE(events.last().toObject().value(QStringLiteral("tid")).toInt(), ProtocolTracer::capacity() + 9);
+}
+
+void TestProtocolTracer::testClear()
+{
+    recordMessages(5);
+    QCOMPARE(traceEvents("X").count(), 5);
+
+    ProtocolTracer::clear();
+    QVERIFY(traceEvents("X").isEmpty());
+
+    recordMessages(2);
+    QCOMPARE(traceEvents("X").count(), 2);
+}
+
+void TestProtocolTracer::testGeneratedHooks()
+{
+    if (!ProtocolTracer::isAvailable()) {
+        QSKIP("Built without KWAYLAND_PROTOCOL_TRACING");
+    }
+
+    Display display;
+    display.addSocketName(s_socketName);
+    display.start();
+    QVERIFY(display.isRunning());
+    auto serverCompositor = new CompositorInterface(&display, &display);
+
+    auto connection = new KWayland::Client::ConnectionThread;
+    QSignalSpy connectedSpy(connection, &KWayland::Client::ConnectionThread::connected);
+    connection->setSocketName(s_socketName);
+    QThread thread;
+    connection->moveToThread(&thread);
+    thread.start();
+    connection->initConnection();
+    QVERIFY(connectedSpy.wait());
+
+    KWayland::Client::EventQueue queue;
+    queue.setup(connection);
+
+    KWayland::Client::Registry registry;
+    QSignalSpy interfacesAnnouncedSpy(&registry, &KWayland::Client::Registry::interfacesAnnounced);
+    registry.setEventQueue(&queue);
+    registry.create(connection);
+    registry.setup();
+    QVERIFY(interfacesAnnouncedSpy.wait());
+
+    const auto compositorInterface = registry.interface(KWayland::Client::Registry::Interface::Compositor);
+    QScopedPointer<KWayland::Client::Compositor> compositor(registry.createCompositor(compositorInterface.name, compositorInterface.version));
+
+    QSignalSpy surfaceCreatedSpy(serverCompositor, &CompositorInterface::surfaceCreated);
+    QScopedPointer<KWayland::Client::Surface> surface(compositor->createSurface());
+    QVERIFY(surfaceCreatedSpy.wait());
+
+    bool found = false;
+    const QJsonArray events = traceEvents("X");
+    for (const QJsonValue &value : events) {
+        const QJsonObject event = value.toObject();
+        if (event.value(QStringLiteral("name")).toString() == QLatin1String("wl_compositor.create_surface")) {
+            QCOMPARE(event.value(QStringLiteral("cat")).toString(), QStringLiteral("request"));
+            QCOMPARE(event.value(QStringLiteral("tid")).toInt(), int(QCoreApplication::applicationPid()));
+            found = true;
+        }
+    }
+    QVERIFY(found);
+
+    surface.reset();
+    compositor.reset();
+    registry.release();
+    queue.release();
+    connection->deleteLater();
+    thread.quit();
+    thread.wait();
+}
+
+QTEST_GUILESS_MAIN(TestProtocolTracer)
+#include "test_protocoltracer.moc"
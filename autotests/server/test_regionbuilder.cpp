@@ -0,0 +1,180 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#include <QMatrix4x4>
+#include <QtTest>
+
+#include "../../src/server/regionbuilder.h"
+
+using namespace KWaylandServer;
+
+class TestRegionBuilder : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testAdd();
+    void testAddRegion();
+    void testSubtract();
+    void testIntersect();
+    void testRectLimit();
+    void testMap();
+    void testBenchmarkAdd_data();
+    void testBenchmarkAdd();
+};
+
+void TestRegionBuilder::testAdd()
+{
+    RegionBuilder builder;
+    QVERIFY(builder.isEmpty());
+    QCOMPARE(builder.region(), QRegion());
+
+    // empty rectangles are ignored
+    builder.add(QRect(10, 10, 0, 5));
+    QVERIFY(builder.isEmpty());
+
+    QRegion expected;
+    for (int i = 0; i < 50; ++i) {
+        const QRect rect((i * 7) % 100, (i * 13) % 100, 10 + i % 3, 5 + i % 4);
+        builder.add(rect);
+        expected += rect;
+    }
+    QVERIFY(!builder.isEmpty());
+    QVERIFY(!builder.isCollapsed());
+    QCOMPARE(builder.region(), expected);
+    QCOMPARE(builder.boundingRect(), expected.boundingRect());
+
+    // adding after the region has been built continues from it
+    builder.add(QRect(500, 500, 10, 10));
+    expected += QRect(500, 500, 10, 10);
+    QCOMPARE(builder.region(), expected);
+
+    builder.clear();
+    QVERIFY(builder.isEmpty());
+    QCOMPARE(builder.region(), QRegion());
+}
+
+void TestRegionBuilder::testAddRegion()
+{
+    QRegion region(0, 0, 10, 10);
+    region += QRect(20, 20, 10, 10);
+
+    RegionBuilder builder;
+    builder.add(region);
+    QCOMPARE(builder.region(), region);
+
+    builder.add(QRegion(5, 5, 20, 20));
+    QCOMPARE(builder.region(), region.united(QRect(5, 5, 20, 20)));
+}
+
+void TestRegionBuilder::testSubtract()
+{
+    RegionBuilder builder;
+    builder.add(QRect(0, 0, 100, 100));
+    builder.add(QRect(200, 0, 100, 100));
+    builder.subtract(QRect(50, 0, 200, 50));
+
+    QRegion expected = QRegion(0, 0, 100, 100).united(QRect(200, 0, 100, 100));
+    expected -= QRect(50, 0, 200, 50);
+    QCOMPARE(builder.region(), expected);
+    QCOMPARE(builder.boundingRect(), expected.boundingRect());
+
+    // subtracting everything leaves an empty region
+    builder.subtract(QRect(0, 0, 300, 100));
+    QVERIFY(builder.isEmpty());
+    QCOMPARE(builder.region(), QRegion());
+}
+
+void TestRegionBuilder::testIntersect()
+{
+    RegionBuilder builder;
+    builder.add(QRect(0, 0, 100, 100));
+    builder.add(QRect(150, 150, 100, 100));
+
+    builder.intersect(QRect(-10, -10, 500, 500));
+    QCOMPARE(builder.region(), QRegion(0, 0, 100, 100).united(QRect(150, 150, 100, 100)));
+
+    builder.intersect(QRect(50, 50, 150, 150));
+    QCOMPARE(builder.region(), QRegion(50, 50, 50, 50).united(QRect(150, 150, 50, 50)));
+}
+
+void TestRegionBuilder::testRectLimit()
+{
+    RegionBuilder builder(4);
+    QCOMPARE(builder.rectLimit(), 4);
+
+    for (int i = 0; i < 4; ++i) {
+        builder.add(QRect(i * 20, 0, 10, 10));
+    }
+    QVERIFY(!builder.isCollapsed());
+    QCOMPARE(builder.region().rectCount(), 4);
+
+    // one more rectangle collapses the region to its bounding rectangle
+    builder.add(QRect(0, 100, 10, 10));
+    QVERIFY(builder.isCollapsed());
+    QCOMPARE(builder.region(), QRegion(0, 0, 70, 110));
+
+    builder.add(QRect(200, 200, 10, 10));
+    QCOMPARE(builder.region(), QRegion(0, 0, 210, 210));
+
+    // cutting the region makes it exact again
+    builder.intersect(QRect(0, 0, 50, 50));
+    QVERIFY(!builder.isCollapsed());
+    QCOMPARE(builder.region(), QRegion(0, 0, 50, 50));
+
+    builder.clear();
+    QVERIFY(!builder.isCollapsed());
+    QVERIFY(builder.isEmpty());
+}
+
+void TestRegionBuilder::testMap()
+{
+    QRegion region(0, 0, 10, 10);
+    region += QRect(20, 5, 10, 20);
+
+    QMatrix4x4 identity;
+    QCOMPARE(RegionBuilder::map(identity, region), region);
+
+    QMatrix4x4 scale;
+    scale.scale(2, 2);
+    QCOMPARE(RegionBuilder::map(scale, region), QRegion(0, 0, 20, 20).united(QRect(40, 10, 20, 40)));
+
+    QMatrix4x4 transform;
+    transform.translate(5, 7);
+    transform.scale(0.5, 0.5);
+    QRegion expected;
+    for (const QRect &rect : region) {
+        expected += transform.mapRect(rect);
+    }
+    QCOMPARE(RegionBuilder::map(transform, region), expected);
+}
+
+void TestRegionBuilder::testBenchmarkAdd_data()
+{
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("10") << 10;
+    QTest::newRow("100") << 100;
+    QTest::newRow("1000") << 1000;
+}
+
+void TestRegionBuilder::testBenchmarkAdd()
+{
+    // one damage rectangle per text line, as sent by terminals and text editors
+    QFETCH(int, count);
+    QRegion expected;
+    for (int i = 0; i < count; ++i) {
+        expected += QRect((i * 37) % 640, i * 2, 100, 2);
+    }
+
+    QBENCHMARK {
+        RegionBuilder builder;
+        for (int i = 0; i < count; ++i) {
+            builder.add(QRect((i * 37) % 640, i * 2, 100, 2));
+        }
+        QCOMPARE(builder.region(), expected);
+    }
+}
+
+QTEST_GUILESS_MAIN(TestRegionBuilder)
+#include "test_regionbuilder.moc"
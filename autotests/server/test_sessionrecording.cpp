@@ -0,0 +1,210 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#include <QDir>
+#include <QTemporaryDir>
+#include <QTemporaryFile>
+#include <QTextStream>
+#include <QtTest>
+
+#include "../../src/server/compositor_interface.h"
+#include "../../src/server/display.h"
+
+#include "../../src/tools/session/sessionrecording.h"
+#include "../../src/tools/session/sessionreplayer.h"
+
+#include <unistd.h>
+
+using namespace KWaylandServer;
+
+class TestSessionRecording : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testMessageSize();
+    void testStringArgument();
+    void testRoundTrip();
+    void testRewriteBind();
+};
+
+static QByteArray uintArgument(quint32 value)
+{
+    return QByteArray(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+static QByteArray stringArgument(const QByteArray &string)
+{
+    // the length includes the terminating null byte, the string is padded to 32 bits
+    QByteArray argument = uintArgument(string.size() + 1) + string;
+    argument.append(4 - string.size() % 4, '\0');
+    return argument;
+}
+
+static QByteArray message(quint32 objectId, quint16 opcode, const QByteArray &arguments = QByteArray())
+{
+    return uintArgument(objectId) + uintArgument(quint32(Wire::headerSize + arguments.size()) << 16 | opcode) + arguments;
+}
+
+static SessionRecord record(SessionRecord::Type type, const QByteArray &data = QByteArray())
+{
+    SessionRecord record;
+    record.type = type;
+    record.connection = 1;
+    record.data = data;
+    return record;
+}
+
+void TestSessionRecording::testMessageSize()
+{
+    const QByteArray first = message(3, 0, uintArgument(4));
+    const QByteArray second = message(4, 2);
+    QCOMPARE(first.size(), 12);
+
+    QCOMPARE(Wire::messageSize(QByteArray()), 0);
+    QCOMPARE(Wire::messageSize(first.left(Wire::headerSize - 1)), 0);
+    QCOMPARE(Wire::messageSize(first.left(first.size() - 1)), 0);
+    QCOMPARE(Wire::messageSize(first), 12);
+    QCOMPARE(Wire::messageSize(first + second), 12);
+    QCOMPARE(Wire::messageSize(second), Wire::headerSize);
+
+    // a size smaller than the header is never complete
+    QCOMPARE(Wire::messageSize(uintArgument(1) + uintArgument(4 << 16)), 0);
+
+    QCOMPARE(Wire::objectId(first.constData()), 3u);
+    QCOMPARE(Wire::opcode(second.constData()), quint16(2));
+    QCOMPARE(Wire::argument(first.constData(), 0), 4u);
+}
+
+void TestSessionRecording::testStringArgument()
+{
+    // wl_registry.global(name, interface, version)
+    const QByteArray global = message(2, 0, uintArgument(7) + stringArgument("wl_compositor") + uintArgument(4));
+    int offset = Wire::headerSize + 4;
+    QCOMPARE(Wire::stringArgument(global.constData(), global.size(), &offset), QByteArrayLiteral("wl_compositor"));
+    QCOMPARE(offset, Wire::headerSize + 4 + 4 + 16);
+    QCOMPARE(Wire::argument(global.constData(), (offset - Wire::headerSize) / 4), 4u);
+
+    // a string of four characters is followed by a whole word of padding
+    const QByteArray padded = message(2, 0, stringArgument("seat") + uintArgument(1));
+    offset = Wire::headerSize;
+    QCOMPARE(Wire::stringArgument(padded.constData(), padded.size(), &offset), QByteArrayLiteral("seat"));
+    QCOMPARE(offset, Wire::headerSize + 4 + 8);
+
+    // a null string has a length of zero and no content
+    const QByteArray null = message(2, 0, uintArgument(0) + uintArgument(1));
+    offset = Wire::headerSize;
+    QVERIFY(Wire::stringArgument(null.constData(), null.size(), &offset).isNull());
+    QCOMPARE(offset, Wire::headerSize + 4);
+
+    // a string that claims to be longer than the message is not read
+    const QByteArray truncated = message(2, 0, uintArgument(64) + QByteArray("abc", 4));
+    offset = Wire::headerSize;
+    QVERIFY(Wire::stringArgument(truncated.constData(), truncated.size(), &offset).isNull());
+    QVERIFY(offset > truncated.size());
+}
+
+void TestSessionRecording::testRoundTrip()
+{
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+
+    QTemporaryFile pool;
+    QVERIFY(pool.open());
+    QCOMPARE(pool.write(QByteArrayLiteral("pixels")), 6);
+    QVERIFY(pool.flush());
+
+    SessionWriter writer;
+    QVERIFY(writer.open(directory.path()));
+    SessionRecord requests = record(SessionRecord::Type::Requests, message(1, 1, uintArgument(2)));
+    requests.timestamp = 1000;
+    requests.files = {0, -1};
+    writer.write(record(SessionRecord::Type::Connected));
+    writer.write(requests);
+    writer.write(record(SessionRecord::Type::Events, message(2, 0)));
+
+    // the content is captured without moving the file offset, pipes cannot be captured
+    QVERIFY(writer.captureFile(pool.handle(), 0));
+    QCOMPARE(lseek(pool.handle(), 0, SEEK_CUR), off_t(6));
+    int pipeFds[2];
+    QCOMPARE(pipe(pipeFds), 0);
+    QVERIFY(!writer.captureFile(pipeFds[0], 1));
+    close(pipeFds[0]);
+    close(pipeFds[1]);
+
+    SessionReader reader;
+    QVERIFY(reader.open(directory.path()));
+    SessionRecord read;
+    QVERIFY(reader.read(&read));
+    QCOMPARE(read.type, SessionRecord::Type::Connected);
+    QCOMPARE(read.connection, 1u);
+    QVERIFY(reader.read(&read));
+    QCOMPARE(read.type, SessionRecord::Type::Requests);
+    QCOMPARE(read.timestamp, qint64(1000));
+    QCOMPARE(read.data, requests.data);
+    QCOMPARE(read.files, requests.files);
+    QVERIFY(reader.read(&read));
+    QCOMPARE(read.type, SessionRecord::Type::Events);
+    QCOMPARE(read.data, message(2, 0));
+    QVERIFY(!reader.read(&read));
+
+    QFile captured(reader.capturedFilePath(0));
+    QVERIFY(captured.open(QIODevice::ReadOnly));
+    QCOMPARE(captured.readAll(), QByteArrayLiteral("pixels"));
+    QVERIFY(!QFile::exists(reader.capturedFilePath(1)));
+
+    // anything else is not a recording
+    QFile garbage(QDir(directory.path()).filePath(QStringLiteral("session.wire")));
+    QVERIFY(garbage.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    garbage.write(QByteArrayLiteral("KWWIRE00"));
+    garbage.close();
+    SessionReader garbageReader;
+    QVERIFY(!garbageReader.open(directory.path()));
+}
+
+void TestSessionRecording::testRewriteBind()
+{
+    // this test verifies that recorded binds are mapped to the globals of the replay compositor
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+
+    SessionWriter writer;
+    QVERIFY(writer.open(directory.path()));
+    writer.write(record(SessionRecord::Type::Connected));
+    // wl_display.get_registry(2)
+    writer.write(record(SessionRecord::Type::Requests, message(1, 1, uintArgument(2))));
+    // the recorded compositor announced its globals under other names
+    writer.write(record(SessionRecord::Type::Events,
+                        message(2, 0, uintArgument(7) + stringArgument("wl_compositor") + uintArgument(4))
+                            + message(2, 0, uintArgument(8) + stringArgument("org_kde_missing") + uintArgument(1))));
+    // wl_registry.bind(7, wl_compositor, 4, 3) and wl_compositor.create_surface(4)
+    writer.write(record(SessionRecord::Type::Requests,
+                        message(2, 0, uintArgument(7) + stringArgument("wl_compositor") + uintArgument(4) + uintArgument(3))
+                            + message(3, 0, uintArgument(4))));
+    // binding a global the replay compositor does not offer drops the requests to it
+    writer.write(record(SessionRecord::Type::Requests,
+                        message(2, 0, uintArgument(8) + stringArgument("org_kde_missing") + uintArgument(1) + uintArgument(5))
+                            + message(5, 0)));
+    writer.write(record(SessionRecord::Type::Disconnected));
+
+    Display display;
+    CompositorInterface compositor(&display);
+    QVERIFY(display.start());
+    QSignalSpy surfaceCreatedSpy(&compositor, &CompositorInterface::surfaceCreated);
+    QVERIFY(surfaceCreatedSpy.isValid());
+
+    Replayer replayer(&display);
+    QVERIFY(replayer.probeGlobals());
+    SessionReader reader;
+    QVERIFY(reader.open(directory.path()));
+    QVERIFY(replayer.replay(&reader, false));
+    QCOMPARE(surfaceCreatedSpy.count(), 1);
+
+    QString report;
+    QTextStream stream(&report);
+    replayer.printReport(stream);
+    QVERIFY(report.contains(QStringLiteral("dropped requests: 2, clients killed by protocol errors: 0")));
+}
+
+QTEST_GUILESS_MAIN(TestSessionRecording)
+#include "test_sessionrecording.moc"
@@ -100,6 +100,7 @@ public:
 private Q_SLOTS:
     void initTestCase();
     void testEnableDisable();
+    void testSurroundingTextDelta();
     void testEvents();
     void testContentPurpose_data();
     void testContentPurpose();
@@ -277,6 +278,84 @@ void TestTextInputV3Interface::testEnableDisable()
     QCOMPARE(surfaceLeaveSpy.count(), 1);
 }
 
+void TestTextInputV3Interface::testSurroundingTextDelta()
+{
+    // this test verifies that the changed range of the surrounding text is reported
+    QSignalSpy serverSurfaceCreatedSpy(m_serverCompositor, &CompositorInterface::surfaceCreated);
+    QVERIFY(serverSurfaceCreatedSpy.isValid());
+    QScopedPointer<KWayland::Client::Surface> clientSurface(m_clientCompositor->createSurface(this));
+    QVERIFY(serverSurfaceCreatedSpy.wait());
+    SurfaceInterface *serverSurface = serverSurfaceCreatedSpy.first().first().value<SurfaceInterface *>();
+    QVERIFY(serverSurface);
+
+    m_serverTextInputV3 = m_seat->textInputV3();
+    QVERIFY(m_serverTextInputV3);
+
+    QSignalSpy textInputEnabledSpy(m_serverTextInputV3, &TextInputV3Interface::enabledChanged);
+    QVERIFY(textInputEnabledSpy.isValid());
+    QSignalSpy surroundingTextChangedSpy(m_serverTextInputV3, &TextInputV3Interface::surroundingTextChanged);
+    QVERIFY(surroundingTextChangedSpy.isValid());
+    QSignalSpy surfaceEnterSpy(m_clientTextInputV3, &TextInputV3::surface_enter);
+    QVERIFY(surfaceEnterSpy.isValid());
+    QSignalSpy surfaceLeaveSpy(m_clientTextInputV3, &TextInputV3::surface_leave);
+    QVERIFY(surfaceLeaveSpy.isValid());
+
+    m_seat->setFocusedTextInputSurface(serverSurface);
+    QVERIFY(surfaceEnterSpy.wait());
+
+    // the first text is reported as inserted entirely
+    m_clientTextInputV3->enable();
+    m_clientTextInputV3->set_surrounding_text("KDE Plasma Desktop", 0, 3);
+    m_clientTextInputV3->commit();
+    QVERIFY(surroundingTextChangedSpy.wait());
+    m_totalCommits++;
+    QCOMPARE(textInputEnabledSpy.count(), 1);
+    QCOMPARE(m_serverTextInputV3->surroundingTextUtf8(), QByteArrayLiteral("KDE Plasma Desktop"));
+    QCOMPARE(m_serverTextInputV3->surroundingTextDelta().position, 0);
+    QCOMPARE(m_serverTextInputV3->surroundingTextDelta().removedLength, 0);
+    QCOMPARE(m_serverTextInputV3->surroundingTextDelta().inserted, QByteArrayLiteral("KDE Plasma Desktop"));
+
+    // changing the text should report only the changed range
+    m_clientTextInputV3->enable();
+    m_clientTextInputV3->set_surrounding_text("KDE Plasma Mobile", 0, 3);
+    m_clientTextInputV3->commit();
+    QVERIFY(surroundingTextChangedSpy.wait());
+    m_totalCommits++;
+    QCOMPARE(m_serverTextInputV3->surroundingText(), QString("KDE Plasma Mobile"));
+    QCOMPARE(m_serverTextInputV3->surroundingTextDelta().position, 11);
+    QCOMPARE(m_serverTextInputV3->surroundingTextDelta().removedLength, 7);
+    QCOMPARE(m_serverTextInputV3->surroundingTextDelta().inserted, QByteArrayLiteral("Mobile"));
+
+    // moving only the cursor results in an empty delta
+    m_clientTextInputV3->enable();
+    m_clientTextInputV3->set_surrounding_text("KDE Plasma Mobile", 4, 4);
+    m_clientTextInputV3->commit();
+    QVERIFY(surroundingTextChangedSpy.wait());
+    m_totalCommits++;
+    QCOMPARE(m_serverTextInputV3->surroundingTextCursorPosition(), 4);
+    QVERIFY(m_serverTextInputV3->surroundingTextDelta().isEmpty());
+
+    // the changed range does not split multi-byte characters
+    m_clientTextInputV3->enable();
+    m_clientTextInputV3->set_surrounding_text("KDE Plasma M\u00f6bile", 4, 4);
+    m_clientTextInputV3->commit();
+    QVERIFY(surroundingTextChangedSpy.wait());
+    m_totalCommits++;
+    QCOMPARE(m_serverTextInputV3->surroundingText(), QString::fromUtf8("KDE Plasma M\u00f6bile"));
+    QCOMPARE(m_serverTextInputV3->surroundingTextDelta().position, 12);
+    QCOMPARE(m_serverTextInputV3->surroundingTextDelta().removedLength, 1);
+    QCOMPARE(m_serverTextInputV3->surroundingTextDelta().inserted, QByteArrayLiteral("\xc3\xb6"));
+    QCOMPARE(surroundingTextChangedSpy.count(), 4);
+
+    m_clientTextInputV3->disable();
+    m_clientTextInputV3->commit();
+    QVERIFY(textInputEnabledSpy.wait());
+    m_totalCommits++;
+
+    m_seat->setFocusedTextInputSurface(nullptr);
+    QVERIFY(surfaceLeaveSpy.wait());
+}
+
 void TestTextInputV3Interface::testEvents()
 {
     // create a surface
@@ -21,6 +21,8 @@
 
 #include "qwayland-viewporter.h"
 
+#include <wayland-client-protocol.h>
+
 using namespace KWaylandServer;
 
 class Viewporter : public QtWayland::wp_viewporter
@@ -41,6 +43,8 @@ public:
 private Q_SLOTS:
     void initTestCase();
     void testCropScale();
+    void testTransform_data();
+    void testTransform();
 
 private:
     KWayland::Client::ConnectionThread *m_connection;
@@ -190,6 +194,91 @@ void TestViewporterInterface::testCropScale()
     QCOMPARE(serverSurface->mapToBuffer(QPointF(0, 0)), QPointF(0, 0));
 }
 
+void TestViewporterInterface::testTransform_data()
+{
+    QTest::addColumn<OutputInterface::Transform>("transform");
+    QTest::addColumn<QSize>("bufferSize");
+    QTest::addColumn<QRectF>("source");
+    QTest::addColumn<QSize>("surfaceSize");
+    QTest::addColumn<QPointF>("topLeft");
+    QTest::addColumn<QPointF>("bottomRight");
+    QTest::addColumn<QPointF>("center");
+
+    // a buffer with scale 2, cropped to the source and scaled to 60x40
+    QTest::newRow("normal") << OutputInterface::Transform::Normal << QSize(200, 100) << QRectF(10, 10, 30, 20) << QSize(100, 50) << QPointF(20, 20) << QPointF(80, 60) << QPointF(50, 40);
+    QTest::newRow("rotated 90") << OutputInterface::Transform::Rotated90 << QSize(200, 100) << QRectF(10, 10, 30, 20) << QSize(50, 100) << QPointF(20, 80) << QPointF(60, 20) << QPointF(40, 50);
+    QTest::newRow("rotated 180") << OutputInterface::Transform::Rotated180 << QSize(200, 100) << QRectF(10, 10, 30, 20) << QSize(100, 50) << QPointF(180, 80) << QPointF(120, 40) << QPointF(150, 60);
+    QTest::newRow("rotated 270") << OutputInterface::Transform::Rotated270 << QSize(200, 100) << QRectF(10, 10, 30, 20) << QSize(50, 100) << QPointF(180, 20) << QPointF(140, 80) << QPointF(160, 50);
+    QTest::newRow("flipped") << OutputInterface::Transform::Flipped << QSize(200, 100) << QRectF(10, 10, 30, 20) << QSize(100, 50) << QPointF(180, 20) << QPointF(120, 60) << QPointF(150, 40);
+    QTest::newRow("flipped 90") << OutputInterface::Transform::Flipped90 << QSize(200, 100) << QRectF(10, 10, 30, 20) << QSize(50, 100) << QPointF(20, 20) << QPointF(60, 80) << QPointF(40, 50);
+    QTest::newRow("flipped 180") << OutputInterface::Transform::Flipped180 << QSize(200, 100) << QRectF(10, 10, 30, 20) << QSize(100, 50) << QPointF(20, 80) << QPointF(80, 40) << QPointF(50, 60);
+    QTest::newRow("flipped 270") << OutputInterface::Transform::Flipped270 << QSize(200, 100) << QRectF(10, 10, 30, 20) << QSize(50, 100) << QPointF(180, 80) << QPointF(140, 20) << QPointF(160, 50);
+
+    // buffers whose size is not a multiple of the scale and crops at fractional positions
+    QTest::newRow("rotated 90 odd size") << OutputInterface::Transform::Rotated90 << QSize(201, 101) << QRectF(10, 10, 30, 20) << QSize(51, 101) << QPointF(20, 81) << QPointF(60, 21) << QPointF(40, 51);
+    QTest::newRow("rotated 180 odd size fractional") << OutputInterface::Transform::Rotated180 << QSize(201, 101) << QRectF(10.5, 10.25, 30, 20) << QSize(101, 51) << QPointF(180, 80.5) << QPointF(120, 40.5) << QPointF(150, 60.5);
+    QTest::newRow("flipped 270 odd size fractional") << OutputInterface::Transform::Flipped270 << QSize(201, 101) << QRectF(10.5, 10.25, 30, 20) << QSize(51, 101) << QPointF(180.5, 80) << QPointF(140.5, 20) << QPointF(160.5, 50);
+    // without a source the whole buffer is scaled to the destination
+    QTest::newRow("normal odd size no source") << OutputInterface::Transform::Normal << QSize(201, 101) << QRectF() << QSize(101, 51) << QPointF(0, 0) << QPointF(201, 101) << QPointF(100.5, 50.5);
+    QTest::newRow("rotated 90 odd size no source") << OutputInterface::Transform::Rotated90 << QSize(201, 101) << QRectF() << QSize(51, 101) << QPointF(0, 101) << QPointF(201, 0) << QPointF(100.5, 50.5);
+}
+
+void TestViewporterInterface::testTransform()
+{
+    QSignalSpy serverSurfaceCreatedSpy(m_serverCompositor, &CompositorInterface::surfaceCreated);
+    QVERIFY(serverSurfaceCreatedSpy.isValid());
+    QScopedPointer<KWayland::Client::Surface> clientSurface(m_clientCompositor->createSurface(this));
+    QVERIFY(serverSurfaceCreatedSpy.wait());
+    SurfaceInterface *serverSurface = serverSurfaceCreatedSpy.first().first().value<SurfaceInterface *>();
+    QVERIFY(serverSurface);
+    QSignalSpy committedSpy(serverSurface, &SurfaceInterface::committed);
+    QVERIFY(committedSpy.isValid());
+
+    QFETCH(OutputInterface::Transform, transform);
+    QFETCH(QSize, bufferSize);
+    QImage image(bufferSize, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::black);
+    clientSurface->attachBuffer(m_shm->createBuffer(image));
+    clientSurface->setScale(2);
+    wl_surface_set_buffer_transform(*clientSurface, int32_t(transform));
+    clientSurface->damage(image.rect());
+    clientSurface->commit(KWayland::Client::Surface::CommitFlag::None);
+    QVERIFY(committedSpy.wait());
+    QTEST(serverSurface->size(), "surfaceSize");
+    QCOMPARE(serverSurface->bufferTransform(), transform);
+
+    QScopedPointer<Viewport> clientViewport(new Viewport);
+    clientViewport->init(m_viewporter->get_viewport(*clientSurface));
+    QFETCH(QRectF, source);
+    if (source.isValid()) {
+        clientViewport->set_source(wl_fixed_from_double(source.x()),
+                                   wl_fixed_from_double(source.y()),
+                                   wl_fixed_from_double(source.width()),
+                                   wl_fixed_from_double(source.height()));
+    }
+    clientViewport->set_destination(60, 40);
+    clientSurface->commit(KWayland::Client::Surface::CommitFlag::None);
+    QVERIFY(committedSpy.wait());
+    QCOMPARE(serverSurface->size(), QSize(60, 40));
+
+    QTEST(serverSurface->mapToBuffer(QPointF(0, 0)), "topLeft");
+    QTEST(serverSurface->mapToBuffer(QPointF(60, 40)), "bottomRight");
+    QTEST(serverSurface->mapToBuffer(QPointF(30, 20)), "center");
+
+    QFETCH(QPointF, center);
+    QCOMPARE(serverSurface->mapFromBuffer(center), QPointF(30, 20));
+
+    // the buffer region covered by the surface is the cropped part of the buffer, regions
+    // can only be compared if the crop is aligned to buffer pixels
+    QFETCH(QPointF, topLeft);
+    QFETCH(QPointF, bottomRight);
+    const QRectF bufferRect = QRectF(topLeft, bottomRight).normalized();
+    if (QRectF(bufferRect.toRect()) == bufferRect) {
+        QCOMPARE(serverSurface->mapToBuffer(QRegion(0, 0, 60, 40)), QRegion(bufferRect.toRect()));
+        QCOMPARE(serverSurface->mapFromBuffer(QRegion(bufferRect.toRect())), QRegion(0, 0, 60, 40));
+    }
+}
+
 QTEST_GUILESS_MAIN(TestViewporterInterface)
 
 #include "test_viewporter_interface.moc"
@@ -0,0 +1,105 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+// Qt
+#include <QtTest>
+// benchmark
+#include "headlesscompositor.h"
+#include "syntheticclient.h"
+
+#include <memory>
+#include <vector>
+
+static const QString s_socketName = QStringLiteral("kwayland-benchmark-commit-0");
+
+class CommitBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void benchmarkCommit_data();
+    void benchmarkCommit();
+
+private:
+    QThread *m_thread = nullptr;
+};
+
+void CommitBenchmark::initTestCase()
+{
+    m_thread = new QThread(this);
+    m_thread->start();
+}
+
+void CommitBenchmark::cleanupTestCase()
+{
+    m_thread->quit();
+    m_thread->wait();
+}
+
+void CommitBenchmark::benchmarkCommit_data()
+{
+    LoadProfile single;
+
+    LoadProfile terminals;
+    terminals.clients = 4;
+    terminals.surfaces = 2;
+    terminals.damage = LoadProfile::Damage::Lines;
+
+    LoadProfile widgets;
+    widgets.clients = 2;
+    widgets.surfaces = 4;
+    widgets.commits = 4;
+    widgets.damage = LoadProfile::Damage::Scattered;
+    widgets.subsurfaceDepth = 2;
+
+    LoadProfile crowded;
+    crowded.clients = 32;
+    crowded.surfaces = 2;
+    crowded.surfaceSize = QSize(64, 64);
+
+    addLoadProfileRows({single, terminals, widgets, crowded});
+}
+
+void CommitBenchmark::benchmarkCommit()
+{
+    // measures the time from the clients flushing a frame of commits to the compositor having
+    // applied all of them
+    QFETCH(LoadProfile, profile);
+
+    HeadlessCompositor compositor;
+    QVERIFY(compositor.start(s_socketName));
+
+    std::vector<std::unique_ptr<SyntheticClient>> clients;
+    int surfaceCount = 0;
+    for (int i = 0; i < profile.clients; ++i) {
+        auto client = std::make_unique<SyntheticClient>(m_thread);
+        QVERIFY(client->connectToServer(s_socketName));
+        QVERIFY(client->createSurfaces(profile));
+        surfaceCount += client->surfaceCount();
+        clients.push_back(std::move(client));
+    }
+    QVERIFY(waitFor([&compositor, surfaceCount]() {
+        return compositor.surfaces().count() == surfaceCount;
+    }));
+
+    int frame = 0;
+    QBENCHMARK {
+        const quint64 expected = compositor.commitCount() + quint64(surfaceCount) * profile.commits;
+        for (int i = 0; i < profile.commits; ++i, ++frame) {
+            for (const auto &client : clients) {
+                client->commitFrame(profile, frame);
+            }
+        }
+        for (const auto &client : clients) {
+            client->flush();
+        }
+        QVERIFY(waitFor([&compositor, expected]() {
+            return compositor.commitCount() >= expected;
+        }));
+    }
+}
+
+QTEST_GUILESS_MAIN(CommitBenchmark)
+#include "bench_commit.moc"
@@ -0,0 +1,82 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+// Qt
+#include <QtTest>
+// server
+#include "../src/server/display.h"
+// benchmark
+#include "headlesscompositor.h"
+#include "syntheticclient.h"
+
+#include <memory>
+#include <vector>
+
+static const QString s_socketName = QStringLiteral("kwayland-benchmark-connect-0");
+
+class ConnectBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void benchmarkConnect_data();
+    void benchmarkConnect();
+
+private:
+    QThread *m_thread = nullptr;
+};
+
+void ConnectBenchmark::initTestCase()
+{
+    m_thread = new QThread(this);
+    m_thread->start();
+}
+
+void ConnectBenchmark::cleanupTestCase()
+{
+    m_thread->quit();
+    m_thread->wait();
+}
+
+void ConnectBenchmark::benchmarkConnect_data()
+{
+    LoadProfile single;
+
+    LoadProfile nested;
+    nested.surfaces = 4;
+    nested.subsurfaceDepth = 4;
+
+    LoadProfile startup;
+    startup.clients = 16;
+
+    addLoadProfileRows({single, nested, startup});
+}
+
+void ConnectBenchmark::benchmarkConnect()
+{
+    // measures a session start: the clients connect, bind the globals and map their surfaces,
+    // then disconnect again
+    QFETCH(LoadProfile, profile);
+
+    HeadlessCompositor compositor;
+    QVERIFY(compositor.start(s_socketName));
+
+    QBENCHMARK {
+        std::vector<std::unique_ptr<SyntheticClient>> clients;
+        for (int i = 0; i < profile.clients; ++i) {
+            auto client = std::make_unique<SyntheticClient>(m_thread);
+            QVERIFY(client->connectToServer(s_socketName));
+            QVERIFY(client->createSurfaces(profile));
+            clients.push_back(std::move(client));
+        }
+        clients.clear();
+        QVERIFY(waitFor([&compositor]() {
+            return compositor.display()->connections().isEmpty();
+        }));
+    }
+}
+
+QTEST_GUILESS_MAIN(ConnectBenchmark)
+#include "bench_connect.moc"
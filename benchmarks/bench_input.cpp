@@ -0,0 +1,121 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+// Qt
+#include <QtTest>
+// client
+#include "../src/client/pointer.h"
+// server
+#include "../src/server/seat_interface.h"
+#include "../src/server/xdgshell_interface.h"
+// benchmark
+#include "headlesscompositor.h"
+#include "syntheticclient.h"
+
+#include <memory>
+#include <vector>
+
+static const QString s_socketName = QStringLiteral("kwayland-benchmark-input-0");
+
+class InputBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void benchmarkPointerMotion_data();
+    void benchmarkPointerMotion();
+
+private:
+    QThread *m_thread = nullptr;
+};
+
+void InputBenchmark::initTestCase()
+{
+    m_thread = new QThread(this);
+    m_thread->start();
+}
+
+void InputBenchmark::cleanupTestCase()
+{
+    m_thread->quit();
+    m_thread->wait();
+}
+
+void InputBenchmark::benchmarkPointerMotion_data()
+{
+    LoadProfile single;
+    single.motionEvents = 1;
+
+    LoadProfile burst;
+    burst.motionEvents = 64;
+
+    LoadProfile busy;
+    busy.clients = 8;
+    busy.surfaces = 2;
+    busy.motionEvents = 16;
+
+    addLoadProfileRows({single, burst, busy});
+}
+
+void InputBenchmark::benchmarkPointerMotion()
+{
+    // measures the latency from the seat sending pointer frames until the focused client
+    // has received all of them, the other clients only keep the compositor busy
+    QFETCH(LoadProfile, profile);
+    if (profile.motionEvents == 0) {
+        QSKIP("The profile does not send any motion events");
+    }
+
+    HeadlessCompositor compositor;
+    QVERIFY(compositor.start(s_socketName));
+
+    std::vector<std::unique_ptr<SyntheticClient>> clients;
+    for (int i = 0; i < profile.clients; ++i) {
+        auto client = std::make_unique<SyntheticClient>(m_thread);
+        QVERIFY(client->connectToServer(s_socketName));
+        QVERIFY(client->createSurfaces(profile));
+        clients.push_back(std::move(client));
+    }
+    const int toplevelCount = profile.clients * profile.surfaces;
+    QVERIFY(waitFor([&compositor, toplevelCount]() {
+        return compositor.toplevels().count() == toplevelCount;
+    }));
+
+    KWayland::Client::Pointer *pointer = clients.front()->pointer();
+    bool entered = false;
+    quint64 frames = 0;
+    connect(pointer, &KWayland::Client::Pointer::entered, this, [&entered]() {
+        entered = true;
+    });
+    connect(pointer, &KWayland::Client::Pointer::frame, this, [&frames]() {
+        ++frames;
+    });
+
+    KWaylandServer::SeatInterface *seat = compositor.seat();
+    quint32 timestamp = 0;
+    seat->setTimestamp(++timestamp);
+    seat->setFocusedPointerSurface(compositor.toplevels().first()->surface());
+    QVERIFY(waitFor([&entered]() {
+        return entered;
+    }));
+
+    const int width = profile.surfaceSize.width();
+    QBENCHMARK {
+        const quint64 expected = frames + profile.motionEvents;
+        for (int i = 0; i < profile.motionEvents; ++i) {
+            seat->setTimestamp(++timestamp);
+            seat->notifyPointerMotion(QPointF(timestamp % width, timestamp % width));
+            seat->notifyPointerFrame();
+        }
+        QVERIFY(waitFor([&frames, expected]() {
+            return frames >= expected;
+        }));
+    }
+
+    disconnect(pointer, nullptr, this, nullptr);
+}
+
+QTEST_GUILESS_MAIN(InputBenchmark)
+#include "bench_input.moc"
@@ -0,0 +1,89 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#include "headlesscompositor.h"
+
+#include "../src/server/compositor_interface.h"
+#include "../src/server/display.h"
+#include "../src/server/output_interface.h"
+#include "../src/server/seat_interface.h"
+#include "../src/server/subcompositor_interface.h"
+#include "../src/server/surface_interface.h"
+#include "../src/server/xdgshell_interface.h"
+
+using namespace KWaylandServer;
+
+HeadlessCompositor::HeadlessCompositor(QObject *parent)
+    : QObject(parent)
+    , m_display(new Display(this))
+{
+    m_display->createShm();
+    m_compositor = new CompositorInterface(m_display, m_display);
+    m_subCompositor = new SubCompositorInterface(m_display, m_display);
+    m_xdgShell = new XdgShellInterface(m_display, m_display);
+
+    m_output = new OutputInterface(m_display, m_display);
+    m_output->setMode(QSize(1920, 1080));
+
+    m_seat = new SeatInterface(m_display, m_display);
+    m_seat->setName(QStringLiteral("seat0"));
+    m_seat->setHasPointer(true);
+    m_seat->setHasKeyboard(true);
+
+    connect(m_compositor, &CompositorInterface::surfaceCreated, this, &HeadlessCompositor::handleSurfaceCreated);
+    connect(m_xdgShell, &XdgShellInterface::toplevelCreated, this, &HeadlessCompositor::handleToplevelCreated);
+}
+
+HeadlessCompositor::~HeadlessCompositor() = default;
+
+bool HeadlessCompositor::start(const QString &socketName)
+{
+    return m_display->addSocketName(socketName) && m_display->start();
+}
+
+Display *HeadlessCompositor::display() const
+{
+    return m_display;
+}
+
+SeatInterface *HeadlessCompositor::seat() const
+{
+    return m_seat;
+}
+
+QVector<SurfaceInterface *> HeadlessCompositor::surfaces() const
+{
+    return m_surfaces;
+}
+
+QVector<XdgToplevelInterface *> HeadlessCompositor::toplevels() const
+{
+    return m_toplevels;
+}
+
+quint64 HeadlessCompositor::commitCount() const
+{
+    return m_commitCount;
+}
+
+void HeadlessCompositor::handleSurfaceCreated(SurfaceInterface *surface)
+{
+    m_surfaces.append(surface);
+    connect(surface, &SurfaceInterface::committed, this, [this]() {
+        ++m_commitCount;
+    });
+    connect(surface, &SurfaceInterface::aboutToBeDestroyed, this, [this, surface]() {
+        m_surfaces.removeOne(surface);
+    });
+}
+
+void HeadlessCompositor::handleToplevelCreated(XdgToplevelInterface *toplevel)
+{
+    m_toplevels.append(toplevel);
+    connect(toplevel, &XdgToplevelInterface::initializeRequested, toplevel, [toplevel]() {
+        toplevel->sendConfigure(QSize(), XdgToplevelInterface::States());
+    });
+    connect(toplevel, &XdgToplevelInterface::aboutToBeDestroyed, this, [this, toplevel]() {
+        m_toplevels.removeOne(toplevel);
+    });
+}
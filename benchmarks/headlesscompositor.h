@@ -0,0 +1,61 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#pragma once
+
+#include <QObject>
+#include <QVector>
+
+namespace KWaylandServer
+{
+class CompositorInterface;
+class Display;
+class OutputInterface;
+class SeatInterface;
+class SubCompositorInterface;
+class SurfaceInterface;
+class XdgShellInterface;
+class XdgToplevelInterface;
+}
+
+/**
+ * An in-process compositor without any output, built from the globals of the server library.
+ *
+ * It configures every toplevel as soon as it is created and counts the commits of all
+ * surfaces, but does not render anything. The compositor runs on the thread it was created
+ * on and is dispatched by the event loop of that thread.
+ */
+class HeadlessCompositor : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit HeadlessCompositor(QObject *parent = nullptr);
+    ~HeadlessCompositor() override;
+
+    bool start(const QString &socketName);
+
+    KWaylandServer::Display *display() const;
+    KWaylandServer::SeatInterface *seat() const;
+
+    QVector<KWaylandServer::SurfaceInterface *> surfaces() const;
+    QVector<KWaylandServer::XdgToplevelInterface *> toplevels() const;
+    /**
+     * Returns the number of commits of all surfaces since the compositor has been created.
+     */
+    quint64 commitCount() const;
+
+private:
+    void handleSurfaceCreated(KWaylandServer::SurfaceInterface *surface);
+    void handleToplevelCreated(KWaylandServer::XdgToplevelInterface *toplevel);
+
+    KWaylandServer::Display *m_display;
+    KWaylandServer::CompositorInterface *m_compositor;
+    KWaylandServer::SubCompositorInterface *m_subCompositor;
+    KWaylandServer::XdgShellInterface *m_xdgShell;
+    KWaylandServer::SeatInterface *m_seat;
+    KWaylandServer::OutputInterface *m_output;
+    QVector<KWaylandServer::SurfaceInterface *> m_surfaces;
+    QVector<KWaylandServer::XdgToplevelInterface *> m_toplevels;
+    quint64 m_commitCount = 0;
+};
@@ -0,0 +1,160 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#include "loadprofile.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTest>
+#include <QTimer>
+
+static QString damageName(LoadProfile::Damage damage)
+{
+    switch (damage) {
+    case LoadProfile::Damage::Full:
+        return QStringLiteral("full");
+    case LoadProfile::Damage::Lines:
+        return QStringLiteral("lines");
+    case LoadProfile::Damage::Scattered:
+        return QStringLiteral("scattered");
+    }
+    Q_UNREACHABLE();
+}
+
+QString LoadProfile::toString() const
+{
+    return QStringLiteral("clients=%1,surfaces=%2,commits=%3,damage=%4,motion=%5,depth=%6,size=%7x%8")
+        .arg(clients)
+        .arg(surfaces)
+        .arg(commits)
+        .arg(damageName(damage))
+        .arg(motionEvents)
+        .arg(subsurfaceDepth)
+        .arg(surfaceSize.width())
+        .arg(surfaceSize.height());
+}
+
+QVector<QRect> LoadProfile::damageRects(int frame) const
+{
+    const int width = surfaceSize.width();
+    const int height = surfaceSize.height();
+    QVector<QRect> rects;
+    switch (damage) {
+    case Damage::Full:
+        rects.append(QRect(QPoint(0, 0), surfaceSize));
+        break;
+    case Damage::Lines: {
+        // a screenful of text lines of varying length, scrolled by one line per frame
+        const int lineHeight = 16;
+        for (int y = 0; y + lineHeight <= height; y += lineHeight) {
+            const int line = y / lineHeight + frame;
+            rects.append(QRect(0, y, width / 4 + (line * 37) % (width - width / 4), lineHeight));
+        }
+        break;
+    }
+    case Damage::Scattered: {
+        // e.g. blinking cursors and spinners of several widgets
+        const int tile = 8;
+        for (int i = 0; i < 64; ++i) {
+            const int x = ((i + frame) * 67) % qMax(width - tile, 1);
+            const int y = ((i + frame) * 131) % qMax(height - tile, 1);
+            rects.append(QRect(x, y, tile, tile));
+        }
+        break;
+    }
+    }
+    return rects;
+}
+
+std::optional<LoadProfile> LoadProfile::fromString(const QString &description)
+{
+    LoadProfile profile;
+    const QStringList entries = description.split(QLatin1Char(','), Qt::SkipEmptyParts);
+    for (const QString &entry : entries) {
+        const int separator = entry.indexOf(QLatin1Char('='));
+        if (separator == -1) {
+            return std::nullopt;
+        }
+        const QString key = entry.left(separator).trimmed();
+        const QString value = entry.mid(separator + 1).trimmed();
+        bool ok = true;
+        if (key == QLatin1String("clients")) {
+            profile.clients = value.toInt(&ok);
+        } else if (key == QLatin1String("surfaces")) {
+            profile.surfaces = value.toInt(&ok);
+        } else if (key == QLatin1String("commits")) {
+            profile.commits = value.toInt(&ok);
+        } else if (key == QLatin1String("motion")) {
+            profile.motionEvents = value.toInt(&ok);
+        } else if (key == QLatin1String("depth")) {
+            profile.subsurfaceDepth = value.toInt(&ok);
+        } else if (key == QLatin1String("damage")) {
+            if (value == QLatin1String("full")) {
+                profile.damage = Damage::Full;
+            } else if (value == QLatin1String("lines")) {
+                profile.damage = Damage::Lines;
+            } else if (value == QLatin1String("scattered")) {
+                profile.damage = Damage::Scattered;
+            } else {
+                ok = false;
+            }
+        } else if (key == QLatin1String("size")) {
+            const QStringList size = value.split(QLatin1Char('x'));
+            ok = size.count() == 2;
+            if (ok) {
+                bool widthOk;
+                bool heightOk;
+                profile.surfaceSize = QSize(size[0].toInt(&widthOk), size[1].toInt(&heightOk));
+                ok = widthOk && heightOk && !profile.surfaceSize.isEmpty();
+            }
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            return std::nullopt;
+        }
+    }
+    if (profile.clients < 1 || profile.surfaces < 1 || profile.commits < 0 || profile.motionEvents < 0 || profile.subsurfaceDepth < 0) {
+        return std::nullopt;
+    }
+    return profile;
+}
+
+QVector<LoadProfile> LoadProfile::fromEnvironment()
+{
+    QVector<LoadProfile> profiles;
+    const QString variable = qEnvironmentVariable("KWAYLAND_BENCHMARK_PROFILES");
+    const QStringList descriptions = variable.split(QLatin1Char(';'), Qt::SkipEmptyParts);
+    for (const QString &description : descriptions) {
+        if (const std::optional<LoadProfile> profile = fromString(description)) {
+            profiles.append(*profile);
+        } else {
+            qWarning("Ignoring invalid benchmark profile \"%s\"", qPrintable(description));
+        }
+    }
+    return profiles;
+}
+
+void addLoadProfileRows(const QVector<LoadProfile> &defaults)
+{
+    QTest::addColumn<LoadProfile>("profile");
+    for (const LoadProfile &profile : defaults + LoadProfile::fromEnvironment()) {
+        QTest::newRow(qPrintable(profile.toString())) << profile;
+    }
+}
+
+bool waitFor(const std::function<bool()> &condition, int timeout)
+{
+    QElapsedTimer timer;
+    timer.start();
+    // wakes up the event loop in case nothing arrives any more
+    QTimer wakeUp;
+    wakeUp.start(timeout);
+    while (!condition()) {
+        if (timer.elapsed() >= timeout) {
+            return false;
+        }
+        QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+    }
+    return true;
+}
@@ -0,0 +1,73 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#pragma once
+
+#include <QMetaType>
+#include <QRect>
+#include <QSize>
+#include <QString>
+#include <QVector>
+
+#include <functional>
+#include <optional>
+
+/**
+ * Describes the load the synthetic clients put on the headless compositor.
+ *
+ * A profile can be written as a comma separated list of keys and values, e.g.
+ * @c "clients=4,surfaces=8,commits=2,damage=lines,motion=16,depth=2". Additional profiles
+ * can be passed to the benchmarks through the @c KWAYLAND_BENCHMARK_PROFILES environment
+ * variable, separated by semicolons.
+ */
+struct LoadProfile {
+    enum class Damage {
+        // the whole surface
+        Full,
+        // one rectangle per text line, as sent by terminals and text editors
+        Lines,
+        // many small rectangles spread over the surface
+        Scattered,
+    };
+
+    // the number of client connections
+    int clients = 1;
+    // the number of toplevel surfaces per client
+    int surfaces = 1;
+    // the number of commits per surface and benchmark iteration
+    int commits = 1;
+    Damage damage = Damage::Full;
+    // the number of pointer motion frames per benchmark iteration
+    int motionEvents = 0;
+    // the length of the chain of sub-surfaces below every toplevel surface
+    int subsurfaceDepth = 0;
+    QSize surfaceSize = QSize(256, 256);
+
+    QString toString() const;
+    /**
+     * Returns the damage of the @p frame-th commit of a surface.
+     */
+    QVector<QRect> damageRects(int frame) const;
+
+    static std::optional<LoadProfile> fromString(const QString &description);
+    /**
+     * Returns the profiles listed in the @c KWAYLAND_BENCHMARK_PROFILES environment variable.
+     */
+    static QVector<LoadProfile> fromEnvironment();
+};
+
+Q_DECLARE_METATYPE(LoadProfile)
+
+/**
+ * Adds a @c profile column to the current benchmark data and a row for each of the
+ * @p defaults, followed by the profiles from the environment.
+ */
+void addLoadProfileRows(const QVector<LoadProfile> &defaults);
+
+/**
+ * Processes events until @p condition is met or @p timeout milliseconds have passed.
+ *
+ * Unlike QTest::qWaitFor this does not sleep between the checks, which would dominate the
+ * measured times.
+ */
+bool waitFor(const std::function<bool()> &condition, int timeout = 5000);
@@ -0,0 +1,206 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#include "syntheticclient.h"
+
+#include "../src/client/buffer.h"
+#include "../src/client/compositor.h"
+#include "../src/client/connection_thread.h"
+#include "../src/client/event_queue.h"
+#include "../src/client/pointer.h"
+#include "../src/client/registry.h"
+#include "../src/client/seat.h"
+#include "../src/client/shm_pool.h"
+#include "../src/client/subcompositor.h"
+#include "../src/client/subsurface.h"
+#include "../src/client/surface.h"
+#include "../src/client/xdgshell.h"
+
+#include <QImage>
+#include <QThread>
+
+using namespace KWayland::Client;
+
+SyntheticClient::SyntheticClient(QThread *connectionThread, QObject *parent)
+    : QObject(parent)
+    , m_connection(new ConnectionThread)
+{
+    m_connection->moveToThread(connectionThread);
+}
+
+SyntheticClient::~SyntheticClient()
+{
+    // the protocol objects need to go before the connection
+    for (const Window &window : qAsConst(m_windows)) {
+        qDeleteAll(window.subsurfaceRoles);
+        qDeleteAll(window.subsurfaces);
+        delete window.toplevel;
+        delete window.surface;
+    }
+    delete m_pointer;
+    delete m_seat;
+    delete m_shm;
+    delete m_xdgShell;
+    delete m_subCompositor;
+    delete m_compositor;
+    delete m_registry;
+    delete m_queue;
+    m_connection->deleteLater();
+}
+
+bool SyntheticClient::connectToServer(const QString &socketName)
+{
+    bool connected = false;
+    connect(m_connection, &ConnectionThread::connected, this, [&connected]() {
+        connected = true;
+    });
+    m_connection->setSocketName(socketName);
+    m_connection->initConnection();
+    if (!waitFor([&connected]() {
+            return connected;
+        })) {
+        return false;
+    }
+
+    m_queue = new EventQueue(this);
+    m_queue->setup(m_connection);
+
+    m_registry = new Registry(this);
+    m_registry->setEventQueue(m_queue);
+    bool announced = false;
+    connect(m_registry, &Registry::interfacesAnnounced, this, [&announced]() {
+        announced = true;
+    });
+    m_registry->create(m_connection);
+    m_registry->setup();
+    if (!waitFor([&announced]() {
+            return announced;
+        })) {
+        return false;
+    }
+
+    auto bind = [this](Registry::Interface interface) {
+        return m_registry->interface(interface);
+    };
+    m_compositor = m_registry->createCompositor(bind(Registry::Interface::Compositor).name, bind(Registry::Interface::Compositor).version, this);
+    m_subCompositor =
+        m_registry->createSubCompositor(bind(Registry::Interface::SubCompositor).name, bind(Registry::Interface::SubCompositor).version, this);
+    m_xdgShell = m_registry->createXdgShell(bind(Registry::Interface::XdgShellStable).name, bind(Registry::Interface::XdgShellStable).version, this);
+    m_shm = m_registry->createShmPool(bind(Registry::Interface::Shm).name, bind(Registry::Interface::Shm).version, this);
+    m_seat = m_registry->createSeat(bind(Registry::Interface::Seat).name, bind(Registry::Interface::Seat).version, this);
+    if (!m_compositor->isValid() || !m_subCompositor->isValid() || !m_xdgShell->isValid() || !m_shm->isValid() || !m_seat->isValid()) {
+        return false;
+    }
+
+    if (!waitFor([this]() {
+            return m_seat->hasPointer();
+        })) {
+        return false;
+    }
+    m_pointer = m_seat->createPointer(this);
+    return m_pointer->isValid();
+}
+
+bool SyntheticClient::createSurfaces(const LoadProfile &profile)
+{
+    if (!m_buffer) {
+        // all surfaces share one buffer, the content does not matter to the server
+        QImage image(profile.surfaceSize, QImage::Format_ARGB32_Premultiplied);
+        image.fill(Qt::darkCyan);
+        const QSharedPointer<Buffer> buffer = m_shm->createBuffer(image).toStrongRef();
+        buffer->setUsed(true);
+        m_buffer = buffer->buffer();
+    }
+
+    for (int i = 0; i < profile.surfaces; ++i) {
+        Window window;
+        window.surface = m_compositor->createSurface(this);
+        window.toplevel = m_xdgShell->createSurface(window.surface, this);
+
+        Surface *parent = window.surface;
+        for (int depth = 0; depth < profile.subsurfaceDepth; ++depth) {
+            Surface *child = m_compositor->createSurface(this);
+            SubSurface *role = m_subCompositor->createSubSurface(child, parent, this);
+            role->setMode(SubSurface::Mode::Desynchronized);
+            role->setPosition(QPoint(depth + 1, depth + 1));
+            window.subsurfaces.append(child);
+            window.subsurfaceRoles.append(role);
+            parent = child;
+        }
+
+        quint32 configureSerial = 0;
+        bool configured = false;
+        connect(window.toplevel, &XdgShellSurface::configureRequested, this, [&](const QSize &size, XdgShellSurface::States states, quint32 serial) {
+            Q_UNUSED(size)
+            Q_UNUSED(states)
+            configureSerial = serial;
+            configured = true;
+        });
+        window.surface->commit(Surface::CommitFlag::None);
+        if (!waitFor([&configured]() {
+                return configured;
+            })) {
+            return false;
+        }
+        disconnect(window.toplevel, &XdgShellSurface::configureRequested, this, nullptr);
+        window.toplevel->ackConfigure(configureSerial);
+
+        for (Surface *surface : qAsConst(window.subsurfaces)) {
+            surface->attachBuffer(m_buffer);
+            surface->damage(QRect(QPoint(0, 0), profile.surfaceSize));
+            surface->commit(Surface::CommitFlag::None);
+        }
+        window.surface->attachBuffer(m_buffer);
+        window.surface->damage(QRect(QPoint(0, 0), profile.surfaceSize));
+        window.surface->commit(Surface::CommitFlag::None);
+        m_windows.append(window);
+    }
+    flush();
+    return true;
+}
+
+void SyntheticClient::commitFrame(const LoadProfile &profile, int frame)
+{
+    const QVector<QRect> damage = profile.damageRects(frame);
+    auto commit = [&damage](Surface *surface) {
+        for (const QRect &rect : damage) {
+            surface->damage(rect);
+        }
+        surface->commit(Surface::CommitFlag::None);
+    };
+    for (const Window &window : qAsConst(m_windows)) {
+        for (auto it = window.subsurfaces.crbegin(); it != window.subsurfaces.crend(); ++it) {
+            commit(*it);
+        }
+        commit(window.surface);
+    }
+}
+
+void SyntheticClient::flush()
+{
+    m_connection->flush();
+}
+
+QVector<Surface *> SyntheticClient::toplevelSurfaces() const
+{
+    QVector<Surface *> surfaces;
+    surfaces.reserve(m_windows.count());
+    for (const Window &window : m_windows) {
+        surfaces.append(window.surface);
+    }
+    return surfaces;
+}
+
+int SyntheticClient::surfaceCount() const
+{
+    int count = 0;
+    for (const Window &window : m_windows) {
+        count += 1 + window.subsurfaces.count();
+    }
+    return count;
+}
+
+Pointer *SyntheticClient::pointer() const
+{
+    return m_pointer;
+}
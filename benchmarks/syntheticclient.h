@@ -0,0 +1,87 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#pragma once
+
+#include "loadprofile.h"
+
+#include <QObject>
+#include <QVector>
+
+class QThread;
+struct wl_buffer;
+
+namespace KWayland
+{
+namespace Client
+{
+class Compositor;
+class ConnectionThread;
+class EventQueue;
+class Pointer;
+class Registry;
+class Seat;
+class ShmPool;
+class SubCompositor;
+class SubSurface;
+class Surface;
+class XdgShell;
+class XdgShellSurface;
+}
+}
+
+/**
+ * A client connection driven by a LoadProfile.
+ *
+ * The requests are issued from the thread the client was created on, while the connection
+ * reads on @p connectionThread, which can be shared by many clients.
+ */
+class SyntheticClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SyntheticClient(QThread *connectionThread, QObject *parent = nullptr);
+    ~SyntheticClient() override;
+
+    /**
+     * Connects to the compositor and binds its globals.
+     */
+    bool connectToServer(const QString &socketName);
+    /**
+     * Creates the toplevel surfaces of the @p profile, each with a chain of sub-surfaces,
+     * and maps them with a first commit.
+     */
+    bool createSurfaces(const LoadProfile &profile);
+
+    /**
+     * Damages and commits every surface once, from the innermost sub-surface to the toplevel.
+     */
+    void commitFrame(const LoadProfile &profile, int frame);
+    void flush();
+
+    QVector<KWayland::Client::Surface *> toplevelSurfaces() const;
+    int surfaceCount() const;
+    KWayland::Client::Pointer *pointer() const;
+
+private:
+    struct Window {
+        KWayland::Client::Surface *surface = nullptr;
+        KWayland::Client::XdgShellSurface *toplevel = nullptr;
+        // from the toplevel surface down to the innermost sub-surface
+        QVector<KWayland::Client::Surface *> subsurfaces;
+        QVector<KWayland::Client::SubSurface *> subsurfaceRoles;
+    };
+
+    KWayland::Client::ConnectionThread *m_connection;
+    KWayland::Client::EventQueue *m_queue = nullptr;
+    KWayland::Client::Registry *m_registry = nullptr;
+    KWayland::Client::Compositor *m_compositor = nullptr;
+    KWayland::Client::SubCompositor *m_subCompositor = nullptr;
+    KWayland::Client::XdgShell *m_xdgShell = nullptr;
+    KWayland::Client::ShmPool *m_shm = nullptr;
+    KWayland::Client::Seat *m_seat = nullptr;
+    KWayland::Client::Pointer *m_pointer = nullptr;
+    wl_buffer *m_buffer = nullptr;
+    QVector<Window> m_windows;
+};
@@ -10,6 +10,7 @@
 #include "wayland_pointer_p.h"
 // Qt
 #include <QDebug>
+#include <QHash>
 #include <QVector>
 // wayland
 #include "wayland-dde-shell-client-protocol.h"
@@ -43,6 +44,7 @@ public:
 
     WaylandPointer<dde_shell_surface, dde_shell_surface_destroy> ddeShellSurface;
     QPointer<Surface> parentSurface;
+    void setParentSurface(Surface *surface);
     QRect geometry;
     bool active = false;
     bool minimized = false;
@@ -88,11 +90,13 @@ private:
     }
 
     DDEShellSurface *q;
-    static QVector<Private*> s_ddeShellSurfaces;
+    // keyed by the Surface the shell surface was created for, to find it without a scan
+    static QHash<Surface *, Private *> s_ddeShellSurfaces;
+    Surface *surfaceKey = nullptr;
     static const dde_shell_surface_listener s_listener;
 };
 
-QVector<DDEShellSurface::Private*> DDEShellSurface::Private::s_ddeShellSurfaces;
+QHash<Surface *, DDEShellSurface::Private *> DDEShellSurface::Private::s_ddeShellSurfaces;
 
 DDEShell::Private::Private(DDEShell *q)
     : q(q)
@@ -185,7 +189,7 @@ DDEShellSurface *DDEShell::createShellSurface(wl_surface *surface, QObject *pare
         d->queue->addProxy(w);
     }
     s->setup(w);
-    s->d->parentSurface = QPointer<Surface>(kwS);
+    s->d->setParentSurface(kwS);
     return s;
 }
 
@@ -198,12 +202,25 @@ DDEShellSurface *DDEShell::createShellSurface(Surface *surface, QObject *parent)
 DDEShellSurface::Private::Private(DDEShellSurface *q)
     : q(q)
 {
-    s_ddeShellSurfaces << this;
 }
 
 DDEShellSurface::Private::~Private()
 {
-    s_ddeShellSurfaces.removeAll(this);
+    if (surfaceKey) {
+        auto it = s_ddeShellSurfaces.find(surfaceKey);
+        if (it != s_ddeShellSurfaces.end() && it.value() == this) {
+            s_ddeShellSurfaces.erase(it);
+        }
+    }
+}
+
+void DDEShellSurface::Private::setParentSurface(Surface *surface)
+{
+    parentSurface = QPointer<Surface>(surface);
+    if (surface) {
+        surfaceKey = surface;
+        s_ddeShellSurfaces.insert(surface, this);
+    }
 }
 
 DDEShellSurface *DDEShellSurface::Private::get(wl_surface *surface)
@@ -211,12 +228,7 @@ DDEShellSurface *DDEShellSurface::Private::get(wl_surface *surface)
     if (!surface) {
         return nullptr;
     }
-    for (auto it = s_ddeShellSurfaces.constBegin(); it != s_ddeShellSurfaces.constEnd(); ++it) {
-        if ((*it)->parentSurface == Surface::get(surface)) {
-            return (*it)->q;
-        }
-    }
-    return nullptr;
+    return get(Surface::get(surface));
 }
 
 DDEShellSurface *DDEShellSurface::Private::get(Surface *surface)
@@ -224,10 +236,10 @@ DDEShellSurface *DDEShellSurface::Private::get(Surface *surface)
     if (!surface) {
         return nullptr;
     }
-    for (auto it = s_ddeShellSurfaces.constBegin(); it != s_ddeShellSurfaces.constEnd(); ++it) {
-        if ((*it)->parentSurface == surface) {
-            return (*it)->q;
-        }
+    Private *p = s_ddeShellSurfaces.value(surface);
+    // a destroyed Surface may have left its address to a new one
+    if (p && p->parentSurface == surface) {
+        return p->q;
     }
     return nullptr;
 }
@@ -8,6 +8,9 @@
 #include "output.h"
 #include "surface.h"
 #include "wayland_pointer_p.h"
+// Qt
+#include <QHash>
+#include <QPointer>
 // Wayland
 #include <wayland-plasma-shell-client-protocol.h>
 
@@ -32,6 +35,7 @@ public:
     WaylandPointer<org_kde_plasma_surface, org_kde_plasma_surface_destroy> surface;
     QSize size;
     QPointer<Surface> parentSurface;
+    void setParentSurface(Surface *surface);
     PlasmaShellSurface::Role role;
 
     static PlasmaShellSurface *get(Surface *surface);
@@ -41,11 +45,13 @@ private:
     static void autoHidingPanelShownCallback(void *data, org_kde_plasma_surface *org_kde_plasma_surface);
 
     PlasmaShellSurface *q;
-    static QVector<Private *> s_surfaces;
+    // keyed by the Surface the plasma surface was created for, to find it without a scan
+    static QHash<Surface *, Private *> s_surfaces;
+    Surface *surfaceKey = nullptr;
     static const org_kde_plasma_surface_listener s_listener;
 };
 
-QVector<PlasmaShellSurface::Private *> PlasmaShellSurface::Private::s_surfaces;
+QHash<Surface *, PlasmaShellSurface::Private *> PlasmaShellSurface::Private::s_surfaces;
 
 PlasmaShell::PlasmaShell(QObject *parent)
     : QObject(parent)
@@ -110,7 +116,7 @@ PlasmaShellSurface *PlasmaShell::createSurface(wl_surface *surface, QObject *par
         d->queue->addProxy(w);
     }
     s->setup(w);
-    s->d->parentSurface = QPointer<Surface>(kwS);
+    s->d->setParentSurface(kwS);
     return s;
 }
 
@@ -138,12 +144,25 @@ PlasmaShellSurface::Private::Private(PlasmaShellSurface *q)
     : role(PlasmaShellSurface::Role::Normal)
     , q(q)
 {
-    s_surfaces << this;
 }
 
 PlasmaShellSurface::Private::~Private()
 {
-    s_surfaces.removeAll(this);
+    if (surfaceKey) {
+        auto it = s_surfaces.find(surfaceKey);
+        if (it != s_surfaces.end() && it.value() == this) {
+            s_surfaces.erase(it);
+        }
+    }
+}
+
+void PlasmaShellSurface::Private::setParentSurface(Surface *surface)
+{
+    parentSurface = QPointer<Surface>(surface);
+    if (surface) {
+        surfaceKey = surface;
+        s_surfaces.insert(surface, this);
+    }
 }
 
 PlasmaShellSurface *PlasmaShellSurface::Private::get(Surface *surface)
@@ -151,10 +170,10 @@ PlasmaShellSurface *PlasmaShellSurface::Private::get(Surface *surface)
     if (!surface) {
         return nullptr;
     }
-    for (auto it = s_surfaces.constBegin(); it != s_surfaces.constEnd(); ++it) {
-        if ((*it)->parentSurface == surface) {
-            return (*it)->q;
-        }
+    Private *p = s_surfaces.value(surface);
+    // a destroyed Surface may have left its address to a new one
+    if (p && p->parentSurface == surface) {
+        return p->q;
     }
     return nullptr;
 }
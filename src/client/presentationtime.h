@@ -0,0 +1,247 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#ifndef KWAYLAND_CLIENT_PRESENTATIONTIME_H
+#define KWAYLAND_CLIENT_PRESENTATIONTIME_H
+
+#include <QObject>
+
+#include <chrono>
+
+#include <DWayland/Client/kwaylandclient_export.h>
+
+struct wp_presentation;
+struct wp_presentation_feedback;
+
+namespace KWayland
+{
+namespace Client
+{
+class EventQueue;
+class Output;
+class Surface;
+class PresentationFeedback;
+
+/**
+ * @short Wrapper for the wp_presentation interface.
+ *
+ * This class provides a convenient wrapper for the wp_presentation interface.
+ *
+ * To use this class one needs to interact with the Registry. There are two
+ * possible ways to create the PresentationTime interface:
+ * @code
+ * PresentationTime *p = registry->createPresentationTime(name, version);
+ * @endcode
+ *
+ * This creates the PresentationTime and sets it up directly. As an alternative this
+ * can also be done in a more low level way:
+ * @code
+ * PresentationTime *p = new PresentationTime;
+ * p->setup(registry->bindPresentationTime(name, version));
+ * @endcode
+ *
+ * The PresentationTime can be used as a drop-in replacement for any wp_presentation
+ * pointer as it provides matching cast operators.
+ *
+ * @see Registry
+ **/
+class KWAYLANDCLIENT_EXPORT PresentationTime : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * Creates a new PresentationTime.
+     * Note: after constructing the PresentationTime it is not yet valid and one needs
+     * to call setup. In order to get a ready to use PresentationTime prefer using
+     * Registry::createPresentationTime.
+     **/
+    explicit PresentationTime(QObject *parent = nullptr);
+    ~PresentationTime() override;
+
+    /**
+     * Setup this PresentationTime to manage the @p presentation.
+     * When using Registry::createPresentationTime there is no need to call this
+     * method.
+     **/
+    void setup(wp_presentation *presentation);
+    /**
+     * @returns @c true if managing a wp_presentation.
+     **/
+    bool isValid() const;
+    /**
+     * Releases the wp_presentation interface.
+     * After the interface has been released the PresentationTime instance is no
+     * longer valid and can be setup with another wp_presentation interface.
+     **/
+    void release();
+    /**
+     * Destroys the data held by this PresentationTime.
+     * This method is supposed to be used when the connection to the Wayland
+     * server goes away. If the connection is not valid anymore, it's not
+     * possible to call release anymore as that calls into the Wayland
+     * connection and the call would fail. This method cleans up the data, so
+     * that the instance can be deleted or set up to a new wp_presentation interface
+     * once there is a new connection available.
+     *
+     * It is suggested to connect this method to ConnectionThread::connectionDied:
+     * @code
+     * connect(connection, &ConnectionThread::connectionDied, presentation, &PresentationTime::destroy);
+     * @endcode
+     *
+     * @see release
+     **/
+    void destroy();
+
+    /**
+     * Sets the @p queue to use for creating objects with this PresentationTime.
+     **/
+    void setEventQueue(EventQueue *queue);
+    /**
+     * @returns The event queue to use for creating objects with this PresentationTime.
+     **/
+    EventQueue *eventQueue();
+
+    /**
+     * @returns The id of the clock the compositor uses for presentation timestamps,
+     * e.g. @c CLOCK_MONOTONIC. Only valid after clockIdAnnounced has been emitted.
+     **/
+    quint32 clockId() const;
+
+    /**
+     * Requests feedback on when the content of the next commit of @p surface gets presented.
+     *
+     * The request applies to the content update made by the next Surface::commit.
+     * @param surface The Surface to get presentation feedback for
+     * @param parent The parent object for the PresentationFeedback
+     * @returns The created PresentationFeedback
+     **/
+    PresentationFeedback *createFeedback(Surface *surface, QObject *parent = nullptr);
+
+    operator wp_presentation *();
+    operator wp_presentation *() const;
+
+Q_SIGNALS:
+    /**
+     * Emitted when the compositor announces the clock used for presentation timestamps.
+     * @see clockId
+     **/
+    void clockIdAnnounced(quint32 clockId);
+
+    /**
+     * The corresponding global for this interface on the Registry got removed.
+     *
+     * This signal gets only emitted if the PresentationTime got created by
+     * Registry::createPresentationTime
+     **/
+    void removed();
+
+private:
+    class Private;
+    QScopedPointer<Private> d;
+};
+
+/**
+ * A PresentationFeedback reports when a single content update of a Surface has been shown
+ * to the user, or that it will never be shown.
+ *
+ * Exactly one of the signals presented and discarded is emitted. Afterwards the
+ * PresentationFeedback is no longer valid and can be deleted.
+ *
+ * @see PresentationTime
+ **/
+class KWAYLANDCLIENT_EXPORT PresentationFeedback : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * Describes how the content update was presented.
+     **/
+    enum class Kind {
+        VSync = 0x1, ///< The presentation was synchronized to the vertical retrace
+        HwClock = 0x2, ///< The timestamp comes from a hardware clock
+        HwCompletion = 0x4, ///< The hardware signalled the completion of the presentation
+        ZeroCopy = 0x8, ///< The buffer was scanned out directly
+    };
+    Q_DECLARE_FLAGS(Kinds, Kind)
+
+    ~PresentationFeedback() override;
+
+    /**
+     * Setup this PresentationFeedback to manage the @p feedback.
+     * When using PresentationTime::createFeedback there is no need to call this
+     * method.
+     **/
+    void setup(wp_presentation_feedback *feedback);
+    /**
+     * @returns @c true if managing a wp_presentation_feedback.
+     **/
+    bool isValid() const;
+    /**
+     * Releases the wp_presentation_feedback interface.
+     * After the interface has been released the PresentationFeedback instance is no
+     * longer valid and can be setup with another wp_presentation_feedback interface.
+     **/
+    void release();
+    /**
+     * Destroys the data held by this PresentationFeedback.
+     * This method is supposed to be used when the connection to the Wayland
+     * server goes away. If the connection is not valid anymore, it's not
+     * possible to call release anymore as that calls into the Wayland
+     * connection and the call would fail. This method cleans up the data, so
+     * that the instance can be deleted or set up to a new wp_presentation_feedback interface
+     * once there is a new connection available.
+     *
+     * @see release
+     **/
+    void destroy();
+
+    /**
+     * @returns The Output the content update was shown on, may be @c null.
+     **/
+    Output *output() const;
+    /**
+     * @returns The time when the content update turned into light, measured with the clock
+     * from PresentationTime::clockId.
+     **/
+    std::chrono::nanoseconds timestamp() const;
+    /**
+     * @returns The duration of one refresh cycle of the output, or zero if it is unknown.
+     **/
+    std::chrono::nanoseconds refresh() const;
+    /**
+     * @returns The vertical retrace counter of the output, or zero if it is unknown.
+     **/
+    quint64 sequence() const;
+    /**
+     * @returns How the content update was presented.
+     **/
+    Kinds kinds() const;
+
+    operator wp_presentation_feedback *();
+    operator wp_presentation_feedback *() const;
+
+Q_SIGNALS:
+    /**
+     * Emitted when the content update has been shown. The details are available from
+     * output, timestamp, refresh, sequence and kinds.
+     **/
+    void presented();
+    /**
+     * Emitted when the content update will never be shown, for example because it was
+     * superseded by a later commit before being presented.
+     **/
+    void discarded();
+
+private:
+    friend class PresentationTime;
+    explicit PresentationFeedback(QObject *parent = nullptr);
+    class Private;
+    QScopedPointer<Private> d;
+};
+
+}
+}
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(KWayland::Client::PresentationFeedback::Kinds)
+
+#endif
@@ -54,6 +54,8 @@
 #include "ddeshell.h"
 #include "strut.h"
 #include "globalproperty.h"
+#include "presentationtime.h"
+#include "singlepixelbuffer.h"
 // Qt
 #include <QDebug>
 // wayland
@@ -97,6 +99,8 @@
 #include <wayland-strut-client-protocol.h>
 #include <wayland-dde-globalproperty-client-protocol.h>
 #include <wayland-wlr-data-control-unstable-v1-client-protocol.h>
+#include <wayland-presentation-time-client-protocol.h>
+#include <wayland-single-pixel-buffer-v1-client-protocol.h>
 
 /*****
  * How to add another interface:
@@ -462,6 +466,20 @@ static const QMap<Registry::Interface, SuppertedInterfaceData> s_interfaces = {
         &Registry::dataControlDeviceManagerAnnounced,
         &Registry::dataControlDeviceManagerRemoved
     }},
+    {Registry::Interface::PresentationTime, {
+        1,
+        QByteArrayLiteral("wp_presentation"),
+        &wp_presentation_interface,
+        &Registry::presentationTimeAnnounced,
+        &Registry::presentationTimeRemoved
+    }},
+    {Registry::Interface::SinglePixelBufferManager, {
+        1,
+        QByteArrayLiteral("wp_single_pixel_buffer_manager_v1"),
+        &wp_single_pixel_buffer_manager_v1_interface,
+        &Registry::singlePixelBufferManagerAnnounced,
+        &Registry::singlePixelBufferManagerRemoved
+    }},
 };
 // clang-format on
 
@@ -782,6 +800,8 @@ BIND(DDEShell, dde_shell)
 BIND(Strut, com_deepin_kwin_strut)
 BIND(GlobalProperty, dde_globalproperty)
 BIND(DataControlDeviceManager, zwlr_data_control_manager_v1)
+BIND(PresentationTime, wp_presentation)
+BIND(SinglePixelBufferManager, wp_single_pixel_buffer_manager_v1)
 
 #undef BIND
 #undef BIND2
@@ -845,6 +865,8 @@ CREATE(DDESeat)
 CREATE(DDEShell)
 CREATE(Strut)
 CREATE(GlobalProperty)
+CREATE(PresentationTime)
+CREATE(SinglePixelBufferManager)
 
 #undef CREATE
 #undef CREATE2
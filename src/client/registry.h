@@ -62,6 +62,8 @@ struct dde_shell;
 struct com_deepin_kwin_strut;
 struct dde_globalproperty;
 struct zwlr_data_control_manager_v1;
+struct wp_presentation;
+struct wp_single_pixel_buffer_manager_v1;
 
 namespace KWayland
 {
@@ -118,6 +120,8 @@ class DDEShell;
 class Strut;
 class GlobalProperty;
 class DataControlDeviceManager;
+class PresentationTime;
+class SinglePixelBufferManager;
 
 /**
  * @short Wrapper for the wl_registry interface.
@@ -203,6 +207,8 @@ public:
         Strut, ///< refers to com_deepin_kwin_strut interface
         GlobalProperty,
         DataControlDeviceManager, /// refers to zwlr_data_control_manager_v1
+        PresentationTime, ///< refers to wp_presentation
+        SinglePixelBufferManager, ///< refers to wp_single_pixel_buffer_manager_v1
     };
     explicit Registry(QObject *parent = nullptr);
     ~Registry() override;
@@ -776,6 +782,25 @@ public:
      * @since 5.54
      **/
     zwlr_data_control_manager_v1 *bindDataControlDeviceManager(uint32_t name, uint32_t version) const;
+
+    /**
+     * Binds the wp_presentation with @p name and @p version.
+     * If the @p name does not exist or is not for the presentation interface,
+     * @c null will be returned.
+     *
+     * Prefer using createPresentationTime instead.
+     * @see createPresentationTime
+     **/
+    wp_presentation *bindPresentationTime(uint32_t name, uint32_t version) const;
+    /**
+     * Binds the wp_single_pixel_buffer_manager_v1 with @p name and @p version.
+     * If the @p name does not exist or is not for the single pixel buffer manager interface,
+     * @c null will be returned.
+     *
+     * Prefer using createSinglePixelBufferManager instead.
+     * @see createSinglePixelBufferManager
+     **/
+    wp_single_pixel_buffer_manager_v1 *bindSinglePixelBufferManager(uint32_t name, uint32_t version) const;
     ///@}
 
     /**
@@ -1473,6 +1498,37 @@ public:
      * @since 5.54
      **/
     DataControlDeviceManager *createDataControlDeviceManager(quint32 name, quint32 version, QObject *parent = nullptr);
+
+    /**
+     * Creates a PresentationTime and sets it up to manage the interface identified by
+     * @p name and @p version.
+     *
+     * Note: in case @p name is invalid or isn't for the wp_presentation interface,
+     * the returned PresentationTime will not be valid. Therefore it's recommended to call
+     * isValid on the created instance.
+     *
+     * @param name The name of the wp_presentation interface to bind
+     * @param version The version or the wp_presentation interface to use
+     * @param parent The parent for PresentationTime
+     *
+     * @returns The created PresentationTime.
+     **/
+    PresentationTime *createPresentationTime(quint32 name, quint32 version, QObject *parent = nullptr);
+    /**
+     * Creates a SinglePixelBufferManager and sets it up to manage the interface identified by
+     * @p name and @p version.
+     *
+     * Note: in case @p name is invalid or isn't for the wp_single_pixel_buffer_manager_v1
+     * interface, the returned SinglePixelBufferManager will not be valid. Therefore it's
+     * recommended to call isValid on the created instance.
+     *
+     * @param name The name of the wp_single_pixel_buffer_manager_v1 interface to bind
+     * @param version The version or the wp_single_pixel_buffer_manager_v1 interface to use
+     * @param parent The parent for SinglePixelBufferManager
+     *
+     * @returns The created SinglePixelBufferManager.
+     **/
+    SinglePixelBufferManager *createSinglePixelBufferManager(quint32 name, quint32 version, QObject *parent = nullptr);
     ///@}
 
     /**
@@ -1819,6 +1875,20 @@ Q_SIGNALS:
      * @since 5.54
      **/
     void dataControlDeviceManagerAnnounced(quint32 name, quint32 version);
+
+    /**
+     * Emitted whenever a wp_presentation interface gets announced.
+     * @param name The name for the announced interface
+     * @param version The maximum supported version of the announced interface
+     **/
+    void presentationTimeAnnounced(quint32 name, quint32 version);
+
+    /**
+     * Emitted whenever a wp_single_pixel_buffer_manager_v1 interface gets announced.
+     * @param name The name for the announced interface
+     * @param version The maximum supported version of the announced interface
+     **/
+    void singlePixelBufferManagerAnnounced(quint32 name, quint32 version);
     ///@}
 
     /**
@@ -2099,6 +2169,18 @@ Q_SIGNALS:
      * @since 5.54
      **/
     void dataControlDeviceManagerRemoved(quint32 name);
+
+    /**
+     * Emitted whenever a wp_presentation interface gets removed.
+     * @param name The name of the removed interface
+     **/
+    void presentationTimeRemoved(quint32 name);
+
+    /**
+     * Emitted whenever a wp_single_pixel_buffer_manager_v1 interface gets removed.
+     * @param name The name of the removed interface
+     **/
+    void singlePixelBufferManagerRemoved(quint32 name);
     ///@}
     /**
      * Generic announced signal which gets emitted whenever an interface gets
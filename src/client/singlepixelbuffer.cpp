@@ -0,0 +1,98 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#include "singlepixelbuffer.h"
+#include "event_queue.h"
+#include "wayland_pointer_p.h"
+
+#include <QColor>
+
+#include <wayland-single-pixel-buffer-v1-client-protocol.h>
+
+namespace KWayland
+{
+namespace Client
+{
+class Q_DECL_HIDDEN SinglePixelBufferManager::Private
+{
+public:
+    WaylandPointer<wp_single_pixel_buffer_manager_v1, wp_single_pixel_buffer_manager_v1_destroy> manager;
+    EventQueue *queue = nullptr;
+};
+
+SinglePixelBufferManager::SinglePixelBufferManager(QObject *parent)
+    : QObject(parent)
+    , d(new Private)
+{
+}
+
+SinglePixelBufferManager::~SinglePixelBufferManager()
+{
+    release();
+}
+
+void SinglePixelBufferManager::setup(wp_single_pixel_buffer_manager_v1 *manager)
+{
+    Q_ASSERT(manager);
+    Q_ASSERT(!d->manager);
+    d->manager.setup(manager);
+}
+
+void SinglePixelBufferManager::release()
+{
+    d->manager.release();
+}
+
+void SinglePixelBufferManager::destroy()
+{
+    d->manager.destroy();
+}
+
+SinglePixelBufferManager::operator wp_single_pixel_buffer_manager_v1 *()
+{
+    return d->manager;
+}
+
+SinglePixelBufferManager::operator wp_single_pixel_buffer_manager_v1 *() const
+{
+    return d->manager;
+}
+
+bool SinglePixelBufferManager::isValid() const
+{
+    return d->manager.isValid();
+}
+
+void SinglePixelBufferManager::setEventQueue(EventQueue *queue)
+{
+    d->queue = queue;
+}
+
+EventQueue *SinglePixelBufferManager::eventQueue()
+{
+    return d->queue;
+}
+
+static uint32_t toProtocolChannel(quint16 value)
+{
+    // the protocol uses the full 32-bit range for every channel, 0xffff maps to 0xffffffff
+    return uint32_t(value) * 0x10001;
+}
+
+wl_buffer *SinglePixelBufferManager::createBuffer(const QColor &color)
+{
+    Q_ASSERT(isValid());
+    const QRgba64 rgba = color.rgba64().premultiplied();
+    auto buffer = wp_single_pixel_buffer_manager_v1_create_u32_rgba_buffer(d->manager,
+                                                                           toProtocolChannel(rgba.red()),
+                                                                           toProtocolChannel(rgba.green()),
+                                                                           toProtocolChannel(rgba.blue()),
+                                                                           toProtocolChannel(rgba.alpha()));
+    if (d->queue) {
+        d->queue->addProxy(buffer);
+    }
+    return buffer;
+}
+
+}
+}
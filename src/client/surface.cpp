@@ -35,6 +35,9 @@ public:
     void setup(wl_surface *s);
 
     static QList<Surface *> s_surfaces;
+    static const char *const s_surfaceTag;
+
+    Surface *q;
 
 private:
     void handleFrameCallback();
@@ -43,12 +46,12 @@ private:
     static void leaveCallback(void *data, wl_surface *wl_surface, wl_output *output);
     void removeOutput(Output *o);
 
-    Surface *q;
     static const wl_callback_listener s_listener;
     static const wl_surface_listener s_surfaceListener;
 };
 
 QList<Surface *> Surface::Private::s_surfaces = QList<Surface *>();
+const char *const Surface::Private::s_surfaceTag = "KWayland::Client::Surface";
 
 Surface::Private::Private(Surface *q)
     : q(q)
@@ -127,7 +130,10 @@ void Surface::Private::setup(wl_surface *s)
     Q_ASSERT(s);
     Q_ASSERT(!surface);
     surface.setup(s);
-    wl_surface_add_listener(s, &s_surfaceListener, this);
+    if (wl_surface_add_listener(s, &s_surfaceListener, this) == 0) {
+        // Tag the proxy so that Surface::get() can recover us from the listener data
+        wl_proxy_set_tag(reinterpret_cast<wl_proxy *>(s), &s_surfaceTag);
+    }
 }
 
 void Surface::Private::frameCallback(void *data, wl_callback *callback, uint32_t time)
@@ -277,6 +283,13 @@ void Surface::setSize(const QSize &size)
 
 Surface *Surface::get(wl_surface *native)
 {
+    if (!native) {
+        return nullptr;
+    }
+    if (wl_proxy_get_tag(reinterpret_cast<wl_proxy *>(native)) == &Private::s_surfaceTag) {
+        return reinterpret_cast<Private *>(wl_surface_get_user_data(native))->q;
+    }
+    // Foreign surfaces (e.g. created by QtWayland) have no listener of ours, look them up
     auto it = std::find_if(Private::s_surfaces.constBegin(), Private::s_surfaces.constEnd(), [native](Surface *s) {
         return s->d->surface == native;
     });
@@ -251,6 +251,16 @@ void XdgShellSurface::ackConfigure(quint32 serial)
     d->ackConfigure(serial);
 }
 
+void XdgShellSurface::setConfigureCollapseEnabled(bool enabled)
+{
+    d->setConfigureCollapseEnabled(enabled);
+}
+
+bool XdgShellSurface::isConfigureCollapseEnabled() const
+{
+    return d->collapseConfigures;
+}
+
 void XdgShellSurface::setMaximized(bool set)
 {
     if (set) {
@@ -461,6 +461,31 @@ public:
      */
     void setWindowGeometry(const QRect &windowGeometry);
 
+    /**
+     * Sets whether configure events should be collapsed.
+     *
+     * If enabled, configure events are not emitted right away when they are received. Instead,
+     * configureRequested is emitted from the Qt event loop after the EventQueue has dispatched
+     * the events read along with them, and only for the newest configure event. Passing its
+     * serial to ackConfigure also acknowledges the configure events that were skipped. The size
+     * is set to the newest non-empty size of the skipped events if the newest event leaves the
+     * size to the client. This avoids repainting for configure events that are already outdated,
+     * e.g. during an interactive resize.
+     *
+     * Disabling the collapsing emits a configure event that is still held back right away, so
+     * it stays ahead of the configure events received afterwards.
+     *
+     * Collapsing is disabled by default and only supported for the stable xdg-shell.
+     * @see configureRequested
+     **/
+    void setConfigureCollapseEnabled(bool enabled);
+
+    /**
+     * @returns whether configure events are collapsed.
+     * @see setConfigureCollapseEnabled
+     **/
+    bool isConfigureCollapseEnabled() const;
+
     operator xdg_surface *();
     operator xdg_surface *() const;
     operator xdg_toplevel *();
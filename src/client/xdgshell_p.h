@@ -174,6 +174,7 @@ public:
     virtual ~Private();
     EventQueue *queue = nullptr;
     QSize size;
+    bool collapseConfigures = false;
 
     virtual void setupV5(xdg_surface *surface)
     {
@@ -225,6 +226,11 @@ public:
         return nullptr;
     }
 
+    virtual void setConfigureCollapseEnabled(bool enabled)
+    {
+        collapseConfigures = enabled;
+    }
+
     virtual void setTransientFor(XdgShellSurface *parent) = 0;
     virtual void setTitle(const QString &title) = 0;
     virtual void setAppId(const QByteArray &appId) = 0;
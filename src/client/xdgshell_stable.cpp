@@ -272,11 +272,25 @@ public:
     void setMaxSize(const QSize &size) override;
     void setMinSize(const QSize &size) override;
     void setWindowGeometry(const QRect &windowGeometry) override;
+    void setConfigureCollapseEnabled(bool enabled) override;
 
 private:
+    void emitConfigure(const QSize &size, States states, quint32 serial);
+    void flushCollapsedConfigure();
+
     QSize pendingSize;
     States pendingState;
 
+    struct Configure {
+        QSize size;
+        States states;
+        quint32 serial = 0;
+    };
+    Configure collapsedConfigure;
+    // the newest size of the collapsed configure events that was not left to the client
+    QSize collapsedSize;
+    bool collapsedConfigurePending = false;
+
     static void configureCallback(void *data, struct xdg_toplevel *xdg_toplevel, int32_t width, int32_t height, struct wl_array *state);
     static void closeCallback(void *data, xdg_toplevel *xdg_toplevel);
     static void surfaceConfigureCallback(void *data, xdg_surface *xdg_surface, uint32_t serial);
@@ -293,14 +307,62 @@ void XdgTopLevelStable::Private::surfaceConfigureCallback(void *data, struct xdg
 {
     Q_UNUSED(surface)
     auto s = static_cast<Private *>(data);
-    s->q->configureRequested(s->pendingSize, s->pendingState, serial);
-    if (!s->pendingSize.isNull()) {
-        s->q->setSize(s->pendingSize);
-        s->pendingSize = QSize();
+    if (!s->collapseConfigures) {
+        s->emitConfigure(s->pendingSize, s->pendingState, serial);
+    } else {
+        // The queued invocation runs once control returns to the Qt event loop, that is after
+        // the remaining events read along with this one have been dispatched.
+        s->collapsedConfigure = Configure{s->pendingSize, s->pendingState, serial};
+        if (!s->pendingSize.isNull()) {
+            s->collapsedSize = s->pendingSize;
+        }
+        if (!s->collapsedConfigurePending) {
+            s->collapsedConfigurePending = true;
+            QMetaObject::invokeMethod(
+                s->q,
+                [s]() {
+                    s->flushCollapsedConfigure();
+                },
+                Qt::QueuedConnection);
+        }
     }
+    s->pendingSize = QSize();
     s->pendingState = {};
 }
 
+void XdgTopLevelStable::Private::emitConfigure(const QSize &size, States states, quint32 serial)
+{
+    Q_EMIT q->configureRequested(size, states, serial);
+    if (!size.isNull()) {
+        q->setSize(size);
+    }
+}
+
+void XdgTopLevelStable::Private::flushCollapsedConfigure()
+{
+    if (!collapsedConfigurePending) {
+        return;
+    }
+    collapsedConfigurePending = false;
+    const Configure configure = collapsedConfigure;
+    const QSize size = collapsedSize;
+    collapsedSize = QSize();
+    Q_EMIT q->configureRequested(configure.size, configure.states, configure.serial);
+    // a newest configure leaving the size to the client does not undo an earlier size
+    if (!size.isNull()) {
+        q->setSize(size);
+    }
+}
+
+void XdgTopLevelStable::Private::setConfigureCollapseEnabled(bool enabled)
+{
+    XdgShellSurface::Private::setConfigureCollapseEnabled(enabled);
+    // the configure events received from now on are emitted right away, the collapsed one is older
+    if (!enabled) {
+        flushCollapsedConfigure();
+    }
+}
+
 void XdgTopLevelStable::Private::configureCallback(void *data, struct xdg_toplevel *xdg_toplevel, int32_t width, int32_t height, struct wl_array *state)
 {
     Q_UNUSED(xdg_toplevel)
@@ -4,36 +4,19 @@
     SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
 */
 #include "clientconnection.h"
+#include "clientconnection_p.h"
 #include "display.h"
 #include "utils/executable_path.h"
 // Qt
 #include <QFileInfo>
 #include <QVector>
+// std
+#include <cstring>
 // Wayland
 #include <wayland-server.h>
 
 namespace KWaylandServer
 {
-class ClientConnectionPrivate
-{
-public:
-    ClientConnectionPrivate(wl_client *c, Display *display, ClientConnection *q);
-    ~ClientConnectionPrivate();
-
-    wl_client *client;
-    Display *display;
-    pid_t pid = 0;
-    uid_t user = 0;
-    gid_t group = 0;
-    QString executablePath;
-
-private:
-    static void destroyListenerCallback(wl_listener *listener, void *data);
-    ClientConnection *q;
-    wl_listener listener;
-    static QVector<ClientConnectionPrivate *> s_allClients;
-};
-
 QVector<ClientConnectionPrivate *> ClientConnectionPrivate::s_allClients;
 
 ClientConnectionPrivate::ClientConnectionPrivate(wl_client *c, Display *display, ClientConnection *q)
@@ -43,11 +26,96 @@ ClientConnectionPrivate::ClientConnectionPrivate(wl_client *c, Display *display,
 {
     s_allClients << this;
     listener.notify = destroyListenerCallback;
+    listener.connection = this;
     wl_client_add_destroy_listener(c, &listener);
     wl_client_get_credentials(client, &pid, &user, &group);
     executablePath = executablePathFromPid(pid);
 }
 
+ClientConnectionPrivate *ClientConnectionPrivate::get(ClientConnection *connection)
+{
+    return connection->d.data();
+}
+
+ClientConnectionPrivate *ClientConnectionPrivate::get(wl_client *client)
+{
+    // cheaper than searching all connections, a client has only a few destroy listeners
+    wl_listener *listener = wl_client_get_destroy_listener(client, destroyListenerCallback);
+    if (!listener) {
+        return nullptr;
+    }
+    return static_cast<DestroyListener *>(listener)->connection;
+}
+
+static quint32 alignedSize(size_t size)
+{
+    return (size + 3) & ~size_t(3);
+}
+
+static quint32 messageSize(const wl_protocol_logger_message *message)
+{
+    // the object id, the opcode and the size of the message
+    quint32 size = 8;
+    int argument = 0;
+    for (const char *type = message->message->signature; *type && argument < message->arguments_count; ++type) {
+        switch (*type) {
+        case 'i':
+        case 'u':
+        case 'f':
+        case 'o':
+        case 'n':
+            size += 4;
+            ++argument;
+            break;
+        case 's': {
+            const char *string = message->arguments[argument].s;
+            size += 4 + (string ? alignedSize(strlen(string) + 1) : 0);
+            ++argument;
+            break;
+        }
+        case 'a': {
+            const wl_array *array = message->arguments[argument].a;
+            size += 4 + (array ? alignedSize(array->size) : 0);
+            ++argument;
+            break;
+        }
+        case 'h':
+            // file descriptors are passed out of band
+            ++argument;
+            break;
+        default:
+            // the since version and nullable markers
+            break;
+        }
+    }
+    return size;
+}
+
+void ClientConnectionPrivate::recordMessage(wl_protocol_logger_type type, const wl_protocol_logger_message *message)
+{
+    if (type == WL_PROTOCOL_LOGGER_EVENT) {
+        const quint32 size = messageSize(message);
+        ++events;
+        eventBytes += size;
+        pendingEventBytes += size;
+        return;
+    }
+
+    ++requests;
+    // the class is the name of the interface, so a pointer comparison is enough
+    if (message->message_opcode == WL_SURFACE_COMMIT && wl_resource_get_class(message->resource) == wl_surface_interface.name) {
+        ++commits;
+        ++commitsInWindow;
+        if (!commitWindow.isValid()) {
+            commitWindow.start();
+        } else if (const qint64 elapsed = commitWindow.elapsed(); elapsed >= 1000) {
+            commitsPerSecond = commitsInWindow * 1000.0 / elapsed;
+            commitsInWindow = 0;
+            commitWindow.restart();
+        }
+    }
+}
+
 ClientConnectionPrivate::~ClientConnectionPrivate()
 {
     if (client) {
@@ -87,6 +155,7 @@ void ClientConnection::flush()
         return;
     }
     wl_client_flush(d->client);
+    d->pendingEventBytes = 0;
 }
 
 void ClientConnection::destroy()
@@ -145,4 +214,49 @@ QString ClientConnection::executablePath() const
     return d->executablePath;
 }
 
+ClientStatistics ClientConnection::statistics() const
+{
+    ClientStatistics statistics;
+    statistics.requests = d->requests;
+    statistics.events = d->events;
+    statistics.eventBytes = d->eventBytes;
+    statistics.pendingEventBytes = d->pendingEventBytes;
+    statistics.commits = d->commits;
+    statistics.commitsPerSecond = d->commitsPerSecond;
+    if (d->commitWindow.isValid()) {
+        // the client may have stopped committing in the middle of the current window
+        const qint64 elapsed = d->commitWindow.elapsed();
+        if (elapsed >= 1000) {
+            statistics.commitsPerSecond = d->commitsInWindow * 1000.0 / elapsed;
+        }
+    }
+    if (!d->client) {
+        return statistics;
+    }
+
+    struct Resources {
+        QHash<const char *, int> interfaces;
+        quint64 shmBufferBytes = 0;
+    } resources;
+    wl_client_for_each_resource(
+        d->client,
+        [](wl_resource *resource, void *data) {
+            auto resources = static_cast<Resources *>(data);
+            resources->interfaces[wl_resource_get_class(resource)]++;
+            if (wl_shm_buffer *buffer = wl_shm_buffer_get(resource)) {
+                resources->shmBufferBytes += quint64(wl_shm_buffer_get_stride(buffer)) * wl_shm_buffer_get_height(buffer);
+            }
+            return WL_ITERATOR_CONTINUE;
+        },
+        &resources);
+
+    // interface names are shared, so only convert them once per interface
+    statistics.resources.reserve(resources.interfaces.count());
+    for (auto it = resources.interfaces.constBegin(); it != resources.interfaces.constEnd(); ++it) {
+        statistics.resources[QByteArray(it.key())] += it.value();
+    }
+    statistics.shmBufferBytes = resources.shmBufferBytes;
+    return statistics;
+}
+
 }
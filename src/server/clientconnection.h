@@ -7,6 +7,7 @@
 
 #include <sys/types.h>
 
+#include <QHash>
 #include <QObject>
 
 #include <DWayland/Server/kwaylandserver_export.h>
@@ -19,6 +20,51 @@ namespace KWaylandServer
 class ClientConnectionPrivate;
 class Display;
 
+/**
+ * Statistics about the resources and the protocol traffic of a client.
+ *
+ * The traffic counters are only collected while the Display collects client statistics.
+ *
+ * @see ClientConnection::statistics
+ * @see Display::setClientStatisticsEnabled
+ */
+struct ClientStatistics {
+    /**
+     * The number of requests received from the client.
+     */
+    quint64 requests = 0;
+    /**
+     * The number of events sent to the client.
+     */
+    quint64 events = 0;
+    /**
+     * The size of the events sent to the client in bytes, file descriptors not included.
+     */
+    quint64 eventBytes = 0;
+    /**
+     * The size of the events sent to the client since the server library last flushed the
+     * connection. This is an upper bound of the bytes waiting in the outgoing buffer.
+     */
+    quint64 pendingEventBytes = 0;
+    /**
+     * The number of wl_surface.commit requests received from the client.
+     */
+    quint64 commits = 0;
+    /**
+     * The commit rate of the client, averaged over roughly one second.
+     */
+    qreal commitsPerSecond = 0;
+    /**
+     * The size of the wl_shm buffers the client currently holds. Shared memory the server
+     * keeps mapped for the contents of buffers the client already destroyed is not included.
+     */
+    quint64 shmBufferBytes = 0;
+    /**
+     * The number of live resources of the client by interface name, e.g. @c wl_surface.
+     */
+    QHash<QByteArray, int> resources;
+};
+
 /**
  * @brief Convenient Class which represents a wl_client.
  *
@@ -92,6 +138,16 @@ public:
      */
     QString executablePath() const;
 
+    /**
+     * Returns statistics about the resources and the protocol traffic of this client.
+     *
+     * The traffic counters are read in constant time, the resources are counted by
+     * walking all the resources of the client.
+     *
+     * @see Display::setClientStatisticsEnabled
+     */
+    ClientStatistics statistics() const;
+
     /**
      * Cast operator the native wl_client this ClientConnection represents.
      */
@@ -123,8 +179,10 @@ private:
     friend class Display;
     explicit ClientConnection(wl_client *c, Display *parent);
     QScopedPointer<ClientConnectionPrivate> d;
+    friend class ClientConnectionPrivate;
 };
 
 }
 
 Q_DECLARE_METATYPE(KWaylandServer::ClientConnection *)
+Q_DECLARE_METATYPE(KWaylandServer::ClientStatistics)
@@ -0,0 +1,59 @@
+/*
+    SPDX-FileCopyrightText: 2014 Martin Gräßlin <mgraesslin@kde.org>
+
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#pragma once
+
+#include "clientconnection.h"
+
+#include <QElapsedTimer>
+#include <QVector>
+
+#include <wayland-server-core.h>
+
+namespace KWaylandServer
+{
+class ClientConnectionPrivate
+{
+public:
+    ClientConnectionPrivate(wl_client *c, Display *display, ClientConnection *q);
+    ~ClientConnectionPrivate();
+
+    static ClientConnectionPrivate *get(ClientConnection *connection);
+    /**
+     * Returns the private of the ClientConnection that was created for @p client, or
+     * @c null if there is none or the client is being destroyed.
+     */
+    static ClientConnectionPrivate *get(wl_client *client);
+
+    void recordMessage(wl_protocol_logger_type type, const wl_protocol_logger_message *message);
+
+    wl_client *client;
+    Display *display;
+    pid_t pid = 0;
+    uid_t user = 0;
+    gid_t group = 0;
+    QString executablePath;
+
+    // traffic counters, only updated while the Display collects client statistics
+    quint64 requests = 0;
+    quint64 events = 0;
+    quint64 eventBytes = 0;
+    quint64 pendingEventBytes = 0;
+    quint64 commits = 0;
+    // commits are counted in windows of one second to derive the commit rate
+    QElapsedTimer commitWindow;
+    quint64 commitsInWindow = 0;
+    qreal commitsPerSecond = 0;
+
+private:
+    static void destroyListenerCallback(wl_listener *listener, void *data);
+    ClientConnection *q;
+    struct DestroyListener : wl_listener {
+        ClientConnectionPrivate *connection;
+    } listener;
+    static QVector<ClientConnectionPrivate *> s_allClients;
+};
+
+} // namespace KWaylandServer
@@ -53,8 +53,7 @@ void DataSourceInterfacePrivate::data_source_destroy_resource(Resource *resource
 void DataSourceInterfacePrivate::data_source_offer(QtWaylandServer::wl_data_source::Resource *resource, const QString &mime_type)
 {
     Q_UNUSED(resource)
-    mimeTypes << mime_type;
-    Q_EMIT q->mimeTypeOffered(mime_type);
+    offer(mime_type);
 }
 
 void DataSourceInterfacePrivate::data_source_destroy(QtWaylandServer::wl_data_source::Resource *resource)
@@ -4,6 +4,7 @@
 // SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
 
 #include "ddeseat_interface.h"
+#include "clientconnection.h"
 #include "ddekeyboard_interface.h"
 #include "display.h"
 #include "logging.h"
@@ -309,6 +310,128 @@ DDEPointerInterfacePrivate::DDEPointerInterfacePrivate(DDEPointerInterface *q, D
 
 DDEPointerInterfacePrivate::~DDEPointerInterfacePrivate()
 {
+    qDeleteAll(motionFilters);
+}
+
+QList<DDEPointerInterfacePrivate::Resource *> DDEPointerInterfacePrivate::resourcesForClient(wl_client *client) const
+{
+    // the resource the pointer has been created with is not part of the resource map
+    QList<Resource *> resources = resourceMap().values(client);
+    if (resource() && resource()->client() == client) {
+        resources.append(resource());
+    }
+    return resources;
+}
+
+QList<wl_client *> DDEPointerInterfacePrivate::clients() const
+{
+    QList<wl_client *> clients = resourceMap().uniqueKeys();
+    if (resource() && !clients.contains(resource()->client())) {
+        clients.append(resource()->client());
+    }
+    return clients;
+}
+
+void DDEPointerInterfacePrivate::sendMotion(const QPointF &position)
+{
+    const QList<wl_client *> clients = this->clients();
+    for (wl_client *client : clients) {
+        MotionFilter *filter = motionFilters.value(client);
+        if (!filter) {
+            sendMotion(client, position);
+            continue;
+        }
+
+        if (!filter->region.isEmpty()) {
+            const bool inside = filter->region.contains(position.toPoint());
+            const bool wasInside = filter->wasInsideRegion;
+            filter->wasInsideRegion = inside;
+            if (!inside && !wasInside) {
+                continue;
+            }
+        }
+
+        if (filter->interval > 0 && filter->lastMotion.isValid() && filter->lastMotion.elapsed() < filter->interval) {
+            filter->pendingPos = position;
+            filter->hasPendingMotion = true;
+            if (!filter->timer->isActive()) {
+                filter->timer->start(filter->interval - filter->lastMotion.elapsed());
+            }
+            continue;
+        }
+
+        filter->hasPendingMotion = false;
+        filter->timer->stop();
+        filter->lastMotion.start();
+        sendMotion(client, position);
+    }
+}
+
+void DDEPointerInterfacePrivate::sendMotion(wl_client *client, const QPointF &position)
+{
+    const QList<Resource *> resources = resourcesForClient(client);
+    for (Resource *resource : resources) {
+        send_motion(resource->handle, wl_fixed_from_double(position.x()), wl_fixed_from_double(position.y()));
+    }
+}
+
+void DDEPointerInterfacePrivate::sendButton(quint32 button, button_state state)
+{
+    const QPointF globalPos = ddeSeat->pointerPos();
+    const QList<wl_client *> clients = this->clients();
+    for (wl_client *client : clients) {
+        // the client has to see the motion to the position of the button event first
+        flushMotion(client);
+        const QList<Resource *> resources = resourcesForClient(client);
+        for (Resource *resource : resources) {
+            send_button(resource->handle, wl_fixed_from_double(globalPos.x()), wl_fixed_from_double(globalPos.y()), button, state);
+        }
+    }
+}
+
+void DDEPointerInterfacePrivate::sendAxis(Qt::Orientation orientation, qint32 delta)
+{
+    const QList<wl_client *> clients = this->clients();
+    for (wl_client *client : clients) {
+        flushMotion(client);
+        const QList<Resource *> resources = resourcesForClient(client);
+        for (Resource *resource : resources) {
+            send_axis(resource->handle,
+                      0,
+                      (orientation == Qt::Vertical) ? WL_POINTER_AXIS_VERTICAL_SCROLL : WL_POINTER_AXIS_HORIZONTAL_SCROLL,
+                      wl_fixed_from_int(delta));
+        }
+    }
+}
+
+void DDEPointerInterfacePrivate::flushMotion(wl_client *client)
+{
+    MotionFilter *filter = motionFilters.value(client);
+    if (!filter || !filter->hasPendingMotion) {
+        return;
+    }
+    filter->hasPendingMotion = false;
+    filter->lastMotion.start();
+    sendMotion(client, filter->pendingPos);
+}
+
+void DDEPointerInterfacePrivate::removeMotionFilter(wl_client *client)
+{
+    MotionFilter *filter = motionFilters.take(client);
+    if (filter) {
+        QObject::disconnect(filter->disconnectedConnection);
+        delete filter->timer;
+        delete filter;
+    }
+}
+
+void DDEPointerInterfacePrivate::dde_pointer_destroy_resource(Resource *resource)
+{
+    QList<Resource *> resources = resourcesForClient(resource->client());
+    resources.removeOne(resource);
+    if (resources.isEmpty()) {
+        removeMotionFilter(resource->client());
+    }
 }
 
 void DDEPointerInterfacePrivate::dde_pointer_get_motion(Resource *resource)
@@ -333,27 +456,52 @@ DDESeatInterface *DDEPointerInterface::ddeSeat() const
 
 void DDEPointerInterface::buttonPressed(quint32 button)
 {
-    const QPointF globalPos = d->ddeSeat->pointerPos();
-    d->send_button(wl_fixed_from_double(globalPos.x()), wl_fixed_from_double(globalPos.y()), button,
-            QtWaylandServer::dde_pointer::button_state::button_state_pressed);
+    d->sendButton(button, QtWaylandServer::dde_pointer::button_state::button_state_pressed);
 }
 
 void DDEPointerInterface::buttonReleased(quint32 button)
 {
-    const QPointF globalPos = d->ddeSeat->pointerPos();
-    d->send_button(wl_fixed_from_double(globalPos.x()), wl_fixed_from_double(globalPos.y()), button,
-            QtWaylandServer::dde_pointer::button_state::button_state_released);
+    d->sendButton(button, QtWaylandServer::dde_pointer::button_state::button_state_released);
 }
 
 void DDEPointerInterface::axis(Qt::Orientation orientation, qint32 delta)
 {
-    d->send_axis(0, (orientation == Qt::Vertical) ? WL_POINTER_AXIS_VERTICAL_SCROLL : WL_POINTER_AXIS_HORIZONTAL_SCROLL,
-            wl_fixed_from_int(delta));
+    d->sendAxis(orientation, delta);
 }
 
 void DDEPointerInterface::sendMotion(const QPointF &position)
 {
-    d->send_motion(wl_fixed_from_double(position.x()), wl_fixed_from_double(position.y()));
+    d->sendMotion(position);
+}
+
+void DDEPointerInterface::setMotionFilter(ClientConnection *client, int maxRate, const QRegion &region)
+{
+    wl_client *nativeClient = client->client();
+
+    DDEPointerInterfacePrivate::MotionFilter *filter = d->motionFilters.value(nativeClient);
+    if (!filter) {
+        filter = new DDEPointerInterfacePrivate::MotionFilter;
+        filter->timer = new QTimer(this);
+        filter->timer->setSingleShot(true);
+        connect(filter->timer, &QTimer::timeout, this, [this, nativeClient]() {
+            d->flushMotion(nativeClient);
+        });
+        // filters of clients without a dde_pointer are not removed along with the resources
+        filter->disconnectedConnection = connect(client, &ClientConnection::disconnected, this, [this, nativeClient]() {
+            d->removeMotionFilter(nativeClient);
+        });
+        d->motionFilters.insert(nativeClient, filter);
+    }
+
+    filter->interval = maxRate > 0 ? qMax(1, 1000 / maxRate) : 0;
+    filter->region = region;
+    filter->wasInsideRegion = region.isEmpty() || region.contains(d->ddeSeat->pointerPos().toPoint());
+}
+
+void DDEPointerInterface::resetMotionFilter(ClientConnection *client)
+{
+    d->flushMotion(client->client());
+    d->removeMotionFilter(client->client());
 }
 
 /*********************************
@@ -7,6 +7,7 @@
 
 #include <QObject>
 #include <QPointF>
+#include <QRegion>
 
 #include <DWayland/Server/kwaylandserver_export.h>
 
@@ -14,6 +15,7 @@ struct wl_resource;
 
 namespace KWaylandServer
 {
+class ClientConnection;
 class Display;
 class DDEPointerInterface;
 class DDEKeyboardInterface;
@@ -110,6 +112,29 @@ public:
      **/
     static DDEPointerInterface *get(wl_resource *native);
 
+    /**
+     * Limits the motion events sent to the dde_pointer objects of @p client.
+     *
+     * If @p maxRate is greater than zero, at most @p maxRate motion events per second are
+     * sent. Motion in between is coalesced and the latest position is delivered once the
+     * interval elapsed.
+     *
+     * If @p region is not empty, only motion inside the @p region in global coordinates is
+     * sent, plus the first motion leaving it. This is useful for clients only interested in
+     * e.g. the screen edges.
+     *
+     * Clients without a motion filter receive every motion event. The filter is removed when
+     * @p client disconnects.
+     * @see resetMotionFilter
+     **/
+    void setMotionFilter(ClientConnection *client, int maxRate, const QRegion &region = QRegion());
+
+    /**
+     * Removes the motion filter of @p client, it receives every motion event again.
+     * @see setMotionFilter
+     **/
+    void resetMotionFilter(ClientConnection *client);
+
 private:
     friend class DDESeatInterface;
     friend class DDESeatInterfacePrivate;
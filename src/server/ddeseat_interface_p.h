@@ -9,10 +9,13 @@
 // KWayland
 #include "ddeseat_interface.h"
 // Qt
+#include <QElapsedTimer>
 #include <QHash>
 #include <QMap>
 #include <QPointer>
 #include <QPointF>
+#include <QRegion>
+#include <QTimer>
 
 #include "qwayland-server-dde-seat.h"
 
@@ -84,7 +87,31 @@ public:
     DDEPointerInterface *q;
     DDESeatInterface *ddeSeat;
 
+    struct MotionFilter {
+        int interval = 0;
+        QRegion region;
+        QElapsedTimer lastMotion;
+        QPointF pendingPos;
+        bool hasPendingMotion = false;
+        bool wasInsideRegion = false;
+        QTimer *timer = nullptr;
+        // removes the filter once the client is gone, another client may get the same wl_client address
+        QMetaObject::Connection disconnectedConnection;
+    };
+    QHash<wl_client *, MotionFilter *> motionFilters;
+
+    // motion, button and axis events are sent to all dde_pointer resources of all clients
+    QList<wl_client *> clients() const;
+    QList<Resource *> resourcesForClient(wl_client *client) const;
+    void sendMotion(const QPointF &position);
+    void sendButton(quint32 button, button_state state);
+    void sendAxis(Qt::Orientation orientation, qint32 delta);
+    void sendMotion(wl_client *client, const QPointF &position);
+    void flushMotion(wl_client *client);
+    void removeMotionFilter(wl_client *client);
+
 protected:
+    void dde_pointer_destroy_resource(Resource *resource) override;
     void dde_pointer_get_motion(Resource *resource) override;
 };
 
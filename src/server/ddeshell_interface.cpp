@@ -7,6 +7,7 @@
 #include "display.h"
 #include "logging.h"
 #include "surface_interface.h"
+#include "surface_interface_p.h"
 #include "utils.h"
 
 #include "qwayland-server-dde-shell.h"
@@ -18,7 +19,6 @@
 namespace KWaylandServer
 {
 static const quint32 s_version = 1;
-static QList<DDEShellSurfaceInterface *> s_shellSurfaces;
 
 class DDEShellInterfacePrivate : public QtWaylandServer::dde_shell
 {
@@ -85,11 +85,7 @@ void DDEShellInterfacePrivate::dde_shell_get_shell_surface(Resource *resource, u
     wl_resource *shell_resource = wl_resource_create(resource->client(), &dde_shell_surface_interface, resource->version(), id);
 
     auto shellSurface = new DDEShellSurfaceInterface(s, shell_resource);
-    s_shellSurfaces.append(shellSurface);
-
-    QObject::connect(shellSurface, &QObject::destroyed, [shellSurface]() {
-        s_shellSurfaces.removeOne(shellSurface);
-    });
+    SurfaceInterfacePrivate::get(s)->setExtension(shellSurface);
 
     Q_EMIT q->shellSurfaceCreated(shellSurface);
 }
@@ -120,12 +116,10 @@ DDEShellSurfaceInterface *DDEShellSurfaceInterface::get(wl_resource *native)
 
 DDEShellSurfaceInterface *DDEShellSurfaceInterface::get(SurfaceInterface *surface)
 {
-    for (DDEShellSurfaceInterface *shellSurface : qAsConst(s_shellSurfaces)) {
-        if (shellSurface->surface() == surface) {
-            return shellSurface;
-        }
+    if (!surface) {
+        return nullptr;
     }
-    return nullptr;
+    return SurfaceInterfacePrivate::get(surface)->extension<DDEShellSurfaceInterface>();
 }
 
 void DDEShellSurfaceInterfacePrivate::setState(dde_shell_state flag, bool set)
@@ -6,17 +6,24 @@
 */
 #include "display.h"
 #include "clientbufferintegration.h"
+#include "clientconnection_p.h"
 #include "display_p.h"
 #include "drmclientbuffer.h"
 #include "logging.h"
 #include "output_interface.h"
+#include "releasablecache_p.h"
 #include "shmclientbuffer.h"
 
 #include <QAbstractEventDispatcher>
 #include <QCoreApplication>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QRect>
 
+#include <algorithm>
+
+#include <poll.h>
+
 namespace KWaylandServer
 {
 DisplayPrivate *DisplayPrivate::get(Display *display)
@@ -27,6 +34,132 @@ DisplayPrivate *DisplayPrivate::get(Display *display)
 DisplayPrivate::DisplayPrivate(Display *q)
     : q(q)
 {
+    clientCreatedListener.notify = clientCreatedCallback;
+    clientCreatedListener.display = this;
+    wl_list_init(&clientCreatedListener.link);
+
+    QObject::connect(&statisticsTimer, &QTimer::timeout, q, [this]() {
+        QHash<ClientConnection *, ClientStatistics> statistics;
+        statistics.reserve(clients.count());
+        for (ClientConnection *connection : qAsConst(clients)) {
+            statistics.insert(connection, connection->statistics());
+        }
+        Q_EMIT this->q->clientStatisticsSnapshot(statistics);
+    });
+}
+
+void DisplayPrivate::protocolLoggerCallback(void *data, wl_protocol_logger_type type, const wl_protocol_logger_message *message)
+{
+    Q_UNUSED(data)
+    // messages of clients without a connection yet or of clients being destroyed are not counted
+    if (ClientConnectionPrivate *connection = ClientConnectionPrivate::get(wl_resource_get_client(message->resource))) {
+        connection->recordMessage(type, message);
+    }
+}
+
+void DisplayPrivate::clientCreatedCallback(wl_listener *listener, void *data)
+{
+    // create the connection right away, so that the first requests of the client are counted
+    DisplayPrivate *display = static_cast<ClientCreatedListener *>(listener)->display;
+    display->q->getConnection(static_cast<wl_client *>(data));
+}
+
+void DisplayPrivate::dispatchLoggerCallback(void *data, wl_protocol_logger_type type, const wl_protocol_logger_message *message)
+{
+    if (type != WL_PROTOCOL_LOGGER_REQUEST) {
+        return;
+    }
+    auto display = static_cast<DisplayPrivate *>(data);
+    ++display->dispatchedRequests;
+    const int clientRequests = ++display->dispatchedClientRequests[wl_resource_get_client(message->resource)];
+    if (display->dispatchClientShare == 0 || clientRequests <= display->dispatchClientShare) {
+        display->dispatchedWithinShare = true;
+    }
+}
+
+bool DisplayPrivate::isDispatchBudgeted() const
+{
+    return dispatchLogger;
+}
+
+void DisplayPrivate::dispatchBudgeted()
+{
+    QElapsedTimer timer;
+    timer.start();
+    const std::chrono::nanoseconds timeBudget = dispatchTimeBudget;
+    const quint64 firstRequest = dispatchedRequests;
+
+    // Every round reads each readable client once. A client that used up its share of the
+    // request budget cannot be skipped, its socket is watched by libwayland, so once only such
+    // clients are left the rest of the budget is not spent on them and the iteration ends.
+    int clientCount = 0;
+    wl_client *client;
+    wl_client_for_each(client, wl_display_get_client_list(display)) {
+        ++clientCount;
+    }
+    dispatchClientShare = dispatchRequestBudget > 0 ? qMax(1, dispatchRequestBudget / qMax(1, clientCount)) : 0;
+    dispatchedClientRequests.clear();
+
+    bool exhausted = false;
+    while (!exhausted) {
+        const quint64 roundStart = dispatchedRequests;
+        dispatchedWithinShare = false;
+        if (wl_event_loop_dispatch(loop, 0) != 0) {
+            qCWarning(KWAYLAND_SERVER) << "Error on dispatching Wayland event loop";
+            break;
+        }
+        ++dispatchStatistics.rounds;
+        if (dispatchedRequests == roundStart) {
+            // all clients are drained
+            break;
+        }
+        if (!dispatchedWithinShare) {
+            // only clients over their share sent requests in this round
+            exhausted = true;
+        }
+        if (dispatchRequestBudget > 0 && dispatchedRequests - firstRequest >= quint64(dispatchRequestBudget)) {
+            exhausted = true;
+        }
+        if (timeBudget > std::chrono::nanoseconds::zero() && timer.nsecsElapsed() >= timeBudget.count()) {
+            exhausted = true;
+        }
+    }
+    dispatchStatistics.requests += dispatchedRequests - firstRequest;
+    // the clients may be destroyed before the next iteration
+    dispatchedClientRequests.clear();
+
+    if (exhausted) {
+        // the socket notifier fires again for the remaining requests once the event loop
+        // has processed everything else that is pending
+        if (const int deferred = countReadableClients()) {
+            ++dispatchStatistics.deferredIterations;
+            dispatchStatistics.deferredClients += deferred;
+        }
+    }
+}
+
+int DisplayPrivate::countReadableClients() const
+{
+    QVector<pollfd> fds;
+    wl_client *client;
+    wl_client_for_each(client, wl_display_get_client_list(display)) {
+        fds.append(pollfd{wl_client_get_fd(client), POLLIN, 0});
+    }
+    if (fds.isEmpty() || poll(fds.data(), fds.count(), 0) <= 0) {
+        return 0;
+    }
+    return std::count_if(fds.constBegin(), fds.constEnd(), [](const pollfd &fd) {
+        return fd.revents & POLLIN;
+    });
+}
+
+void DisplayPrivate::updateStatisticsTimer()
+{
+    if (protocolLogger && statisticsTimer.interval() > 0) {
+        statisticsTimer.start();
+    } else {
+        statisticsTimer.stop();
+    }
 }
 
 void DisplayPrivate::registerSocketName(const QString &socketName)
@@ -45,6 +178,8 @@ Display::Display(QObject *parent)
 
 Display::~Display()
 {
+    setClientStatisticsEnabled(false);
+    setDispatchBudget(0, std::chrono::microseconds::zero());
     wl_display_destroy_clients(d->display);
     wl_display_destroy(d->display);
 }
@@ -111,14 +246,67 @@ bool Display::start()
 
 void Display::dispatchEvents()
 {
-    if (wl_event_loop_dispatch(d->loop, 0) != 0) {
-        qCWarning(KWAYLAND_SERVER) << "Error on dispatching Wayland event loop";
+    QElapsedTimer timer;
+    timer.start();
+    ++d->dispatchStatistics.iterations;
+    if (d->isDispatchBudgeted()) {
+        d->dispatchBudgeted();
+    } else {
+        if (wl_event_loop_dispatch(d->loop, 0) != 0) {
+            qCWarning(KWAYLAND_SERVER) << "Error on dispatching Wayland event loop";
+        }
+        ++d->dispatchStatistics.rounds;
+    }
+    d->dispatchStatistics.longestIteration = std::max(d->dispatchStatistics.longestIteration, std::chrono::nanoseconds(timer.nsecsElapsed()));
+}
+
+void Display::setDispatchBudget(int maxRequests, std::chrono::microseconds maxTime)
+{
+    d->dispatchRequestBudget = qMax(maxRequests, 0);
+    d->dispatchTimeBudget = std::max(maxTime, std::chrono::microseconds::zero());
+
+    const bool budgeted = d->dispatchRequestBudget > 0 || d->dispatchTimeBudget > std::chrono::microseconds::zero();
+    if (budgeted && !d->dispatchLogger) {
+        d->dispatchLogger = wl_display_add_protocol_logger(d->display, DisplayPrivate::dispatchLoggerCallback, d.data());
+    } else if (!budgeted && d->dispatchLogger) {
+        wl_protocol_logger_destroy(d->dispatchLogger);
+        d->dispatchLogger = nullptr;
     }
 }
 
+int Display::dispatchRequestBudget() const
+{
+    return d->dispatchRequestBudget;
+}
+
+std::chrono::microseconds Display::dispatchTimeBudget() const
+{
+    return d->dispatchTimeBudget;
+}
+
+DispatchStatistics Display::dispatchStatistics() const
+{
+    return d->dispatchStatistics;
+}
+
+void Display::resetDispatchStatistics()
+{
+    d->dispatchStatistics = DispatchStatistics();
+}
+
 void Display::flush()
 {
-    wl_display_flush_clients(d->display);
+    d->flush();
+}
+
+void DisplayPrivate::flush()
+{
+    wl_display_flush_clients(display);
+    if (protocolLogger) {
+        for (ClientConnection *connection : qAsConst(clients)) {
+            ClientConnectionPrivate::get(connection)->pendingEventBytes = 0;
+        }
+    }
 }
 
 void Display::createShm()
@@ -233,6 +421,55 @@ void *Display::eglDisplay() const
     return d->eglDisplay;
 }
 
+void Display::setClientStatisticsEnabled(bool enabled)
+{
+    if (isClientStatisticsEnabled() == enabled) {
+        return;
+    }
+    if (enabled) {
+        d->protocolLogger = wl_display_add_protocol_logger(d->display, DisplayPrivate::protocolLoggerCallback, d.data());
+        wl_display_add_client_created_listener(d->display, &d->clientCreatedListener);
+
+        wl_list *clients = wl_display_get_client_list(d->display);
+        wl_client *client;
+        wl_client_for_each(client, clients) {
+            getConnection(client);
+        }
+    } else {
+        wl_protocol_logger_destroy(d->protocolLogger);
+        d->protocolLogger = nullptr;
+        wl_list_remove(&d->clientCreatedListener.link);
+        wl_list_init(&d->clientCreatedListener.link);
+    }
+    d->updateStatisticsTimer();
+}
+
+bool Display::isClientStatisticsEnabled() const
+{
+    return d->protocolLogger;
+}
+
+void Display::setClientStatisticsInterval(int msec)
+{
+    d->statisticsTimer.setInterval(qMax(msec, 0));
+    d->updateStatisticsTimer();
+}
+
+int Display::clientStatisticsInterval() const
+{
+    return d->statisticsTimer.interval();
+}
+
+qint64 Display::releaseCaches(MemoryPressure pressure)
+{
+    qint64 reclaimed = 0;
+    for (ReleasableCache *cache : qAsConst(d->caches)) {
+        reclaimed += cache->releaseCache(pressure);
+    }
+    qCDebug(KWAYLAND_SERVER) << "Released" << reclaimed << "bytes from the caches under" << pressure << "memory pressure";
+    return reclaimed;
+}
+
 struct ClientBufferDestroyListener : wl_listener {
     ClientBufferDestroyListener(Display *display, ClientBuffer *buffer);
     ~ClientBufferDestroyListener();
@@ -9,6 +9,8 @@
 #include <QList>
 #include <QObject>
 
+#include <chrono>
+
 #include <DWayland/Server/kwaylandserver_export.h>
 
 #include "clientconnection.h"
@@ -39,6 +41,41 @@ class OutputInterface;
 class OutputDeviceV2Interface;
 class SeatInterface;
 
+/**
+ * Statistics about the work done by Display::dispatchEvents().
+ *
+ * @see Display::dispatchStatistics
+ */
+struct DispatchStatistics {
+    /**
+     * The number of calls to Display::dispatchEvents().
+     */
+    quint64 iterations = 0;
+    /**
+     * The number of times the event loop was dispatched. Every round reads and processes
+     * the pending requests of each readable client once.
+     */
+    quint64 rounds = 0;
+    /**
+     * The number of requests processed, only counted while a dispatch budget is set.
+     */
+    quint64 requests = 0;
+    /**
+     * The number of iterations that exhausted the dispatch budget while clients still had
+     * requests waiting.
+     */
+    quint64 deferredIterations = 0;
+    /**
+     * The number of clients whose requests were deferred to the next iteration, summed over
+     * all deferred iterations.
+     */
+    quint64 deferredClients = 0;
+    /**
+     * The duration of the longest iteration.
+     */
+    std::chrono::nanoseconds longestIteration = std::chrono::nanoseconds::zero();
+};
+
 /**
  * @brief Class holding the Wayland server display loop.
  *
@@ -49,6 +86,23 @@ class KWAYLANDSERVER_EXPORT Display : public QObject
     Q_OBJECT
     Q_PROPERTY(bool running READ isRunning NOTIFY runningChanged)
 public:
+    /**
+     * How much the caches may give up in releaseCaches().
+     */
+    enum class MemoryPressure {
+        /**
+         * Compact the caches without losing any data, e.g. by compressing it or by dropping
+         * what can be loaded again.
+         */
+        Moderate,
+        /**
+         * Additionally drop data that is only kept for the compositor's convenience, such as
+         * the contents of shm buffers the client has already destroyed.
+         */
+        Critical,
+    };
+    Q_ENUM(MemoryPressure)
+
     explicit Display(QObject *parent = nullptr);
     virtual ~Display();
 
@@ -88,8 +142,45 @@ public:
      * function returns @c true; otherwise @c false is returned.
      */
     bool start();
+    /**
+     * Dispatches the requests of the clients.
+     *
+     * By default every readable client is dispatched once, which processes at most one
+     * connection buffer of requests per client. Setting a dispatch budget opts into a throughput
+     * mode: the clients are dispatched in further rounds until no more requests arrive or the
+     * budget is used up, so a client sending a burst larger than one buffer is served in one
+     * iteration. The first round is always complete, the budget only limits the extra rounds.
+     * Every client gets an equal share of the request budget, and the extra rounds stop once
+     * only clients that used up their share are still sending. A round reads every readable
+     * client though, so a flooding client keeps being served beyond its share as long as other
+     * clients are sending. The requests left over are processed the next time the event loop
+     * notices the sockets are readable.
+     *
+     * @see setDispatchBudget
+     */
     void dispatchEvents();
 
+    /**
+     * Lets a single dispatchEvents() call dispatch further rounds until @p maxRequests requests
+     * have been processed or @p maxTime has passed. The budget is checked between dispatch
+     * rounds, so the round that crosses it is completed, but no further round is started. The
+     * budget never limits the work below the single round done without a budget, it only
+     * bounds the extra rounds.
+     * A value of @c 0 disables the corresponding limit; if both are @c 0, which is the default,
+     * dispatchEvents() dispatches every readable client once.
+     *
+     * @see dispatchStatistics
+     */
+    void setDispatchBudget(int maxRequests, std::chrono::microseconds maxTime);
+    int dispatchRequestBudget() const;
+    std::chrono::microseconds dispatchTimeBudget() const;
+    /**
+     * Returns statistics about the work done by dispatchEvents() since the display has been
+     * created or resetDispatchStatistics() was called.
+     */
+    DispatchStatistics dispatchStatistics() const;
+    void resetDispatchStatistics();
+
     /**
      * Create a client for the given file descriptor.
      *
@@ -146,6 +237,35 @@ public:
      */
     ClientBuffer *clientBufferForResource(wl_resource *resource) const;
 
+    /**
+     * Sets whether the display collects statistics about the protocol traffic of its clients.
+     *
+     * While enabled, every request and event passing through the display is counted for the
+     * ClientConnection of the client. Collecting costs a few counter updates per message,
+     * so it is disabled by default. Disabling keeps the counters of the clients.
+     *
+     * @see ClientConnection::statistics
+     */
+    void setClientStatisticsEnabled(bool enabled);
+    bool isClientStatisticsEnabled() const;
+    /**
+     * Sets the interval in milliseconds at which clientStatisticsSnapshot is emitted while
+     * client statistics are enabled. An interval of @c 0, the default, disables the snapshots.
+     */
+    void setClientStatisticsInterval(int msec);
+    int clientStatisticsInterval() const;
+
+    /**
+     * Frees or compacts the memory retained by the caches of the server, as far as the
+     * @p pressure allows, and returns the number of bytes reclaimed. The number is an
+     * estimate, memory shared with the compositor is only freed once the compositor lets
+     * go of it as well.
+     *
+     * The compositor can call this when it gets notified about memory pressure, e.g. from
+     * a pressure stall information trigger or a memory cgroup event.
+     */
+    qint64 releaseCaches(MemoryPressure pressure);
+
 private Q_SLOTS:
     void flush();
 
@@ -154,6 +274,12 @@ Q_SIGNALS:
     void runningChanged(bool);
     void clientConnected(KWaylandServer::ClientConnection *);
     void clientDisconnected(KWaylandServer::ClientConnection *);
+    /**
+     * Emitted periodically with the statistics of all connected clients.
+     *
+     * @see setClientStatisticsInterval
+     */
+    void clientStatisticsSnapshot(const QHash<KWaylandServer::ClientConnection *, KWaylandServer::ClientStatistics> &statistics);
 
 private:
     friend class DisplayPrivate;
@@ -13,10 +13,13 @@
 #include <QList>
 #include <QSocketNotifier>
 #include <QString>
+#include <QTimer>
 #include <QVector>
 
 #include <EGL/egl.h>
 
+#include "display.h"
+
 struct wl_resource;
 
 namespace KWaylandServer
@@ -27,6 +30,7 @@ class ClientConnection;
 class Display;
 class OutputInterface;
 class OutputDeviceV2Interface;
+class ReleasableCache;
 class SeatInterface;
 struct ClientBufferDestroyListener;
 
@@ -41,6 +45,16 @@ public:
     void registerClientBuffer(ClientBuffer *clientBuffer);
     void unregisterClientBuffer(ClientBuffer *clientBuffer);
 
+    // flushes the events of all clients, Display::flush() is a private slot
+    void flush();
+    void updateStatisticsTimer();
+    bool isDispatchBudgeted() const;
+    void dispatchBudgeted();
+    int countReadableClients() const;
+    static void dispatchLoggerCallback(void *data, wl_protocol_logger_type type, const wl_protocol_logger_message *message);
+    static void protocolLoggerCallback(void *data, wl_protocol_logger_type type, const wl_protocol_logger_message *message);
+    static void clientCreatedCallback(wl_listener *listener, void *data);
+
     Display *q;
     QSocketNotifier *socketNotifier = nullptr;
     wl_display *display = nullptr;
@@ -55,6 +69,25 @@ public:
     QHash<::wl_resource *, ClientBuffer *> resourceToBuffer;
     QHash<ClientBuffer *, ClientBufferDestroyListener *> bufferToListener;
     QList<ClientBufferIntegration *> bufferIntegrations;
+    QList<ReleasableCache *> caches;
+
+    wl_protocol_logger *protocolLogger = nullptr;
+    struct ClientCreatedListener : wl_listener {
+        DisplayPrivate *display;
+    } clientCreatedListener;
+    QTimer statisticsTimer;
+
+    wl_protocol_logger *dispatchLogger = nullptr;
+    int dispatchRequestBudget = 0;
+    std::chrono::microseconds dispatchTimeBudget = std::chrono::microseconds::zero();
+    // counted by the dispatch logger while a budget is set
+    quint64 dispatchedRequests = 0;
+    // the requests of every client in the current iteration, and the share of the request
+    // budget each client gets before it only delays the iteration for everybody else
+    QHash<wl_client *, int> dispatchedClientRequests;
+    int dispatchClientShare = 0;
+    bool dispatchedWithinShare = false;
+    DispatchStatistics dispatchStatistics;
 };
 
 } // namespace KWaylandServer
@@ -186,8 +186,20 @@ public:
         wl_resource_destroy(resource->handle);
     }
 
+    void zwp_input_method_context_v1_bind_resource(Resource *resource) override
+    {
+        Q_UNUSED(resource)
+        // the new resource hasn't seen any surrounding text yet
+        surroundingTextSent = false;
+    }
+
     InputMethodContextV1Interface *const q;
     QScopedPointer<InputMethodGrabV1> m_keyboardGrab;
+
+    QByteArray surroundingText;
+    quint32 surroundingTextCursor = 0;
+    quint32 surroundingTextAnchor = 0;
+    bool surroundingTextSent = false;
 };
 
 InputMethodContextV1Interface::InputMethodContextV1Interface(InputMethodV1Interface *parent)
@@ -307,6 +319,7 @@ void InputMethodContextV1Interface::sendPreferredLanguage(const QString &languag
 
 void InputMethodContextV1Interface::sendReset()
 {
+    d->surroundingTextSent = false;
     for (auto r : d->resourceMap()) {
         d->send_reset(r->handle);
     }
@@ -314,6 +327,19 @@ void InputMethodContextV1Interface::sendReset()
 
 void InputMethodContextV1Interface::sendSurroundingText(const QString &text, uint32_t cursor, uint32_t anchor)
 {
+    sendSurroundingTextUtf8(text.toUtf8(), cursor, anchor);
+}
+
+void InputMethodContextV1Interface::sendSurroundingTextUtf8(const QByteArray &text, quint32 cursor, quint32 anchor)
+{
+    if (d->surroundingTextSent && d->surroundingTextCursor == cursor && d->surroundingTextAnchor == anchor && d->surroundingText == text) {
+        return;
+    }
+    d->surroundingText = text;
+    d->surroundingTextCursor = cursor;
+    d->surroundingTextAnchor = anchor;
+    d->surroundingTextSent = true;
+
     for (auto r : d->resourceMap()) {
         d->send_surrounding_text(r->handle, text, cursor, anchor);
     }
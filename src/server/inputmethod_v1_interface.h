@@ -71,7 +71,22 @@ class KWAYLANDSERVER_EXPORT InputMethodContextV1Interface : public QObject
 public:
     ~InputMethodContextV1Interface() override;
 
+    /**
+     * Sends the surrounding text to the input method.
+     *
+     * The event is not sent if the text, the cursor and the anchor are the same as the ones
+     * sent last time.
+     */
     void sendSurroundingText(const QString &text, quint32 cursor, quint32 anchor);
+    /**
+     * Sends the UTF-8 encoded surrounding @p text to the input method. The @p cursor and the
+     * @p anchor are byte offsets within @p text.
+     *
+     * This avoids encoding the text again if it's already available as UTF-8, e.g. from
+     * TextInputV3Interface::surroundingTextUtf8.
+     * @see sendSurroundingText
+     */
+    void sendSurroundingTextUtf8(const QByteArray &text, quint32 cursor, quint32 anchor);
     void sendReset();
     void sendContentType(KWaylandServer::TextInputContentHints hint, KWaylandServer::TextInputContentPurpose purpose);
     void sendInvokeAction(quint32 button, quint32 index);
@@ -18,7 +18,8 @@
 namespace KWaylandServer
 {
 KeyboardInterfacePrivate::KeyboardInterfacePrivate(SeatInterface *s)
-    : seat(s)
+    : ReleasableCache(s->display())
+    , seat(s)
 {
 }
 
@@ -34,7 +35,7 @@ void KeyboardInterfacePrivate::keyboard_bind_resource(Resource *resource)
     if (resource->version() >= WL_KEYBOARD_REPEAT_INFO_SINCE_VERSION) {
         send_repeat_info(resource->handle, keyRepeat.charactersPerSecond, keyRepeat.delay);
     }
-    if (!keymap.isNull()) {
+    if (hasKeymap()) {
         sendKeymap(resource);
     }
 
@@ -72,8 +73,33 @@ void KeyboardInterfacePrivate::sendEnter(SurfaceInterface *surface, quint32 seri
     }
 }
 
+bool KeyboardInterfacePrivate::hasKeymap() const
+{
+    return !keymap.isNull() || !compressedKeymap.isNull();
+}
+
+qint64 KeyboardInterfacePrivate::releaseCache(Display::MemoryPressure pressure)
+{
+    Q_UNUSED(pressure)
+    // the keymap is only needed when a keyboard gets bound, which is rare enough to
+    // uncompress it every time
+    if (keymap.isNull()) {
+        return 0;
+    }
+    const QByteArray compressed = qCompress(keymap);
+    if (compressed.size() >= keymap.size()) {
+        return 0;
+    }
+    const qint64 reclaimed = keymap.size() - compressed.size();
+    compressedKeymap = compressed;
+    keymap = QByteArray();
+    return reclaimed;
+}
+
 void KeyboardInterfacePrivate::sendKeymap(Resource *resource)
 {
+    const QByteArray content = keymap.isNull() ? qUncompress(compressedKeymap) : keymap;
+
     QScopedPointer<QTemporaryFile> tmp(new QTemporaryFile());
     if (!tmp->open()) {
         qCWarning(KWAYLAND_SERVER) << "Failed to create keymap file:" << tmp->errorString();
@@ -81,18 +107,18 @@ void KeyboardInterfacePrivate::sendKeymap(Resource *resource)
     }
 
     unlink(tmp->fileName().toUtf8().constData());
-    if (!tmp->resize(keymap.size())) {
+    if (!tmp->resize(content.size())) {
         qCWarning(KWAYLAND_SERVER) << "Failed to resize keymap file:" << tmp->errorString();
         return;
     }
 
-    uchar *address = tmp->map(0, keymap.size());
+    uchar *address = tmp->map(0, content.size());
     if (!address) {
         qCWarning(KWAYLAND_SERVER) << "Failed to map keymap file:" << tmp->errorString();
         return;
     }
 
-    qstrncpy(reinterpret_cast<char *>(address), keymap.constData(), keymap.size() + 1);
+    qstrncpy(reinterpret_cast<char *>(address), content.constData(), content.size() + 1);
     tmp->unmap(address);
 
     send_keymap(resource->handle, keymap_format::keymap_format_xkb_v1, tmp->handle(), tmp->size());
@@ -105,6 +131,7 @@ void KeyboardInterface::setKeymap(const QByteArray &content)
     }
 
     d->keymap = content;
+    d->compressedKeymap = QByteArray();
 
     const auto keyboardResources = d->resourceMap();
     for (KeyboardInterfacePrivate::Resource *resource : keyboardResources) {
@@ -6,6 +6,7 @@
 #pragma once
 
 #include "keyboard_interface.h"
+#include "releasablecache_p.h"
 
 #include <qwayland-server-wayland.h>
 
@@ -16,11 +17,12 @@ namespace KWaylandServer
 {
 class ClientConnection;
 
-class KeyboardInterfacePrivate : public QtWaylandServer::wl_keyboard
+class KeyboardInterfacePrivate : public QtWaylandServer::wl_keyboard, public ReleasableCache
 {
 public:
     KeyboardInterfacePrivate(SeatInterface *s);
 
+    bool hasKeymap() const;
     void sendKeymap(Resource *resource);
     void sendModifiers();
     void sendModifiers(quint32 depressed, quint32 latched, quint32 locked, quint32 group, quint32 serial);
@@ -38,6 +40,8 @@ public:
     SurfaceInterface *focusedSurface = nullptr;
     QMetaObject::Connection destroyConnection;
     QByteArray keymap;
+    // holds the keymap instead of keymap after the cache got released
+    QByteArray compressedKeymap;
 
     struct {
         qint32 charactersPerSecond = 0;
@@ -57,6 +61,8 @@ public:
     bool updateKey(quint32 key, KeyboardKeyState state);
     QVector<quint32> pressedKeys() const;
 
+    qint64 releaseCache(Display::MemoryPressure pressure) override;
+
 protected:
     void keyboard_release(Resource *resource) override;
     void keyboard_bind_resource(Resource *resource) override;
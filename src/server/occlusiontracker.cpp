@@ -0,0 +1,242 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#include "occlusiontracker.h"
+#include "regionbuilder.h"
+#include "subcompositor_interface.h"
+#include "surface_interface.h"
+
+#include <QHash>
+#include <QPointer>
+
+#include <algorithm>
+
+namespace KWaylandServer
+{
+struct OcclusionEntry {
+    // the surface pointer identifies the entry even while the surface is being destroyed
+    SurfaceInterface *key = nullptr;
+    QPointer<SurfaceInterface> surface;
+    QPoint position;
+    // the area covered by the surface tree and the opaque part of it
+    QRegion footprint;
+    QRegion opaque;
+    // the opaque region of all the surfaces stacked above this one
+    QRegion coveredAbove;
+    QRegion visible;
+    QVector<QMetaObject::Connection> connections;
+    bool valid = false;
+};
+
+class OcclusionTrackerPrivate
+{
+public:
+    void invalidate(SurfaceInterface *surface);
+    void update();
+    void updateEntry(OcclusionEntry &entry);
+    void watch(OcclusionEntry &entry, SurfaceInterface *surface);
+    void watchTree(OcclusionEntry &entry, SurfaceInterface *surface);
+    void unwatch(OcclusionEntry &entry);
+    void updateIndexes();
+    const OcclusionEntry *entryFor(SurfaceInterface *surface) const;
+
+    QVector<OcclusionEntry> entries;
+    // the index of the topmost entry of every root surface
+    QHash<SurfaceInterface *, int> indexes;
+    // the topmost entry whose visible region is outdated, all entries below it need to be updated
+    int dirtyIndex = -1;
+};
+
+void OcclusionTrackerPrivate::invalidate(SurfaceInterface *surface)
+{
+    const auto it = indexes.constFind(surface);
+    if (it == indexes.constEnd()) {
+        return;
+    }
+    entries[*it].valid = false;
+    dirtyIndex = std::max(dirtyIndex, *it);
+}
+
+void OcclusionTrackerPrivate::watch(OcclusionEntry &entry, SurfaceInterface *surface)
+{
+    SurfaceInterface *root = entry.key;
+    auto invalidateRoot = [this, root]() {
+        invalidate(root);
+    };
+    entry.connections << QObject::connect(surface, &SurfaceInterface::committed, invalidateRoot);
+    entry.connections << QObject::connect(surface, &SurfaceInterface::childSubSurfacesChanged, invalidateRoot);
+    entry.connections << QObject::connect(surface, &SurfaceInterface::mapped, invalidateRoot);
+    entry.connections << QObject::connect(surface, &SurfaceInterface::unmapped, invalidateRoot);
+    entry.connections << QObject::connect(surface, &QObject::destroyed, invalidateRoot);
+}
+
+void OcclusionTrackerPrivate::watchTree(OcclusionEntry &entry, SurfaceInterface *surface)
+{
+    // unmapped sub-surfaces are not in the paint list, but they may get mapped or get children
+    watch(entry, surface);
+    const QList<SubSurfaceInterface *> below = surface->below();
+    for (SubSurfaceInterface *subsurface : below) {
+        watchTree(entry, subsurface->surface());
+    }
+    const QList<SubSurfaceInterface *> above = surface->above();
+    for (SubSurfaceInterface *subsurface : above) {
+        watchTree(entry, subsurface->surface());
+    }
+}
+
+void OcclusionTrackerPrivate::unwatch(OcclusionEntry &entry)
+{
+    for (const QMetaObject::Connection &connection : qAsConst(entry.connections)) {
+        QObject::disconnect(connection);
+    }
+    entry.connections.clear();
+}
+
+void OcclusionTrackerPrivate::updateEntry(OcclusionEntry &entry)
+{
+    unwatch(entry);
+    entry.valid = true;
+    entry.footprint = QRegion();
+    entry.opaque = QRegion();
+    if (!entry.surface) {
+        return;
+    }
+
+    watchTree(entry, entry.surface);
+
+    RegionBuilder footprint;
+    RegionBuilder opaque;
+    const QVector<SurfacePaintNode> &paintList = entry.surface->paintList();
+    for (const SurfacePaintNode &node : paintList) {
+        const QRect surfaceRect(QPoint(0, 0), node.surface->size());
+        const QPoint offset = entry.position + node.offset;
+        footprint.add(surfaceRect.translated(offset));
+        opaque.add(node.opaque.intersected(surfaceRect).translated(offset));
+    }
+    entry.footprint = footprint.region();
+    entry.opaque = opaque.region();
+}
+
+void OcclusionTrackerPrivate::update()
+{
+    for (int i = dirtyIndex; i >= 0; --i) {
+        OcclusionEntry &entry = entries[i];
+        if (!entry.valid) {
+            updateEntry(entry);
+        }
+        if (i + 1 < entries.count()) {
+            const OcclusionEntry &above = entries[i + 1];
+            entry.coveredAbove = above.coveredAbove.united(above.opaque);
+        } else {
+            entry.coveredAbove = QRegion();
+        }
+        entry.visible = entry.footprint.subtracted(entry.coveredAbove);
+    }
+    dirtyIndex = -1;
+}
+
+void OcclusionTrackerPrivate::updateIndexes()
+{
+    indexes.clear();
+    indexes.reserve(entries.count());
+    for (int i = 0; i < entries.count(); ++i) {
+        indexes.insert(entries[i].key, i);
+    }
+}
+
+const OcclusionEntry *OcclusionTrackerPrivate::entryFor(SurfaceInterface *surface) const
+{
+    const auto it = indexes.constFind(surface);
+    return it != indexes.constEnd() ? &entries[*it] : nullptr;
+}
+
+OcclusionTracker::OcclusionTracker(QObject *parent)
+    : QObject(parent)
+    , d(new OcclusionTrackerPrivate)
+{
+}
+
+OcclusionTracker::~OcclusionTracker()
+{
+    for (OcclusionEntry &entry : d->entries) {
+        d->unwatch(entry);
+    }
+}
+
+void OcclusionTracker::setStack(const QVector<Placement> &stack)
+{
+    int dirtyIndex = d->dirtyIndex;
+    for (int i = 0; i < stack.count(); ++i) {
+        const bool unchanged = i < d->entries.count() && d->entries[i].key == stack[i].surface && d->entries[i].position == stack[i].position;
+        if (!unchanged) {
+            dirtyIndex = std::max(dirtyIndex, i);
+        }
+    }
+    if (stack.count() < d->entries.count()) {
+        dirtyIndex = std::max(dirtyIndex, stack.count() - 1);
+    }
+
+    QHash<SurfaceInterface *, OcclusionEntry> previous;
+    for (OcclusionEntry &entry : d->entries) {
+        if (entry.surface && !previous.contains(entry.key)) {
+            previous.insert(entry.key, std::move(entry));
+        } else {
+            d->unwatch(entry);
+        }
+    }
+
+    QVector<OcclusionEntry> entries;
+    entries.reserve(stack.count());
+    for (const Placement &placement : stack) {
+        auto it = previous.find(placement.surface);
+        if (it != previous.end()) {
+            // reuse the footprint of surfaces that only moved
+            OcclusionEntry entry = std::move(*it);
+            previous.erase(it);
+            const QPoint delta = placement.position - entry.position;
+            if (!delta.isNull()) {
+                entry.footprint.translate(delta);
+                entry.opaque.translate(delta);
+                entry.position = placement.position;
+            }
+            entries.append(std::move(entry));
+        } else {
+            OcclusionEntry entry;
+            entry.key = placement.surface;
+            entry.surface = placement.surface;
+            entry.position = placement.position;
+            entries.append(std::move(entry));
+        }
+    }
+
+    for (OcclusionEntry &entry : previous) {
+        d->unwatch(entry);
+    }
+    d->entries = std::move(entries);
+    d->updateIndexes();
+    d->dirtyIndex = std::min(dirtyIndex, d->entries.count() - 1);
+}
+
+QVector<OcclusionTracker::Placement> OcclusionTracker::stack() const
+{
+    QVector<Placement> stack;
+    stack.reserve(d->entries.count());
+    for (const OcclusionEntry &entry : qAsConst(d->entries)) {
+        stack.append(Placement{entry.surface, entry.position});
+    }
+    return stack;
+}
+
+QRegion OcclusionTracker::visibleRegion(SurfaceInterface *surface) const
+{
+    d->update();
+    const OcclusionEntry *entry = d->entryFor(surface);
+    return entry ? entry->visible : QRegion();
+}
+
+bool OcclusionTracker::isOccluded(SurfaceInterface *surface) const
+{
+    return visibleRegion(surface).isEmpty();
+}
+
+} // namespace KWaylandServer
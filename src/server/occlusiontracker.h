@@ -0,0 +1,75 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#pragma once
+
+#include <DWayland/Server/kwaylandserver_export.h>
+
+#include <QObject>
+#include <QPoint>
+#include <QRegion>
+#include <QVector>
+
+namespace KWaylandServer
+{
+class OcclusionTrackerPrivate;
+class SurfaceInterface;
+
+/**
+ * The OcclusionTracker computes which parts of a stack of top-level surfaces are visible,
+ * based on the opaque regions of the surfaces and of their sub-surfaces.
+ *
+ * The compositor passes the stacking order together with the position of every top-level
+ * surface to setStack(). visibleRegion() then returns the part of a surface tree that is not
+ * covered by opaque surfaces stacked above it, which allows skipping the painting and the
+ * texture uploads of surfaces that are hidden.
+ *
+ * The tracker follows the commits of all surfaces in the stack and only recomputes the
+ * visible regions affected by a change, i.e. the region of the changed surface and of the
+ * surfaces below it.
+ *
+ * @see SurfaceInterface::opaque
+ * @see SurfaceInterface::paintList
+ */
+class KWAYLANDSERVER_EXPORT OcclusionTracker : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * A top-level surface in the stack together with its position.
+     */
+    struct Placement {
+        SurfaceInterface *surface = nullptr;
+        QPoint position;
+    };
+
+    explicit OcclusionTracker(QObject *parent = nullptr);
+    ~OcclusionTracker() override;
+
+    /**
+     * Sets the stacking order of the top-level surfaces, sorted from bottom to top.
+     */
+    void setStack(const QVector<Placement> &stack);
+    /**
+     * Returns the stacking order that was set with setStack().
+     */
+    QVector<Placement> stack() const;
+
+    /**
+     * Returns the visible region of the surface tree rooted at the top-level @p surface,
+     * in the coordinate space of the positions passed to setStack(). An empty region is
+     * returned if the surface is fully hidden or not part of the stack.
+     */
+    QRegion visibleRegion(SurfaceInterface *surface) const;
+    /**
+     * Returns @c true if no part of the surface tree rooted at the top-level @p surface
+     * is visible.
+     */
+    bool isOccluded(SurfaceInterface *surface) const;
+
+private:
+    QScopedPointer<OcclusionTrackerPrivate> d;
+};
+
+} // namespace KWaylandServer
@@ -7,6 +7,7 @@
 #include "output_interface.h"
 #include "display.h"
 #include "display_p.h"
+#include "surface_interface_p.h"
 #include "utils.h"
 
 #include "qwayland-server-wayland.h"
@@ -403,6 +404,14 @@ void OutputInterface::done(wl_client *client)
     d->sendDone(d->resourceMap().value(client));
 }
 
+void OutputInterface::frameRendered(const QVector<SurfaceInterface *> &surfaces, quint32 msec)
+{
+    SurfaceInterfacePrivate::frameRendered(surfaces, msec);
+    if (d->display) {
+        DisplayPrivate::get(d->display)->flush();
+    }
+}
+
 OutputInterface *OutputInterface::get(wl_resource *native)
 {
     if (auto outputPrivate = resource_cast<OutputInterfacePrivate *>(native)) {
@@ -20,6 +20,7 @@ namespace KWaylandServer
 class ClientConnection;
 class Display;
 class OutputInterfacePrivate;
+class SurfaceInterface;
 
 /**
  * The OutputInterface class represents a screen. This class corresponds to the Wayland
@@ -104,6 +105,17 @@ public:
      */
     void setDpmsMode(DpmsMode mode);
 
+    /**
+     * Notifies the frame callbacks of all @p surfaces painted on this output, and of their
+     * sub-surfaces, that a frame has been rendered at @p msec.
+     *
+     * This is equivalent to calling SurfaceInterface::frameRendered() on every surface, but
+     * every surface is notified only once even if the list contains both a surface and its
+     * sub-surfaces, and the clients are flushed once afterwards. Null entries, e.g. from
+     * surfaces that were destroyed while the frame was painted, are skipped.
+     */
+    void frameRendered(const QVector<SurfaceInterface *> &surfaces, quint32 msec);
+
     /**
      * @returns all wl_resources bound for the @p client
      */
@@ -7,6 +7,7 @@
 #include "plasmashell_interface.h"
 #include "display.h"
 #include "surface_interface.h"
+#include "surface_interface_p.h"
 #include "utils.h"
 
 #include <qwayland-server-plasma-shell.h>
@@ -14,7 +15,6 @@
 namespace KWaylandServer
 {
 static const quint32 s_version = 6;
-static QList<PlasmaShellSurfaceInterface *> s_shellSurfaces;
 
 class PlasmaShellInterfacePrivate : public QtWaylandServer::org_kde_plasma_shell
 {
@@ -87,11 +87,7 @@ void PlasmaShellInterfacePrivate::org_kde_plasma_shell_get_surface(QtWaylandServ
     wl_resource *shell_resource = wl_resource_create(resource->client(), &org_kde_plasma_surface_interface, resource->version(), id);
 
     auto shellSurface = new PlasmaShellSurfaceInterface(s, shell_resource);
-    s_shellSurfaces.append(shellSurface);
-
-    QObject::connect(shellSurface, &QObject::destroyed, [shellSurface]() {
-        s_shellSurfaces.removeOne(shellSurface);
-    });
+    SurfaceInterfacePrivate::get(s)->setExtension(shellSurface);
 
     Q_EMIT q->surfaceCreated(shellSurface);
 }
@@ -321,12 +317,10 @@ PlasmaShellSurfaceInterface *PlasmaShellSurfaceInterface::get(wl_resource *nativ
 
 PlasmaShellSurfaceInterface *PlasmaShellSurfaceInterface::get(SurfaceInterface *surface)
 {
-    for (PlasmaShellSurfaceInterface *shellSurface : qAsConst(s_shellSurfaces)) {
-        if (shellSurface->surface() == surface) {
-            return shellSurface;
-        }
+    if (!surface) {
+        return nullptr;
     }
-    return nullptr;
+    return SurfaceInterfacePrivate::get(surface)->extension<PlasmaShellSurfaceInterface>();
 }
 
 void PlasmaShellSurfaceInterface::resetPositionSet()
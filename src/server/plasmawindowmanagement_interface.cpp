@@ -7,6 +7,7 @@
 #include "display.h"
 #include "logging.h"
 #include "plasmavirtualdesktop_interface.h"
+#include "releasablecache_p.h"
 #include "surface_interface.h"
 
 #include <QFile>
@@ -25,10 +26,11 @@ namespace KWaylandServer
 static const quint32 s_version = 14;
 static const quint32 s_activationVersion = 1;
 
-class PlasmaWindowManagementInterfacePrivate : public QtWaylandServer::org_kde_plasma_window_management
+class PlasmaWindowManagementInterfacePrivate : public QtWaylandServer::org_kde_plasma_window_management, public ReleasableCache
 {
 public:
     PlasmaWindowManagementInterfacePrivate(PlasmaWindowManagementInterface *_q, Display *display);
+    qint64 releaseCache(Display::MemoryPressure pressure) override;
     void sendShowingDesktopState();
     void sendShowingDesktopState(wl_resource *resource);
     void sendStackingOrderChanged();
@@ -62,6 +64,8 @@ public:
     void setPid(quint32 pid);
     void setThemedIconName(const QString &iconName);
     void setIcon(const QIcon &icon);
+    bool hasIcon() const;
+    qint64 releaseIcon();
     void unmap();
     void setState(org_kde_plasma_window_management_state flag, bool set);
     void setParentWindow(PlasmaWindowInterface *parent);
@@ -88,6 +92,8 @@ public:
     QString m_appServiceName;
     QString m_appObjectPath;
     QIcon m_icon;
+    // the serialized icon, replaces m_icon after the cache got released
+    QByteArray m_iconData;
     quint32 m_state = 0;
     QString uuid;
 
@@ -112,10 +118,24 @@ protected:
 
 PlasmaWindowManagementInterfacePrivate::PlasmaWindowManagementInterfacePrivate(PlasmaWindowManagementInterface *_q, Display *display)
     : QtWaylandServer::org_kde_plasma_window_management(*display, s_version)
+    , ReleasableCache(display)
     , q(_q)
 {
 }
 
+qint64 PlasmaWindowManagementInterfacePrivate::releaseCache(Display::MemoryPressure pressure)
+{
+    Q_UNUSED(pressure)
+    qint64 reclaimed = (stackingOrder.capacity() - stackingOrder.size()) * sizeof(quint32);
+    reclaimed += (stackingOrderUuids.capacity() - stackingOrderUuids.size()) * sizeof(QString);
+    stackingOrder.squeeze();
+    stackingOrderUuids.squeeze();
+    for (PlasmaWindowInterface *window : qAsConst(windows)) {
+        reclaimed += window->d->releaseIcon();
+    }
+    return reclaimed;
+}
+
 void PlasmaWindowManagementInterfacePrivate::sendShowingDesktopState()
 {
     const auto clientResources = resourceMap();
@@ -361,7 +381,7 @@ void PlasmaWindowInterfacePrivate::org_kde_plasma_window_bind_resource(Resource
     send_state_changed(resource->handle, m_state);
     if (!m_themedIconName.isEmpty()) {
         send_themed_icon_name_changed(resource->handle, m_themedIconName);
-    } else if (!m_icon.isNull()) {
+    } else if (hasIcon()) {
         if (resource->version() >= ORG_KDE_PLASMA_WINDOW_ICON_CHANGED_SINCE_VERSION) {
             send_icon_changed(resource->handle);
         }
@@ -430,6 +450,7 @@ void PlasmaWindowInterfacePrivate::setThemedIconName(const QString &iconName)
 void PlasmaWindowInterfacePrivate::setIcon(const QIcon &icon)
 {
     m_icon = icon;
+    m_iconData = QByteArray();
     setThemedIconName(m_icon.name());
 
     const auto clientResources = resourceMap();
@@ -440,9 +461,46 @@ void PlasmaWindowInterfacePrivate::setIcon(const QIcon &icon)
     }
 }
 
+bool PlasmaWindowInterfacePrivate::hasIcon() const
+{
+    return !m_icon.isNull() || !m_iconData.isNull();
+}
+
+qint64 PlasmaWindowInterfacePrivate::releaseIcon()
+{
+    if (m_icon.isNull()) {
+        return 0;
+    }
+    qint64 reclaimed = 0;
+    // themed icons are loaded from the theme again, any other icon is kept in the format
+    // it gets sent to the clients in, which stores the pixmaps as PNG
+    if (m_themedIconName.isEmpty()) {
+        const QList<QSize> sizes = m_icon.availableSizes();
+        for (const QSize &size : sizes) {
+            reclaimed += qint64(size.width()) * size.height() * 4;
+        }
+        QDataStream ds(&m_iconData, QIODevice::WriteOnly);
+        ds << m_icon;
+        reclaimed -= m_iconData.size();
+    }
+    m_icon = QIcon();
+    return reclaimed;
+}
+
 void PlasmaWindowInterfacePrivate::org_kde_plasma_window_get_icon(Resource *resource, int32_t fd)
 {
     Q_UNUSED(resource)
+    if (!m_iconData.isNull()) {
+        QtConcurrent::run(
+            [fd](const QByteArray &data) {
+                QFile file;
+                file.open(fd, QIODevice::WriteOnly, QFileDevice::AutoCloseHandle);
+                file.write(data);
+                file.close();
+            },
+            m_iconData);
+        return;
+    }
     QtConcurrent::run(
         [fd](const QIcon &icon) {
             QFile file;
@@ -451,7 +509,7 @@ void PlasmaWindowInterfacePrivate::org_kde_plasma_window_get_icon(Resource *reso
             ds << icon;
             file.close();
         },
-        m_icon);
+        m_icon.isNull() && !m_themedIconName.isEmpty() ? QIcon::fromTheme(m_themedIconName) : m_icon);
 }
 
 void PlasmaWindowInterfacePrivate::org_kde_plasma_window_request_enter_virtual_desktop(Resource *resource, const QString &id)
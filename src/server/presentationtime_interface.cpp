@@ -0,0 +1,84 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#include "presentationtime_interface.h"
+#include "display.h"
+#include "surface_interface_p.h"
+
+#include "qwayland-server-presentation-time.h"
+
+#include <time.h>
+
+namespace KWaylandServer
+{
+static const int s_version = 1;
+
+class PresentationTimeInterfacePrivate : public QtWaylandServer::wp_presentation
+{
+public:
+    PresentationTimeInterfacePrivate(Display *display);
+
+    quint32 clockId = CLOCK_MONOTONIC;
+
+protected:
+    void wp_presentation_bind_resource(Resource *resource) override;
+    void wp_presentation_destroy(Resource *resource) override;
+    void wp_presentation_feedback(Resource *resource, struct ::wl_resource *surface, uint32_t callback) override;
+};
+
+PresentationTimeInterfacePrivate::PresentationTimeInterfacePrivate(Display *display)
+    : QtWaylandServer::wp_presentation(*display, s_version)
+{
+}
+
+void PresentationTimeInterfacePrivate::wp_presentation_bind_resource(Resource *resource)
+{
+    send_clock_id(resource->handle, clockId);
+}
+
+void PresentationTimeInterfacePrivate::wp_presentation_destroy(Resource *resource)
+{
+    wl_resource_destroy(resource->handle);
+}
+
+void PresentationTimeInterfacePrivate::wp_presentation_feedback(Resource *resource, struct ::wl_resource *surface_resource, uint32_t callback)
+{
+    SurfaceInterface *surface = SurfaceInterface::get(surface_resource);
+    SurfaceInterfacePrivate *surfacePrivate = SurfaceInterfacePrivate::get(surface);
+
+    wl_resource *feedbackResource = wl_resource_create(resource->client(), &wp_presentation_feedback_interface, resource->version(), callback);
+    if (!feedbackResource) {
+        wl_resource_post_no_memory(resource->handle);
+        return;
+    }
+
+    // wp_presentation_feedback has no requests, the resource only goes away once it has
+    // been reported as presented or discarded, or when the client disconnects.
+    wl_resource_set_implementation(feedbackResource, nullptr, nullptr, [](wl_resource *resource) {
+        wl_list_remove(wl_resource_get_link(resource));
+    });
+
+    wl_list_insert(surfacePrivate->pending.presentationFeedbacks.prev, wl_resource_get_link(feedbackResource));
+}
+
+PresentationTimeInterface::PresentationTimeInterface(Display *display, QObject *parent)
+    : QObject(parent)
+    , d(new PresentationTimeInterfacePrivate(display))
+{
+}
+
+PresentationTimeInterface::~PresentationTimeInterface()
+{
+}
+
+quint32 PresentationTimeInterface::clockId() const
+{
+    return d->clockId;
+}
+
+void PresentationTimeInterface::setClockId(quint32 clockId)
+{
+    d->clockId = clockId;
+}
+
+} // namespace KWaylandServer
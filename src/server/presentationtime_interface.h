@@ -0,0 +1,51 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#pragma once
+
+#include <DWayland/Server/kwaylandserver_export.h>
+
+#include <QObject>
+
+namespace KWaylandServer
+{
+class Display;
+class PresentationTimeInterfacePrivate;
+
+/**
+ * The PresentationTimeInterface lets clients request precise feedback on when the content
+ * of their surfaces has been presented to the user.
+ *
+ * Every content update that a client asks feedback for is reported either as presented or
+ * as discarded. The compositor reports those events with SurfaceInterface::presented() and
+ * SurfaceInterface::discardPresentationFeedback(); all timestamps must be taken from the
+ * clock advertised with setClockId().
+ *
+ * PresentationTimeInterface corresponds to the Wayland interface @c wp_presentation.
+ */
+class KWAYLANDSERVER_EXPORT PresentationTimeInterface : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PresentationTimeInterface(Display *display, QObject *parent = nullptr);
+    ~PresentationTimeInterface() override;
+
+    /**
+     * Returns the id of the clock used for presentation timestamps. The default is
+     * @c CLOCK_MONOTONIC.
+     */
+    quint32 clockId() const;
+    /**
+     * Sets the id of the clock used for presentation timestamps to @p clockId.
+     *
+     * The clock id is announced to a client only once when it binds the global, so this
+     * should be called before any client connects.
+     */
+    void setClockId(quint32 clockId);
+
+private:
+    QScopedPointer<PresentationTimeInterfacePrivate> d;
+};
+
+} // namespace KWaylandServer
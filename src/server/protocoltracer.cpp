@@ -0,0 +1,216 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#include "protocoltracer.h"
+#include "protocoltracer_p.h"
+
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QSet>
+
+#include <atomic>
+#include <memory>
+
+namespace KWaylandServer
+{
+namespace
+{
+// must be a power of two
+constexpr quint64 s_capacity = 1 << 16;
+
+struct TraceRecord {
+    // odd while the record is being written, 2 * (index + 1) once it is complete
+    std::atomic<quint64> sequence{0};
+    const char *interface = nullptr;
+    const char *message = nullptr;
+    int opcode = 0;
+    ProtocolTraceScope::Kind kind = ProtocolTraceScope::Request;
+    pid_t pid = 0;
+    qint64 start = 0;
+    qint64 duration = 0;
+};
+
+struct TraceBuffer {
+    std::atomic<quint64> head{0};
+    TraceRecord records[s_capacity];
+};
+
+std::atomic<bool> s_enabled{false};
+std::atomic<TraceBuffer *> s_buffer{nullptr};
+
+TraceBuffer *ensureBuffer()
+{
+    TraceBuffer *buffer = s_buffer.load(std::memory_order_acquire);
+    if (buffer) {
+        return buffer;
+    }
+    // The buffer is never freed, writers may still hold a pointer to it after tracing stopped.
+    auto newBuffer = std::make_unique<TraceBuffer>();
+    if (s_buffer.compare_exchange_strong(buffer, newBuffer.get(), std::memory_order_acq_rel)) {
+        return newBuffer.release();
+    }
+    return buffer;
+}
+
+qint64 toNanoseconds(std::chrono::steady_clock::time_point point)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(point.time_since_epoch()).count();
+}
+
+void writeMicroseconds(QByteArray &out, qint64 nanoseconds)
+{
+    out += QByteArray::number(nanoseconds / 1000);
+    out += '.';
+    out += QByteArray::number(nanoseconds % 1000).rightJustified(3, '0');
+}
+}
+
+void ProtocolTraceScope::record(Kind kind,
+                                const char *interface,
+                                const char *message,
+                                int opcode,
+                                pid_t pid,
+                                std::chrono::steady_clock::time_point start,
+                                std::chrono::steady_clock::time_point end)
+{
+    TraceBuffer *buffer = s_buffer.load(std::memory_order_acquire);
+    if (!buffer) {
+        return;
+    }
+    const quint64 index = buffer->head.fetch_add(1, std::memory_order_relaxed);
+    TraceRecord &record = buffer->records[index & (s_capacity - 1)];
+    record.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    record.interface = interface;
+    record.message = message;
+    record.opcode = opcode;
+    record.kind = kind;
+    record.pid = pid;
+    record.start = toNanoseconds(start);
+    record.duration = toNanoseconds(end) - record.start;
+    record.sequence.store(2 * index + 2, std::memory_order_release);
+}
+
+bool ProtocolTracer::isAvailable()
+{
+#if defined(KWAYLAND_PROTOCOL_TRACING)
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool ProtocolTracer::isEnabled()
+{
+    return s_enabled.load(std::memory_order_relaxed);
+}
+
+void ProtocolTracer::setEnabled(bool enabled)
+{
+    if (enabled) {
+        ensureBuffer();
+    }
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+int ProtocolTracer::capacity()
+{
+    return s_capacity;
+}
+
+void ProtocolTracer::clear()
+{
+    TraceBuffer *buffer = s_buffer.load(std::memory_order_acquire);
+    if (!buffer) {
+        return;
+    }
+    // Skip over the records written so far instead of touching them, writers may be active.
+    // A load and store would lose the indices claimed by writers in between and hand them out
+    // again, the increment keeps them. Records claimed before fall out of the readable window.
+    buffer->head.fetch_add(s_capacity, std::memory_order_acq_rel);
+}
+
+QByteArray ProtocolTracer::toChromeTrace()
+{
+    QByteArray out;
+    QBuffer device(&out);
+    device.open(QIODevice::WriteOnly);
+    writeChromeTrace(&device);
+    return out;
+}
+
+bool ProtocolTracer::writeChromeTrace(QIODevice *device)
+{
+    const QByteArray compositorPid = QByteArray::number(QCoreApplication::applicationPid());
+
+    QByteArray out;
+    out += "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool needsComma = false;
+    QSet<pid_t> clients;
+
+    TraceBuffer *buffer = s_buffer.load(std::memory_order_acquire);
+    if (buffer) {
+        const quint64 head = buffer->head.load(std::memory_order_acquire);
+        const quint64 first = head > s_capacity ? head - s_capacity : 0;
+        for (quint64 index = first; index < head; ++index) {
+            const TraceRecord &slot = buffer->records[index & (s_capacity - 1)];
+            const quint64 sequence = slot.sequence.load(std::memory_order_acquire);
+            if (sequence != 2 * index + 2) {
+                // still being written, or already overwritten by a newer message
+                continue;
+            }
+            const char *interface = slot.interface;
+            const char *message = slot.message;
+            const int opcode = slot.opcode;
+            const ProtocolTraceScope::Kind kind = slot.kind;
+            const pid_t pid = slot.pid;
+            const qint64 start = slot.start;
+            const qint64 duration = slot.duration;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+                continue;
+            }
+
+            if (needsComma) {
+                out += ',';
+            }
+            needsComma = true;
+            out += "\n{\"name\":\"";
+            out += interface;
+            out += '.';
+            out += message;
+            out += "\",\"cat\":\"";
+            out += kind == ProtocolTraceScope::Request ? "request" : "event";
+            out += "\",\"ph\":\"X\",\"ts\":";
+            writeMicroseconds(out, start);
+            out += ",\"dur\":";
+            writeMicroseconds(out, duration);
+            out += ",\"pid\":" + compositorPid;
+            out += ",\"tid\":" + QByteArray::number(pid);
+            out += ",\"args\":{\"opcode\":" + QByteArray::number(opcode) + "}}";
+            clients.insert(pid);
+
+            if (out.size() > 64 * 1024) {
+                if (device->write(out) != out.size()) {
+                    return false;
+                }
+                out.clear();
+            }
+        }
+    }
+
+    // name the track of every client
+    for (pid_t pid : qAsConst(clients)) {
+        if (needsComma) {
+            out += ',';
+        }
+        needsComma = true;
+        out += "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" + compositorPid;
+        out += ",\"tid\":" + QByteArray::number(pid);
+        out += ",\"args\":{\"name\":\"client " + QByteArray::number(pid) + "\"}}";
+    }
+    out += "\n]}\n";
+    return device->write(out) == out.size();
+}
+
+} // namespace KWaylandServer
@@ -0,0 +1,58 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#pragma once
+
+#include <DWayland/Server/kwaylandserver_export.h>
+
+#include <QByteArray>
+
+class QIODevice;
+
+namespace KWaylandServer
+{
+/**
+ * The ProtocolTracer records the requests and events handled by the generated protocol
+ * code, together with the client and the time spent in them.
+ *
+ * The hooks are only compiled in if the library is built with the CMake option
+ * @c KWAYLAND_PROTOCOL_TRACING, see isAvailable(). Even then nothing is recorded until
+ * the tracer gets enabled, so a running compositor can start tracing on demand, e.g.
+ * from a D-Bus call or a debug console.
+ *
+ * The most recent messages are kept in a fixed size ring buffer that can be written out
+ * in the Chrome trace event format, which can be loaded in Perfetto or chrome://tracing.
+ * Every client shows up as a separate track named after its process id.
+ */
+class KWAYLANDSERVER_EXPORT ProtocolTracer
+{
+public:
+    /**
+     * Returns @c true if the generated protocol code contains the trace hooks.
+     */
+    static bool isAvailable();
+
+    static bool isEnabled();
+    static void setEnabled(bool enabled);
+
+    /**
+     * Returns the number of messages kept in the ring buffer.
+     */
+    static int capacity();
+    /**
+     * Drops all recorded messages.
+     */
+    static void clear();
+
+    /**
+     * Returns the recorded messages in the Chrome trace event JSON format.
+     */
+    static QByteArray toChromeTrace();
+    /**
+     * Writes the recorded messages in the Chrome trace event JSON format to @p device.
+     * Returns @c false if writing failed.
+     */
+    static bool writeChromeTrace(QIODevice *device);
+};
+
+} // namespace KWaylandServer
@@ -0,0 +1,77 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#pragma once
+
+#include "protocoltracer.h"
+
+#include <wayland-server-core.h>
+
+#include <chrono>
+
+#include <sys/types.h>
+
+namespace KWaylandServer
+{
+/**
+ * Records the time spent in a request handler or in sending an event. This is what the
+ * hooks generated by qtwaylandscanner with the --trace option expand to.
+ */
+class KWAYLANDSERVER_EXPORT ProtocolTraceScope
+{
+public:
+    enum Kind {
+        Request,
+        Event,
+    };
+
+    ProtocolTraceScope(Kind kind, const char *interface, const char *message, int opcode, wl_client *client)
+    {
+        if (Q_LIKELY(!ProtocolTracer::isEnabled())) {
+            return;
+        }
+        m_kind = kind;
+        m_interface = interface;
+        m_message = message;
+        m_opcode = opcode;
+        // resolve the client now, the handler may destroy it
+        wl_client_get_credentials(client, &m_pid, nullptr, nullptr);
+        m_start = std::chrono::steady_clock::now();
+    }
+
+    ~ProtocolTraceScope()
+    {
+        if (m_interface) {
+            record(m_kind, m_interface, m_message, m_opcode, m_pid, m_start, std::chrono::steady_clock::now());
+        }
+    }
+
+    /**
+     * Appends a message to the ring buffer. The @p interface and @p message names must be
+     * string literals, only the pointers are stored.
+     */
+    static void record(Kind kind,
+                       const char *interface,
+                       const char *message,
+                       int opcode,
+                       pid_t pid,
+                       std::chrono::steady_clock::time_point start,
+                       std::chrono::steady_clock::time_point end);
+
+private:
+    Q_DISABLE_COPY(ProtocolTraceScope)
+
+    Kind m_kind = Request;
+    const char *m_interface = nullptr;
+    const char *m_message = nullptr;
+    int m_opcode = 0;
+    pid_t m_pid = 0;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+} // namespace KWaylandServer
+
+#define QTWAYLANDSERVER_TRACE_REQUEST(interface, message, opcode, client)                                                                                     \
+    KWaylandServer::ProtocolTraceScope qtwaylandserverTraceScope(KWaylandServer::ProtocolTraceScope::Request, interface, message, opcode, client)
+#define QTWAYLANDSERVER_TRACE_EVENT(interface, message, opcode, resource)                                                                                     \
+    KWaylandServer::ProtocolTraceScope qtwaylandserverTraceScope(KWaylandServer::ProtocolTraceScope::Event, interface, message, opcode, wl_resource_get_client(resource))
@@ -26,17 +26,17 @@ void RegionInterface::region_destroy(Resource *resource)
 
 void RegionInterface::region_add(Resource *, int32_t x, int32_t y, int32_t width, int32_t height)
 {
-    m_region += QRegion(x, y, width, height);
+    m_region.add(QRect(x, y, width, height));
 }
 
 void RegionInterface::region_subtract(Resource *, int32_t x, int32_t y, int32_t width, int32_t height)
 {
-    m_region -= QRegion(x, y, width, height);
+    m_region.subtract(QRect(x, y, width, height));
 }
 
 QRegion RegionInterface::region() const
 {
-    return m_region;
+    return m_region.region();
 }
 
 RegionInterface *RegionInterface::get(wl_resource *native)
@@ -6,7 +6,7 @@
 */
 #pragma once
 
-#include <QRegion>
+#include "regionbuilder.h"
 
 #include "qwayland-server-wayland.h"
 
@@ -27,7 +27,7 @@ protected:
     void region_subtract(Resource *resource, int32_t x, int32_t y, int32_t width, int32_t height) override;
 
 private:
-    QRegion m_region;
+    RegionBuilder m_region;
 };
 
 } // namespace KWaylandServer
@@ -0,0 +1,160 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#include "regionbuilder.h"
+
+#include <QMatrix4x4>
+
+namespace KWaylandServer
+{
+static QRegion uniteRange(const QRect *rects, int count)
+{
+    // Uniting the two halves keeps both operands of every union small, unlike adding one
+    // rectangle at a time to an ever growing region.
+    switch (count) {
+    case 0:
+        return QRegion();
+    case 1:
+        return QRegion(rects[0]);
+    default: {
+        const int half = count / 2;
+        return uniteRange(rects, half).united(uniteRange(rects + half, count - half));
+    }
+    }
+}
+
+RegionBuilder::RegionBuilder(int rectLimit)
+    : m_rectLimit(rectLimit)
+{
+}
+
+int RegionBuilder::rectLimit() const
+{
+    return m_rectLimit;
+}
+
+void RegionBuilder::add(const QRect &rect)
+{
+    if (rect.isEmpty()) {
+        return;
+    }
+    m_bounds |= rect;
+    if (m_collapsed) {
+        return;
+    }
+    ++m_rectCount;
+    if (m_rectLimit > 0 && m_rectCount > m_rectLimit) {
+        m_collapsed = true;
+        m_pending.clear();
+        m_region = QRegion();
+        return;
+    }
+    m_pending.append(rect);
+}
+
+void RegionBuilder::add(const QRegion &region)
+{
+    if (region.isEmpty()) {
+        return;
+    }
+    if (isEmpty() && (m_rectLimit == 0 || region.rectCount() <= m_rectLimit)) {
+        // Share the region instead of splitting it into rectangles.
+        m_region = region;
+        m_bounds = region.boundingRect();
+        m_rectCount = region.rectCount();
+        return;
+    }
+    for (const QRect &rect : region) {
+        add(rect);
+    }
+}
+
+void RegionBuilder::subtract(const QRect &rect)
+{
+    if (rect.isEmpty() || !rect.intersects(m_bounds)) {
+        return;
+    }
+    flush();
+    m_collapsed = false;
+    m_region -= rect;
+    m_bounds = m_region.boundingRect();
+    m_rectCount = m_region.rectCount();
+}
+
+void RegionBuilder::intersect(const QRect &rect)
+{
+    if (rect.contains(m_bounds)) {
+        return;
+    }
+    flush();
+    m_collapsed = false;
+    m_region &= rect;
+    m_bounds = m_region.boundingRect();
+    m_rectCount = m_region.rectCount();
+}
+
+void RegionBuilder::clear()
+{
+    m_region = QRegion();
+    m_pending.clear();
+    m_bounds = QRect();
+    m_rectCount = 0;
+    m_collapsed = false;
+}
+
+bool RegionBuilder::isEmpty() const
+{
+    return m_bounds.isEmpty();
+}
+
+bool RegionBuilder::isCollapsed() const
+{
+    return m_collapsed;
+}
+
+QRect RegionBuilder::boundingRect() const
+{
+    return m_bounds;
+}
+
+QRegion RegionBuilder::region() const
+{
+    flush();
+    return m_region;
+}
+
+void RegionBuilder::flush() const
+{
+    if (m_collapsed) {
+        if (m_region.rectCount() != 1 || m_region.boundingRect() != m_bounds) {
+            m_region = m_bounds;
+        }
+        return;
+    }
+    if (m_pending.isEmpty()) {
+        return;
+    }
+    const QRegion pending = uniteRange(m_pending.constData(), m_pending.count());
+    m_region = m_region.isEmpty() ? pending : m_region.united(pending);
+    m_pending.clear();
+}
+
+QRegion RegionBuilder::unite(const QVector<QRect> &rects)
+{
+    return uniteRange(rects.constData(), rects.count());
+}
+
+QRegion RegionBuilder::map(const QMatrix4x4 &matrix, const QRegion &region)
+{
+    if (matrix.isIdentity()) {
+        return region;
+    }
+    QVector<QRect> rects;
+    rects.reserve(region.rectCount());
+    for (const QRect &rect : region) {
+        rects.append(matrix.mapRect(rect));
+    }
+    return unite(rects);
+}
+
+} // namespace KWaylandServer
@@ -0,0 +1,79 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#pragma once
+
+#include <DWayland/Server/kwaylandserver_export.h>
+
+#include <QRegion>
+#include <QVector>
+
+class QMatrix4x4;
+
+namespace KWaylandServer
+{
+/**
+ * The RegionBuilder accumulates rectangles sent by clients and turns them into a QRegion.
+ *
+ * Uniting a QRegion with one rectangle at a time copies the whole region on every step,
+ * which gets quadratic for clients that send hundreds of rectangles per frame. The
+ * RegionBuilder instead collects the rectangles and unites them in one batch when the
+ * region is needed.
+ *
+ * If a rectangle limit is set, the region collapses to its bounding rectangle as soon as
+ * more rectangles than the limit have been added. This is only suitable for regions that
+ * may be over-approximated, such as damage.
+ */
+class KWAYLANDSERVER_EXPORT RegionBuilder
+{
+public:
+    /**
+     * The rectangle limit used for surface damage.
+     */
+    static constexpr int DamageRectLimit = 256;
+
+    /**
+     * Creates an empty RegionBuilder. A @p rectLimit of @c 0 means the region is never
+     * collapsed to its bounding rectangle.
+     */
+    explicit RegionBuilder(int rectLimit = 0);
+
+    int rectLimit() const;
+
+    void add(const QRect &rect);
+    void add(const QRegion &region);
+    void subtract(const QRect &rect);
+    void intersect(const QRect &rect);
+    void clear();
+
+    bool isEmpty() const;
+    /**
+     * Returns @c true if the region has been collapsed to its bounding rectangle because
+     * more rectangles than rectLimit() were added.
+     */
+    bool isCollapsed() const;
+    QRect boundingRect() const;
+    QRegion region() const;
+
+    /**
+     * Unites the given @p rects in a single batch.
+     */
+    static QRegion unite(const QVector<QRect> &rects);
+    /**
+     * Maps every rectangle of @p region with the @p matrix and unites the results in a
+     * single batch.
+     */
+    static QRegion map(const QMatrix4x4 &matrix, const QRegion &region);
+
+private:
+    void flush() const;
+
+    mutable QRegion m_region;
+    mutable QVector<QRect> m_pending;
+    QRect m_bounds;
+    int m_rectLimit;
+    int m_rectCount = 0;
+    bool m_collapsed = false;
+};
+
+} // namespace KWaylandServer
@@ -0,0 +1,22 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#include "releasablecache_p.h"
+#include "display_p.h"
+
+namespace KWaylandServer
+{
+ReleasableCache::ReleasableCache(Display *display)
+    : m_display(display)
+{
+    DisplayPrivate::get(display)->caches.append(this);
+}
+
+ReleasableCache::~ReleasableCache()
+{
+    if (m_display) {
+        DisplayPrivate::get(m_display)->caches.removeOne(this);
+    }
+}
+
+} // namespace KWaylandServer
@@ -0,0 +1,36 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#pragma once
+
+#include "display.h"
+
+#include <QPointer>
+
+namespace KWaylandServer
+{
+/**
+ * Memory held by a part of the server that can be given up on Display::releaseCaches().
+ *
+ * The cache registers itself with the display when it is created and unregisters when it
+ * is destroyed.
+ */
+class ReleasableCache
+{
+public:
+    explicit ReleasableCache(Display *display);
+    virtual ~ReleasableCache();
+
+    /**
+     * Frees or compacts as much as the @p pressure allows and returns an estimate of the
+     * number of bytes reclaimed.
+     */
+    virtual qint64 releaseCache(Display::MemoryPressure pressure) = 0;
+
+private:
+    Q_DISABLE_COPY(ReleasableCache)
+
+    QPointer<Display> m_display;
+};
+
+} // namespace KWaylandServer
@@ -7,6 +7,7 @@
 */
 #include "seat_interface.h"
 #include "abstract_data_source.h"
+#include "clientconnection.h"
 #include "datacontroldevice_v1_interface.h"
 #include "datacontrolsource_v1_interface.h"
 #include "datadevice_interface.h"
@@ -33,6 +34,7 @@
 
 #include <linux/input.h>
 
+#include <algorithm>
 #include <functional>
 
 namespace KWaylandServer
@@ -481,6 +483,7 @@ void SeatInterface::notifyPointerMotion(const QPointF &pos)
     }
 
     d->pointer->sendMotion(localPosition);
+    d->markInputClientDirty(effectiveFocusedSurface);
 }
 
 quint32 SeatInterface::timestamp() const
@@ -497,6 +500,47 @@ void SeatInterface::setTimestamp(quint32 time)
     Q_EMIT timestampChanged(time);
 }
 
+void SeatInterface::setImmediateInputFlush(bool enabled)
+{
+    d->immediateInputFlush = enabled;
+    if (!enabled) {
+        d->dirtyInputClients.clear();
+    }
+}
+
+bool SeatInterface::isImmediateInputFlush() const
+{
+    return d->immediateInputFlush;
+}
+
+void SeatInterfacePrivate::markInputClientDirty(SurfaceInterface *surface)
+{
+    if (!immediateInputFlush || !surface) {
+        return;
+    }
+    markInputClientDirty(surface->client());
+}
+
+void SeatInterfacePrivate::markInputClientDirty(ClientConnection *client)
+{
+    if (!immediateInputFlush || !client) {
+        return;
+    }
+    if (!dirtyInputClients.contains(client)) {
+        dirtyInputClients.append(client);
+    }
+}
+
+void SeatInterfacePrivate::flushInputClients()
+{
+    for (const QPointer<ClientConnection> &client : qAsConst(dirtyInputClients)) {
+        if (client) {
+            client->flush();
+        }
+    }
+    dirtyInputClients.clear();
+}
+
 void SeatInterface::setDragTarget(AbstractDropHandler *dropTarget,
                                   SurfaceInterface *surface,
                                   const QPointF &globalPosition,
@@ -520,7 +564,8 @@ void SeatInterface::setDragTarget(AbstractDropHandler *dropTarget,
         notifyPointerMotion(globalPosition);
         notifyPointerFrame();
     } else if (d->drag.mode == SeatInterfacePrivate::Drag::Mode::Touch && d->globalTouch.focus.firstTouchPos != globalPosition) {
-        notifyTouchMotion(d->globalTouch.ids.first(), globalPosition);
+        // contacts are sorted by id, move the first touch point to the new drag position
+        notifyTouchMotion(d->globalTouch.contacts.first().id, globalPosition);
     }
     if (d->drag.target) {
         d->drag.surface = surface;
@@ -569,6 +614,8 @@ void SeatInterface::setFocusedPointerSurface(SurfaceInterface *surface, const QM
     }
 
     const quint32 serial = d->display->nextSerial();
+    // the previously focused client gets the leave event
+    d->markInputClientDirty(d->pointer->focusedSurface());
 
     if (d->globalPointer.focus.surface) {
         disconnect(d->globalPointer.focus.destroyConnection);
@@ -594,6 +641,7 @@ void SeatInterface::setFocusedPointerSurface(SurfaceInterface *surface, const QM
             localPosition = surface->mapToChild(effectiveFocusedSurface, localPosition);
         }
         d->pointer->setFocusedSurface(effectiveFocusedSurface, localPosition, serial);
+        d->markInputClientDirty(effectiveFocusedSurface);
     } else {
         d->pointer->setFocusedSurface(nullptr, QPointF(), serial);
     }
@@ -678,6 +726,7 @@ void SeatInterface::notifyPointerAxis(Qt::Orientation orientation, qreal delta,
         return;
     }
     d->pointer->sendAxis(orientation, delta, discreteDelta, source);
+    d->markInputClientDirty(d->pointer->focusedSurface());
 }
 
 void SeatInterface::notifyPointerAxisToClient(Qt::Orientation orientation, qint32 delta, SurfaceInterface * surface, QMatrix4x4 matrix)
@@ -738,6 +787,7 @@ void SeatInterface::notifyPointerButton(quint32 button, PointerButtonState state
     }
 
     d->pointer->sendButton(button, state, serial);
+    d->markInputClientDirty(d->pointer->focusedSurface());
 }
 
 void SeatInterface::notifyPointerFrame()
@@ -746,6 +796,8 @@ void SeatInterface::notifyPointerFrame()
         return;
     }
     d->pointer->sendFrame();
+    d->markInputClientDirty(d->pointer->focusedSurface());
+    d->flushInputClients();
 }
 
 quint32 SeatInterface::pointerButtonSerial(Qt::MouseButton button) const
@@ -918,6 +970,9 @@ void SeatInterface::setFocusedKeyboardSurface(SurfaceInterface *surface)
     }
 
     const quint32 serial = d->display->nextSerial();
+    // the previously focused client gets the leave event, the new one enter and the selection
+    d->markInputClientDirty(d->keyboard->focusedSurface());
+    d->markInputClientDirty(surface);
 
     if (d->globalKeyboard.focus.surface) {
         disconnect(d->globalKeyboard.focus.destroyConnection);
@@ -977,6 +1032,8 @@ void SeatInterface::notifyKeyboardKey(quint32 keyCode, KeyboardKeyState state)
         return;
     }
     d->keyboard->sendKey(keyCode, state);
+    d->markInputClientDirty(d->keyboard->focusedSurface());
+    d->flushInputClients();
 }
 
 void SeatInterface::notifyKeyboardModifiers(quint32 depressed, quint32 latched, quint32 locked, quint32 group)
@@ -985,6 +1042,8 @@ void SeatInterface::notifyKeyboardModifiers(quint32 depressed, quint32 latched,
         return;
     }
     d->keyboard->sendModifiers(depressed, latched, locked, group);
+    d->markInputClientDirty(d->keyboard->focusedSurface());
+    d->flushInputClients();
 }
 
 void SeatInterface::notifyTouchCancel()
@@ -998,7 +1057,7 @@ void SeatInterface::notifyTouchCancel()
         // cancel the drag, don't drop. serial does not matter
         d->cancelDrag(0);
     }
-    d->globalTouch.ids.clear();
+    d->globalTouch.contacts.clear();
 }
 
 SurfaceInterface *SeatInterface::focusedTouchSurface() const
@@ -1013,7 +1072,7 @@ QPointF SeatInterface::focusedTouchSurfacePosition() const
 
 bool SeatInterface::isTouchSequence() const
 {
-    return !d->globalTouch.ids.isEmpty();
+    return !d->globalTouch.contacts.isEmpty();
 }
 
 TouchInterface *SeatInterface::touch() const
@@ -1064,97 +1123,174 @@ void SeatInterface::setFocusedTouchSurfacePosition(const QPointF &surfacePositio
     d->globalTouch.focus.transformation.translate(-surfacePosition.x(), -surfacePosition.y());
 }
 
-void SeatInterface::notifyTouchDown(qint32 id, const QPointF &globalPosition)
+SeatInterfacePrivate::Touch::Contact *SeatInterfacePrivate::Touch::findContact(qint32 id)
 {
-    if (!d->touch) {
-        return;
+    auto it = std::lower_bound(contacts.begin(), contacts.end(), id, [](const Contact &contact, qint32 id) {
+        return contact.id < id;
+    });
+    if (it == contacts.end() || it->id != id) {
+        return nullptr;
     }
-    const qint32 serial = display()->nextSerial();
-    const auto pos = globalPosition - d->globalTouch.focus.offset;
-    d->touch->sendDown(id, serial, pos);
+    return it;
+}
 
-    if (id == 0) {
-        d->globalTouch.focus.firstTouchPos = globalPosition;
+void SeatInterfacePrivate::Touch::insertContact(qint32 id, quint32 serial)
+{
+    auto it = std::lower_bound(contacts.begin(), contacts.end(), id, [](const Contact &contact, qint32 id) {
+        return contact.id < id;
+    });
+    if (it != contacts.end() && it->id == id) {
+        it->serial = serial;
+    } else {
+        contacts.insert(it, Contact{id, serial});
     }
+}
 
-    if (id == 0 && hasPointer() && focusedTouchSurface()) {
-        TouchInterfacePrivate *touchPrivate = TouchInterfacePrivate::get(d->touch.data());
-        if (touchPrivate->touchesForClient(focusedTouchSurface()->client()).isEmpty()) {
-            // If the client did not bind the touch interface fall back
-            // to at least emulating touch through pointer events.
-            d->pointer->setFocusedSurface(focusedTouchSurface(), pos, serial);
-            d->pointer->sendMotion(pos);
-            d->pointer->sendFrame();
-        }
+void SeatInterfacePrivate::Touch::removeContact(Contact *contact)
+{
+    contacts.erase(contact);
+}
+
+SeatInterfacePrivate::TouchTargets SeatInterfacePrivate::touchTargets() const
+{
+    TouchTargets targets;
+    TouchInterfacePrivate *touchPrivate = TouchInterfacePrivate::get(touch.data());
+    if (touchPrivate->focusedSurface) {
+        targets.resources = touchPrivate->touchesForClient(touchPrivate->focusedSurface->client());
     }
 
-    d->globalTouch.ids[id] = serial;
+    SurfaceInterface *focusedSurface = globalTouch.focus.surface;
+    if (pointer && focusedSurface) {
+        // If the client did not bind the touch interface fall back
+        // to at least emulating touch through pointer events.
+        if (focusedSurface == touchPrivate->focusedSurface) {
+            targets.emulatePointer = targets.resources.isEmpty();
+        } else {
+            targets.emulatePointer = touchPrivate->touchesForClient(focusedSurface->client()).isEmpty();
+        }
+    }
+    return targets;
 }
 
-void SeatInterface::notifyTouchMotion(qint32 id, const QPointF &globalPosition)
+void SeatInterfacePrivate::touchDown(const TouchTargets &targets, qint32 id, const QPointF &globalPosition)
 {
-    if (!d->touch) {
-        return;
+    const quint32 serial = display->nextSerial();
+    const auto pos = globalPosition - globalTouch.focus.offset;
+    TouchInterfacePrivate::get(touch.data())->sendDown(targets.resources, id, serial, pos);
+
+    if (id == 0) {
+        globalTouch.focus.firstTouchPos = globalPosition;
+
+        if (targets.emulatePointer) {
+            pointer->setFocusedSurface(globalTouch.focus.surface, pos, serial);
+            pointer->sendMotion(pos);
+            pointer->sendFrame();
+        }
     }
-    auto itTouch = d->globalTouch.ids.constFind(id);
-    if (itTouch == d->globalTouch.ids.constEnd()) {
+
+    globalTouch.insertContact(id, serial);
+}
+
+void SeatInterfacePrivate::touchMotion(const TouchTargets &targets, qint32 id, const QPointF &globalPosition)
+{
+    const Touch::Contact *contact = globalTouch.findContact(id);
+    if (!contact) {
         // This can happen in cases where the interaction started while the device was asleep
         qCWarning(KWAYLAND_SERVER) << "Detected a touch move that never has been down, discarding";
         return;
     }
+    const quint32 serial = contact->serial;
 
-    const auto pos = globalPosition - d->globalTouch.focus.offset;
-    if (isDragTouch()) {
+    const auto pos = globalPosition - globalTouch.focus.offset;
+    if (drag.mode == Drag::Mode::Touch) {
         // handled by DataDevice
     } else {
-        d->touch->sendMotion(id, pos);
+        TouchInterfacePrivate::get(touch.data())->sendMotion(targets.resources, id, pos);
     }
 
     if (id == 0) {
-        d->globalTouch.focus.firstTouchPos = globalPosition;
-
-        if (hasPointer() && focusedTouchSurface()) {
-            TouchInterfacePrivate *touchPrivate = TouchInterfacePrivate::get(d->touch.data());
-            if (touchPrivate->touchesForClient(focusedTouchSurface()->client()).isEmpty()) {
-                // Client did not bind touch, fall back to emulating with pointer events.
-                d->pointer->sendMotion(pos);
-                d->pointer->sendFrame();
-            }
+        globalTouch.focus.firstTouchPos = globalPosition;
+
+        if (targets.emulatePointer) {
+            // Client did not bind touch, fall back to emulating with pointer events.
+            pointer->sendMotion(pos);
+            pointer->sendFrame();
         }
     }
-    Q_EMIT touchMoved(id, *itTouch, globalPosition);
+    Q_EMIT q->touchMoved(id, serial, globalPosition);
 }
 
-void SeatInterface::notifyTouchUp(qint32 id)
+void SeatInterfacePrivate::touchUp(const TouchTargets &targets, qint32 id)
 {
-    if (!d->touch) {
+    Touch::Contact *contact = globalTouch.findContact(id);
+    if (!contact) {
+        // This can happen in cases where the interaction started while the device was asleep
+        qCWarning(KWAYLAND_SERVER) << "Detected a touch that never started, discarding";
         return;
     }
+    const quint32 serial = display->nextSerial();
+    if (drag.mode == Drag::Mode::Touch && drag.dragImplicitGrabSerial == contact->serial) {
+        // the implicitly grabbing touch point has been upped, the drop goes to the drag target
+        markInputClientDirty(drag.surface);
+        endDrag(serial);
+    }
+    TouchInterfacePrivate::get(touch.data())->sendUp(targets.resources, id, serial);
 
-    auto itTouch = d->globalTouch.ids.find(id);
-    if (itTouch == d->globalTouch.ids.end()) {
-        // This can happen in cases where the interaction started while the device was asleep
-        qCWarning(KWAYLAND_SERVER) << "Detected a touch that never started, discarding";
+    if (id == 0 && targets.emulatePointer) {
+        // Client did not bind touch, fall back to emulating with pointer events.
+        const quint32 serial = display->nextSerial();
+        pointer->sendButton(BTN_LEFT, PointerButtonState::Released, serial);
+        pointer->sendFrame();
+    }
+
+    globalTouch.removeContact(contact);
+}
+
+void SeatInterfacePrivate::markTouchTargetsDirty(const TouchTargets &targets)
+{
+    if (!immediateInputFlush) {
         return;
     }
-    const qint32 serial = d->display->nextSerial();
-    if (d->drag.mode == SeatInterfacePrivate::Drag::Mode::Touch && d->drag.dragImplicitGrabSerial == d->globalTouch.ids.value(id)) {
-        // the implicitly grabbing touch point has been upped
-        d->endDrag(serial);
+    // all wl_touch resources belong to the client of the focused touch surface
+    if (!targets.resources.isEmpty()) {
+        markInputClientDirty(display->getConnection(targets.resources.constFirst()->client()));
+    }
+    if (targets.emulatePointer) {
+        markInputClientDirty(pointer->focusedSurface());
     }
-    d->touch->sendUp(id, serial);
+    if (drag.mode == Drag::Mode::Touch) {
+        markInputClientDirty(drag.surface);
+    }
+}
 
-    if (id == 0 && hasPointer() && focusedTouchSurface()) {
-        TouchInterfacePrivate *touchPrivate = TouchInterfacePrivate::get(d->touch.data());
-        if (touchPrivate->touchesForClient(focusedTouchSurface()->client()).isEmpty()) {
-            // Client did not bind touch, fall back to emulating with pointer events.
-            const quint32 serial = display()->nextSerial();
-            d->pointer->sendButton(BTN_LEFT, PointerButtonState::Released, serial);
-            d->pointer->sendFrame();
-        }
+void SeatInterface::notifyTouchDown(qint32 id, const QPointF &globalPosition)
+{
+    if (!d->touch) {
+        return;
     }
+    const SeatInterfacePrivate::TouchTargets targets = d->touchTargets();
+    d->touchDown(targets, id, globalPosition);
+    d->markTouchTargetsDirty(targets);
+}
 
-    d->globalTouch.ids.erase(itTouch);
+void SeatInterface::notifyTouchMotion(qint32 id, const QPointF &globalPosition)
+{
+    if (!d->touch) {
+        return;
+    }
+    const SeatInterfacePrivate::TouchTargets targets = d->touchTargets();
+    d->touchMotion(targets, id, globalPosition);
+    d->markTouchTargetsDirty(targets);
+}
+
+void SeatInterface::notifyTouchUp(qint32 id)
+{
+    if (!d->touch) {
+        return;
+    }
+    const SeatInterfacePrivate::TouchTargets targets = d->touchTargets();
+    d->touchUp(targets, id);
+    d->markTouchTargetsDirty(targets);
 }
 
 void SeatInterface::notifyTouchFrame()
@@ -1163,6 +1299,34 @@ void SeatInterface::notifyTouchFrame()
         return;
     }
     d->touch->sendFrame();
+    if (d->immediateInputFlush) {
+        d->markTouchTargetsDirty(d->touchTargets());
+    }
+    d->flushInputClients();
+}
+
+void SeatInterface::notifyTouchFrame(const QVector<TouchPoint> &points)
+{
+    if (!d->touch) {
+        return;
+    }
+    const SeatInterfacePrivate::TouchTargets targets = d->touchTargets();
+    for (const TouchPoint &point : points) {
+        switch (point.state) {
+        case TouchPoint::State::Down:
+            d->touchDown(targets, point.id, point.globalPosition);
+            break;
+        case TouchPoint::State::Motion:
+            d->touchMotion(targets, point.id, point.globalPosition);
+            break;
+        case TouchPoint::State::Up:
+            d->touchUp(targets, point.id);
+            break;
+        }
+    }
+    TouchInterfacePrivate::get(d->touch.data())->sendFrame(targets.resources);
+    d->markTouchTargetsDirty(targets);
+    d->flushInputClients();
 }
 
 bool SeatInterface::hasImplicitTouchGrab(quint32 serial) const
@@ -1171,7 +1335,10 @@ bool SeatInterface::hasImplicitTouchGrab(quint32 serial) const
         // origin surface has been destroyed
         return false;
     }
-    return d->globalTouch.ids.key(serial, -1) != -1;
+    const auto &contacts = d->globalTouch.contacts;
+    return std::any_of(contacts.constBegin(), contacts.constEnd(), [serial](const SeatInterfacePrivate::Touch::Contact &contact) {
+        return contact.serial == serial;
+    });
 }
 
 bool SeatInterface::isDrag() const
@@ -11,6 +11,7 @@
 #include <QMatrix4x4>
 #include <QObject>
 #include <QPoint>
+#include <QVector>
 
 struct wl_client;
 struct wl_resource;
@@ -171,6 +172,17 @@ public:
     void setTimestamp(quint32 time);
     quint32 timestamp() const;
 
+    /**
+     * Sets whether the clients that received input events are flushed at the end of every
+     * pointer and touch frame and after every keyboard key and modifiers event. Otherwise the
+     * events are only written to the clients once the event loop goes idle, after painting and
+     * all other pending work. Enabled by default.
+     *
+     * @see ClientConnection::flush
+     */
+    void setImmediateInputFlush(bool enabled);
+    bool isImmediateInputFlush() const;
+
     /**
      * @name Drag'n'Drop related methods
      */
@@ -583,6 +595,29 @@ public:
     void notifyTouchUp(qint32 id);
     void notifyTouchMotion(qint32 id, const QPointF &globalPosition);
     void notifyTouchFrame();
+    /**
+     * A touch point that changed within a touch frame.
+     * @see notifyTouchFrame(const QVector<TouchPoint> &)
+     */
+    struct TouchPoint {
+        enum class State {
+            Down,
+            Motion,
+            Up,
+        };
+        qint32 id = 0;
+        State state = State::Motion;
+        QPointF globalPosition;
+    };
+    /**
+     * Sends all the @p points that changed within one touch frame followed by the frame event.
+     *
+     * This is equivalent to calling notifyTouchDown, notifyTouchMotion and notifyTouchUp for
+     * each point in order and notifyTouchFrame afterwards, but the touch resources of the
+     * focused client are only looked up once. The global position of points going up is
+     * ignored.
+     */
+    void notifyTouchFrame(const QVector<TouchPoint> &points);
     void notifyTouchCancel();
     bool isTouchSequence() const;
     QPointF firstTouchPointPosition() const;
@@ -10,7 +10,6 @@
 #include "seat_interface.h"
 // Qt
 #include <QHash>
-#include <QMap>
 #include <QPointer>
 #include <QVector>
 
@@ -19,6 +18,7 @@
 namespace KWaylandServer
 {
 class AbstractDataSource;
+class ClientConnection;
 class DataDeviceInterface;
 class DataSourceInterface;
 class DataControlDeviceV1Interface;
@@ -42,6 +42,14 @@ public:
     void endDrag(quint32 serial);
     void cancelDrag(quint32 serial);
 
+    /**
+     * Remembers the client of @p surface as having received input events that are not
+     * flushed yet.
+     */
+    void markInputClientDirty(SurfaceInterface *surface);
+    void markInputClientDirty(ClientConnection *client);
+    void flushInputClients();
+
     SeatInterface *q;
     QPointer<Display> display;
     QString name;
@@ -55,6 +63,10 @@ public:
     QVector<PrimarySelectionDeviceV1Interface *> primarySelectionDevices;
     QVector<DataControlDeviceV1Interface *> dataControlDevices;
 
+    bool immediateInputFlush = true;
+    // there is rarely more than the focused client and the one that just lost focus
+    QVector<QPointer<ClientConnection>> dirtyInputClients;
+
     // TextInput v2
     QPointer<TextInputV2Interface> textInputV2;
     QPointer<TextInputV3Interface> textInputV3;
@@ -111,11 +123,34 @@ public:
             QPointF firstTouchPos;
             QMatrix4x4 transformation;
         };
+        // a touch point that is currently down together with the serial of its down event
+        struct Contact {
+            qint32 id;
+            quint32 serial;
+        };
         Focus focus;
-        QMap<qint32, quint32> ids;
+        // sorted by id, there are rarely more than ten contacts so a flat table beats a map
+        QVector<Contact> contacts;
+
+        Contact *findContact(qint32 id);
+        void insertContact(qint32 id, quint32 serial);
+        void removeContact(Contact *contact);
     };
     Touch globalTouch;
 
+    // The wl_touch resources of the focused client, looked up once per touch frame.
+    struct TouchTargets {
+        QList<QtWaylandServer::wl_touch::Resource *> resources;
+        // the client did not bind wl_touch, the first touch point is emulated with the pointer
+        bool emulatePointer = false;
+    };
+    TouchTargets touchTargets() const;
+    void touchDown(const TouchTargets &targets, qint32 id, const QPointF &globalPosition);
+    void touchMotion(const TouchTargets &targets, qint32 id, const QPointF &globalPosition);
+    void touchUp(const TouchTargets &targets, qint32 id);
+    // the clients of the wl_touch resources, of the emulated pointer and of a touch drag
+    void markTouchTargetsDirty(const TouchTargets &targets);
+
     struct Drag {
         enum class Mode {
             None,
@@ -7,6 +7,7 @@
 #include "display.h"
 #include "logging.h"
 #include "surface_interface.h"
+#include "surface_interface_p.h"
 
 #include <QVector>
 
@@ -123,7 +124,6 @@ public:
 
 private:
     ServerSideDecorationInterface *q;
-    static QVector<ServerSideDecorationInterfacePrivate *> s_all;
 
 protected:
     void org_kde_kwin_server_decoration_destroy_resource(Resource *resource) override;
@@ -131,8 +131,6 @@ protected:
     void org_kde_kwin_server_decoration_request_mode(Resource *resource, uint32_t mode) override;
 };
 
-QVector<ServerSideDecorationInterfacePrivate *> ServerSideDecorationInterfacePrivate::s_all;
-
 void ServerSideDecorationInterfacePrivate::org_kde_kwin_server_decoration_request_mode(Resource *resource, uint32_t mode)
 {
     Q_UNUSED(resource)
@@ -169,12 +167,10 @@ void ServerSideDecorationInterfacePrivate::org_kde_kwin_server_decoration_destro
 
 ServerSideDecorationInterface *ServerSideDecorationInterfacePrivate::get(SurfaceInterface *surface)
 {
-    for (ServerSideDecorationInterfacePrivate *decoration : qAsConst(s_all)) {
-        if (decoration->surface == surface) {
-            return decoration->q;
-        }
+    if (!surface) {
+        return nullptr;
     }
-    return nullptr;
+    return SurfaceInterfacePrivate::get(surface)->extension<ServerSideDecorationInterface>();
 }
 
 ServerSideDecorationInterfacePrivate::ServerSideDecorationInterfacePrivate(ServerSideDecorationManagerInterface *manager,
@@ -186,12 +182,11 @@ ServerSideDecorationInterfacePrivate::ServerSideDecorationInterfacePrivate(Serve
     , surface(surface)
     , q(_q)
 {
-    s_all << this;
+    SurfaceInterfacePrivate::get(surface)->setExtension(_q);
 }
 
 ServerSideDecorationInterfacePrivate::~ServerSideDecorationInterfacePrivate()
 {
-    s_all.removeAll(this);
 }
 
 void ServerSideDecorationInterfacePrivate::setMode(ServerSideDecorationManagerInterface::Mode mode)
@@ -6,8 +6,13 @@
 #include "shadow_interface.h"
 #include "clientbuffer.h"
 #include "display.h"
+#include "shmclientbuffer.h"
 #include "surface_interface_p.h"
 
+#include <QCryptographicHash>
+
+#include <functional>
+
 #include <qwayland-server-shadow.h>
 
 namespace KWaylandServer
@@ -19,8 +24,12 @@ class ShadowManagerInterfacePrivate : public QtWaylandServer::org_kde_kwin_shado
 public:
     ShadowManagerInterfacePrivate(ShadowManagerInterface *_q, Display *display);
 
+    void acquireKey(const QByteArray &key);
+    void releaseKey(const QByteArray &key);
+
     ShadowManagerInterface *q;
     Display *display;
+    QHash<QByteArray, int> keyUses;
 
 protected:
     void org_kde_kwin_shadow_manager_create(Resource *resource, uint32_t id, wl_resource *surface) override;
@@ -35,6 +44,23 @@ ShadowManagerInterfacePrivate::ShadowManagerInterfacePrivate(ShadowManagerInterf
 {
 }
 
+void ShadowManagerInterfacePrivate::acquireKey(const QByteArray &key)
+{
+    ++keyUses[key];
+}
+
+void ShadowManagerInterfacePrivate::releaseKey(const QByteArray &key)
+{
+    auto it = keyUses.find(key);
+    if (it == keyUses.end()) {
+        return;
+    }
+    if (--it.value() == 0) {
+        keyUses.erase(it);
+        Q_EMIT q->keyReleased(key);
+    }
+}
+
 void ShadowManagerInterfacePrivate::org_kde_kwin_shadow_manager_destroy(Resource *resource)
 {
     wl_resource_destroy(resource->handle);
@@ -85,6 +111,11 @@ Display *ShadowManagerInterface::display() const
     return d->display;
 }
 
+int ShadowManagerInterface::keyUseCount(const QByteArray &key) const
+{
+    return d->keyUses.value(key);
+}
+
 class ShadowInterfacePrivate : public QtWaylandServer::org_kde_kwin_shadow
 {
 public:
@@ -116,12 +147,22 @@ public:
         Flags flags = Flags::None;
     };
 
+    struct Key {
+        QByteArray value;
+        bool computed = false;
+    };
+
     void commit();
     void attach(State::Flags flag, wl_resource *buffer);
+    QByteArray cachedKey(Key &key, const std::function<bool(QByteArray *)> &compute);
+    void releaseKey(Key &key);
 
-    ShadowManagerInterface *manager;
+    QPointer<ShadowManagerInterface> manager;
     State current;
     State pending;
+    // the content keys of the current tiles and of the whole shadow, computed on first use
+    Key tileKeys[8];
+    Key contentKey;
     ShadowInterface *q;
 
 protected:
@@ -154,6 +195,8 @@ void ShadowInterfacePrivate::org_kde_kwin_shadow_commit(Resource *resource)
             pending.__PART__->ref();                                                                                                                           \
         }                                                                                                                                                      \
         current.__PART__ = pending.__PART__;                                                                                                                   \
+        releaseKey(tileKeys[int(ShadowInterface::Tile::__FLAG__)]);                                                                                            \
+        releaseKey(contentKey);                                                                                                                                \
     }
     BUFFER(Left, left)
     BUFFER(TopLeft, topLeft)
@@ -171,6 +214,31 @@ void ShadowInterfacePrivate::org_kde_kwin_shadow_commit(Resource *resource)
     pending = State();
 }
 
+QByteArray ShadowInterfacePrivate::cachedKey(Key &key, const std::function<bool(QByteArray *)> &compute)
+{
+    if (!key.computed) {
+        QByteArray value;
+        if (!compute(&value)) {
+            // the content cannot be read right now, try again on the next request
+            return QByteArray();
+        }
+        key.value = value;
+        key.computed = true;
+        if (!key.value.isEmpty() && manager) {
+            manager->d->acquireKey(key.value);
+        }
+    }
+    return key.value;
+}
+
+void ShadowInterfacePrivate::releaseKey(Key &key)
+{
+    if (key.computed && !key.value.isEmpty() && manager) {
+        manager->d->releaseKey(key.value);
+    }
+    key = Key();
+}
+
 void ShadowInterfacePrivate::attach(ShadowInterfacePrivate::State::Flags flag, wl_resource *buffer)
 {
     ClientBuffer *b = manager->display()->clientBufferForResource(buffer);
@@ -301,6 +369,11 @@ ShadowInterfacePrivate::ShadowInterfacePrivate(ShadowInterface *_q, wl_resource
 
 ShadowInterfacePrivate::~ShadowInterfacePrivate()
 {
+    for (Key &tileKey : tileKeys) {
+        releaseKey(tileKey);
+    }
+    releaseKey(contentKey);
+
 #define CURRENT(__PART__)                                                                                                                                      \
     if (current.__PART__) {                                                                                                                                    \
         current.__PART__->unref();                                                                                                                             \
@@ -345,4 +418,88 @@ BUFFER(bottomRight)
 BUFFER(bottom)
 BUFFER(bottomLeft)
 
+#undef BUFFER
+
+ClientBuffer *ShadowInterface::tile(Tile tile) const
+{
+    switch (tile) {
+    case Tile::Left:
+        return left();
+    case Tile::TopLeft:
+        return topLeft();
+    case Tile::Top:
+        return top();
+    case Tile::TopRight:
+        return topRight();
+    case Tile::Right:
+        return right();
+    case Tile::BottomRight:
+        return bottomRight();
+    case Tile::Bottom:
+        return bottom();
+    case Tile::BottomLeft:
+        return bottomLeft();
+    }
+    Q_UNREACHABLE();
+    return nullptr;
+}
+
+static bool bufferContentKey(ClientBuffer *buffer, QByteArray *key)
+{
+    auto shmBuffer = qobject_cast<ShmClientBuffer *>(buffer);
+    if (!shmBuffer) {
+        return true;
+    }
+    const QImage image = shmBuffer->data();
+    if (image.isNull()) {
+        // e.g. the data of another shm buffer is accessed at the moment
+        return false;
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    const qint32 header[] = {image.width(), image.height(), qint32(image.format())};
+    hash.addData(reinterpret_cast<const char *>(header), sizeof(header));
+    // the stride is up to the client, only hash the pixels of each line
+    const int lineSize = (image.width() * image.depth() + 7) / 8;
+    for (int y = 0; y < image.height(); ++y) {
+        hash.addData(reinterpret_cast<const char *>(image.constScanLine(y)), lineSize);
+    }
+    *key = hash.result();
+    return true;
+}
+
+QByteArray ShadowInterface::tileKey(Tile tile) const
+{
+    return d->cachedKey(d->tileKeys[int(tile)], [this, tile](QByteArray *key) {
+        return bufferContentKey(this->tile(tile), key);
+    });
+}
+
+QByteArray ShadowInterface::contentKey() const
+{
+    return d->cachedKey(d->contentKey, [this](QByteArray *result) {
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        bool hasTiles = false;
+        for (int i = int(Tile::Left); i <= int(Tile::BottomLeft); ++i) {
+            const Tile tile = Tile(i);
+            const QByteArray key = tileKey(tile);
+            if (this->tile(tile)) {
+                if (!d->tileKeys[i].computed) {
+                    return false;
+                }
+                if (key.isEmpty()) {
+                    return true;
+                }
+                hasTiles = true;
+            }
+            // keep the position of the tiles in the key
+            hash.addData(reinterpret_cast<const char *>(&i), sizeof(i));
+            hash.addData(key);
+        }
+        if (hasTiles) {
+            *result = hash.result();
+        }
+        return true;
+    });
+}
+
 }
@@ -29,7 +29,27 @@ public:
 
     Display *display() const;
 
+    /**
+     * Returns how many times the content with the given @p key is used by the shadows of
+     * this manager. A shadow uses the content of each of its tiles and its whole content,
+     * but only once the key was requested through ShadowInterface::tileKey() or
+     * ShadowInterface::contentKey().
+     *
+     * Compositors can keep one texture per key instead of one per shadow.
+     *
+     * @see keyReleased
+     */
+    int keyUseCount(const QByteArray &key) const;
+
+Q_SIGNALS:
+    /**
+     * Emitted when the last shadow using the content with the given @p key got destroyed or
+     * had the content replaced. Compositors can release the texture kept for the @p key.
+     */
+    void keyReleased(const QByteArray &key);
+
 private:
+    friend class ShadowInterfacePrivate;
     QScopedPointer<ShadowManagerInterfacePrivate> d;
 };
 
@@ -39,6 +59,18 @@ class KWAYLANDSERVER_EXPORT ShadowInterface : public QObject
 public:
     ~ShadowInterface() override;
 
+    enum class Tile {
+        Left,
+        TopLeft,
+        Top,
+        TopRight,
+        Right,
+        BottomRight,
+        Bottom,
+        BottomLeft,
+    };
+    Q_ENUM(Tile)
+
     ClientBuffer *left() const;
     ClientBuffer *topLeft() const;
     ClientBuffer *top() const;
@@ -47,9 +79,34 @@ public:
     ClientBuffer *bottomRight() const;
     ClientBuffer *bottom() const;
     ClientBuffer *bottomLeft() const;
+    ClientBuffer *tile(Tile tile) const;
 
     QMarginsF offset() const;
 
+    /**
+     * Returns a key identifying the content of the given @p tile: tiles with pixel-identical
+     * content have the same key, no matter which client attached them.
+     *
+     * The key is computed from the buffer content the first time it is requested after the
+     * tile was committed. An empty key is returned if the tile is not set or its content cannot
+     * be read, e.g. because it is not a shared memory buffer. While the data of another shared
+     * memory buffer is accessed, an empty key is returned as well, but it is not cached.
+     *
+     * @see ShadowManagerInterface::keyUseCount
+     */
+    QByteArray tileKey(Tile tile) const;
+
+    /**
+     * Returns a key identifying the content of all tiles of this shadow, so that shadows with
+     * identical tiles can share one texture. The offset is not part of the key.
+     *
+     * An empty key is returned if the shadow has no tiles or the key of one of its tiles
+     * is empty.
+     *
+     * @see tileKey
+     */
+    QByteArray contentKey() const;
+
 private:
     explicit ShadowInterface(ShadowManagerInterface *manager, wl_resource *resource);
     friend class ShadowManagerInterfacePrivate;
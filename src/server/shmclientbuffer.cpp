@@ -7,6 +7,10 @@
 #include "shmclientbuffer.h"
 #include "clientbuffer_p.h"
 #include "display.h"
+#include "releasablecache_p.h"
+
+#include <QPointer>
+#include <QSet>
 
 #include <wayland-server-core.h>
 #include <wayland-server-protocol.h>
@@ -16,14 +20,37 @@ namespace KWaylandServer
 static const ShmClientBuffer *s_accessedBuffer = nullptr;
 static int s_accessCounter = 0;
 
+class ShmClientBufferIntegrationPrivate : public ReleasableCache
+{
+public:
+    explicit ShmClientBufferIntegrationPrivate(Display *display);
+
+    static ShmClientBufferIntegrationPrivate *get(ShmClientBufferIntegration *integration)
+    {
+        return integration->d.data();
+    }
+
+    qint64 releaseCache(Display::MemoryPressure pressure) override;
+
+    // the buffers whose contents are kept after the client destroyed them
+    QSet<ShmClientBufferPrivate *> savedBuffers;
+};
+
 class ShmClientBufferPrivate : public ClientBufferPrivate
 {
 public:
     ShmClientBufferPrivate(ShmClientBuffer *q);
+    ~ShmClientBufferPrivate() override;
+
+    static ShmClientBufferPrivate *get(ShmClientBuffer *buffer)
+    {
+        return buffer->d_func();
+    }
 
     static void buffer_destroy_callback(wl_listener *listener, void *data);
 
     ShmClientBuffer *q;
+    QPointer<ShmClientBufferIntegration> integration;
     QImage::Format format = QImage::Format_Invalid;
     uint32_t width = 0;
     uint32_t height = 0;
@@ -37,11 +64,40 @@ public:
     DestroyListener destroyListener;
 };
 
+ShmClientBufferIntegrationPrivate::ShmClientBufferIntegrationPrivate(Display *display)
+    : ReleasableCache(display)
+{
+}
+
+qint64 ShmClientBufferIntegrationPrivate::releaseCache(Display::MemoryPressure pressure)
+{
+    // the compositor may still show the contents of a destroyed buffer, e.g. while a closed
+    // window fades out, so they are only dropped as a last resort
+    if (pressure != Display::MemoryPressure::Critical) {
+        return 0;
+    }
+    qint64 reclaimed = 0;
+    for (ShmClientBufferPrivate *buffer : qAsConst(savedBuffers)) {
+        reclaimed += buffer->savedData.sizeInBytes();
+        // unreferences the shm pool, unless the compositor holds a copy of the image
+        buffer->savedData = QImage();
+    }
+    savedBuffers.clear();
+    return reclaimed;
+}
+
 ShmClientBufferPrivate::ShmClientBufferPrivate(ShmClientBuffer *q)
     : q(q)
 {
 }
 
+ShmClientBufferPrivate::~ShmClientBufferPrivate()
+{
+    if (integration) {
+        ShmClientBufferIntegrationPrivate::get(integration)->savedBuffers.remove(this);
+    }
+}
+
 static void cleanupShmPool(void *poolHandle)
 {
     wl_shm_pool_unref(static_cast<wl_shm_pool *>(poolHandle));
@@ -65,6 +121,9 @@ void ShmClientBufferPrivate::buffer_destroy_callback(wl_listener *listener, void
                                       bufferPrivate->format,
                                       cleanupShmPool,
                                       pool);
+    if (bufferPrivate->integration) {
+        ShmClientBufferIntegrationPrivate::get(bufferPrivate->integration)->savedBuffers.insert(bufferPrivate);
+    }
 }
 
 static bool alphaChannelFromFormat(uint32_t format)
@@ -169,6 +228,7 @@ QImage ShmClientBuffer::data() const
 
 ShmClientBufferIntegration::ShmClientBufferIntegration(Display *display)
     : ClientBufferIntegration(display)
+    , d(new ShmClientBufferIntegrationPrivate(display))
 {
 #if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
     wl_display_add_shm_format(*display, WL_SHM_FORMAT_ARGB2101010);
@@ -179,10 +239,14 @@ ShmClientBufferIntegration::ShmClientBufferIntegration(Display *display)
     wl_display_init_shm(*display);
 }
 
+ShmClientBufferIntegration::~ShmClientBufferIntegration() = default;
+
 ClientBuffer *ShmClientBufferIntegration::createBuffer(::wl_resource *resource)
 {
     if (wl_shm_buffer_get(resource)) {
-        return new ShmClientBuffer(resource);
+        auto buffer = new ShmClientBuffer(resource);
+        ShmClientBufferPrivate::get(buffer)->integration = this;
+        return buffer;
     }
     return nullptr;
 }
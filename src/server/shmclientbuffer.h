@@ -11,6 +11,7 @@
 
 namespace KWaylandServer
 {
+class ShmClientBufferIntegrationPrivate;
 class ShmClientBufferPrivate;
 
 /**
@@ -43,8 +44,13 @@ class ShmClientBufferIntegration : public ClientBufferIntegration
 
 public:
     explicit ShmClientBufferIntegration(Display *display);
+    ~ShmClientBufferIntegration() override;
 
     ClientBuffer *createBuffer(::wl_resource *resource) override;
+
+private:
+    friend class ShmClientBufferIntegrationPrivate;
+    QScopedPointer<ShmClientBufferIntegrationPrivate> d;
 };
 
 } // namespace KWaylandServer
@@ -0,0 +1,127 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#include "singlepixelbufferv1clientbuffer.h"
+#include "clientbuffer_p.h"
+#include "display.h"
+#include "display_p.h"
+
+#include "qwayland-server-single-pixel-buffer-v1.h"
+#include "qwayland-server-wayland.h"
+
+namespace KWaylandServer
+{
+static const int s_version = 1;
+
+class SinglePixelBufferV1ClientBufferIntegrationPrivate : public QtWaylandServer::wp_single_pixel_buffer_manager_v1
+{
+public:
+    SinglePixelBufferV1ClientBufferIntegrationPrivate(SinglePixelBufferV1ClientBufferIntegration *q, Display *display);
+
+    SinglePixelBufferV1ClientBufferIntegration *q;
+
+protected:
+    void wp_single_pixel_buffer_manager_v1_destroy(Resource *resource) override;
+    void wp_single_pixel_buffer_manager_v1_create_u32_rgba_buffer(Resource *resource, uint32_t id, uint32_t r, uint32_t g, uint32_t b, uint32_t a) override;
+};
+
+class SinglePixelBufferV1ClientBufferPrivate : public ClientBufferPrivate, public QtWaylandServer::wl_buffer
+{
+public:
+    QRgba64 color;
+
+protected:
+    void buffer_destroy(Resource *resource) override;
+};
+
+SinglePixelBufferV1ClientBufferIntegrationPrivate::SinglePixelBufferV1ClientBufferIntegrationPrivate(SinglePixelBufferV1ClientBufferIntegration *q,
+                                                                                                     Display *display)
+    : QtWaylandServer::wp_single_pixel_buffer_manager_v1(*display, s_version)
+    , q(q)
+{
+}
+
+void SinglePixelBufferV1ClientBufferIntegrationPrivate::wp_single_pixel_buffer_manager_v1_destroy(Resource *resource)
+{
+    wl_resource_destroy(resource->handle);
+}
+
+static quint16 toColorChannel(uint32_t value)
+{
+    // the channels are sent as the full 32-bit range
+    return value >> 16;
+}
+
+void SinglePixelBufferV1ClientBufferIntegrationPrivate::wp_single_pixel_buffer_manager_v1_create_u32_rgba_buffer(Resource *resource,
+                                                                                                                 uint32_t id,
+                                                                                                                 uint32_t r,
+                                                                                                                 uint32_t g,
+                                                                                                                 uint32_t b,
+                                                                                                                 uint32_t a)
+{
+    wl_resource *bufferResource = wl_resource_create(resource->client(), &wl_buffer_interface, 1, id);
+    if (!bufferResource) {
+        wl_resource_post_no_memory(resource->handle);
+        return;
+    }
+
+    const QRgba64 color = QRgba64::fromRgba64(toColorChannel(r), toColorChannel(g), toColorChannel(b), toColorChannel(a));
+    auto clientBuffer = new SinglePixelBufferV1ClientBuffer(color);
+    clientBuffer->initialize(bufferResource);
+
+    DisplayPrivate *displayPrivate = DisplayPrivate::get(q->display());
+    displayPrivate->registerClientBuffer(clientBuffer);
+}
+
+void SinglePixelBufferV1ClientBufferPrivate::buffer_destroy(Resource *resource)
+{
+    wl_resource_destroy(resource->handle);
+}
+
+SinglePixelBufferV1ClientBuffer::SinglePixelBufferV1ClientBuffer(const QRgba64 &color)
+    : ClientBuffer(*new SinglePixelBufferV1ClientBufferPrivate)
+{
+    Q_D(SinglePixelBufferV1ClientBuffer);
+    d->color = color;
+}
+
+void SinglePixelBufferV1ClientBuffer::initialize(wl_resource *resource)
+{
+    Q_D(SinglePixelBufferV1ClientBuffer);
+    d->init(resource);
+    ClientBuffer::initialize(resource);
+}
+
+QRgba64 SinglePixelBufferV1ClientBuffer::color() const
+{
+    Q_D(const SinglePixelBufferV1ClientBuffer);
+    return d->color;
+}
+
+QSize SinglePixelBufferV1ClientBuffer::size() const
+{
+    return QSize(1, 1);
+}
+
+bool SinglePixelBufferV1ClientBuffer::hasAlphaChannel() const
+{
+    Q_D(const SinglePixelBufferV1ClientBuffer);
+    return !d->color.isOpaque();
+}
+
+ClientBuffer::Origin SinglePixelBufferV1ClientBuffer::origin() const
+{
+    return Origin::TopLeft;
+}
+
+SinglePixelBufferV1ClientBufferIntegration::SinglePixelBufferV1ClientBufferIntegration(Display *display)
+    : ClientBufferIntegration(display)
+    , d(new SinglePixelBufferV1ClientBufferIntegrationPrivate(this, display))
+{
+}
+
+SinglePixelBufferV1ClientBufferIntegration::~SinglePixelBufferV1ClientBufferIntegration()
+{
+}
+
+} // namespace KWaylandServer
@@ -0,0 +1,64 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#pragma once
+
+#include "clientbuffer.h"
+#include "clientbufferintegration.h"
+
+#include <QRgba64>
+
+namespace KWaylandServer
+{
+class SinglePixelBufferV1ClientBufferPrivate;
+class SinglePixelBufferV1ClientBufferIntegrationPrivate;
+
+/**
+ * The SinglePixelBufferV1ClientBuffer class represents a buffer that consists of a single
+ * pixel with a solid color.
+ *
+ * Such buffers are usually scaled to the size of the surface with a viewport, the compositor
+ * can draw them as a solid fill without uploading any texture.
+ */
+class KWAYLANDSERVER_EXPORT SinglePixelBufferV1ClientBuffer : public ClientBuffer
+{
+    Q_OBJECT
+    Q_DECLARE_PRIVATE(SinglePixelBufferV1ClientBuffer)
+
+public:
+    /**
+     * Returns the color of the pixel. The color channels are premultiplied by the alpha
+     * channel.
+     */
+    QRgba64 color() const;
+
+    QSize size() const override;
+    bool hasAlphaChannel() const override;
+    Origin origin() const override;
+
+private:
+    explicit SinglePixelBufferV1ClientBuffer(const QRgba64 &color);
+    void initialize(wl_resource *resource);
+    friend class SinglePixelBufferV1ClientBufferIntegrationPrivate;
+};
+
+/**
+ * The SinglePixelBufferV1ClientBufferIntegration class provides support for single pixel
+ * buffers.
+ *
+ * SinglePixelBufferV1ClientBufferIntegration corresponds to the Wayland interface
+ * @c wp_single_pixel_buffer_manager_v1.
+ */
+class KWAYLANDSERVER_EXPORT SinglePixelBufferV1ClientBufferIntegration : public ClientBufferIntegration
+{
+    Q_OBJECT
+
+public:
+    explicit SinglePixelBufferV1ClientBufferIntegration(Display *display);
+    ~SinglePixelBufferV1ClientBufferIntegration() override;
+
+private:
+    QScopedPointer<SinglePixelBufferV1ClientBufferIntegrationPrivate> d;
+};
+
+} // namespace KWaylandServer
@@ -178,6 +178,9 @@ void SubSurfaceInterfacePrivate::parentCommit()
     if (hasPendingPosition) {
         hasPendingPosition = false;
         position = pendingPosition;
+        if (parent) {
+            SurfaceInterfacePrivate::get(parent)->invalidatePaintList();
+        }
         Q_EMIT q->positionChanged(position);
     }
 
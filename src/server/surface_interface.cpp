@@ -18,6 +18,8 @@
 #include "surface_interface_p.h"
 #include "surfacerole_p.h"
 #include "utils.h"
+// Wayland
+#include <wayland-presentation-time-server-protocol.h>
 // std
 #include <algorithm>
 
@@ -29,6 +31,9 @@ SurfaceInterfacePrivate::SurfaceInterfacePrivate(SurfaceInterface *q)
     wl_list_init(&current.frameCallbacks);
     wl_list_init(&pending.frameCallbacks);
     wl_list_init(&cached.frameCallbacks);
+    wl_list_init(&current.presentationFeedbacks);
+    wl_list_init(&pending.presentationFeedbacks);
+    wl_list_init(&cached.presentationFeedbacks);
 }
 
 SurfaceInterfacePrivate::~SurfaceInterfacePrivate()
@@ -49,6 +54,10 @@ SurfaceInterfacePrivate::~SurfaceInterfacePrivate()
         wl_resource_destroy(resource);
     }
 
+    discardPresentationFeedbacks(&current.presentationFeedbacks);
+    discardPresentationFeedbacks(&pending.presentationFeedbacks);
+    discardPresentationFeedbacks(&cached.presentationFeedbacks);
+
     if (current.buffer) {
         current.buffer->unref();
     }
@@ -61,6 +70,7 @@ void SurfaceInterfacePrivate::addChild(SubSurfaceInterface *child)
     cached.above.append(child);
     current.above.append(child);
     child->surface()->setOutputs(outputs);
+    invalidatePaintList();
     Q_EMIT q->childSubSurfaceAdded(child);
     Q_EMIT q->childSubSurfacesChanged();
 }
@@ -74,6 +84,7 @@ void SurfaceInterfacePrivate::removeChild(SubSurfaceInterface *child)
     cached.above.removeAll(child);
     current.below.removeAll(child);
     current.above.removeAll(child);
+    invalidatePaintList();
     Q_EMIT q->childSubSurfaceRemoved(child);
     Q_EMIT q->childSubSurfacesChanged();
 }
@@ -101,7 +112,7 @@ bool SurfaceInterfacePrivate::raiseChild(SubSurfaceInterface *subsurface, Surfac
     }
 
     anchorList->insert(anchorIndex + 1, subsurface);
-    pending.childrenChanged = true;
+    pending.committed |= SurfaceState::Children;
     return true;
 }
 
@@ -128,32 +139,32 @@ bool SurfaceInterfacePrivate::lowerChild(SubSurfaceInterface *subsurface, Surfac
     }
 
     anchorList->insert(anchorIndex, subsurface);
-    pending.childrenChanged = true;
+    pending.committed |= SurfaceState::Children;
     return true;
 }
 
 void SurfaceInterfacePrivate::setShadow(const QPointer<ShadowInterface> &shadow)
 {
-    pending.shadow = shadow;
-    pending.shadowIsSet = true;
+    pending.extensions().shadow = shadow;
+    pending.committed |= SurfaceState::Shadow;
 }
 
 void SurfaceInterfacePrivate::setBlur(const QPointer<BlurInterface> &blur)
 {
-    pending.blur = blur;
-    pending.blurIsSet = true;
+    pending.extensions().blur = blur;
+    pending.committed |= SurfaceState::Blur;
 }
 
 void SurfaceInterfacePrivate::setSlide(const QPointer<SlideInterface> &slide)
 {
-    pending.slide = slide;
-    pending.slideIsSet = true;
+    pending.extensions().slide = slide;
+    pending.committed |= SurfaceState::Slide;
 }
 
 void SurfaceInterfacePrivate::setContrast(const QPointer<ContrastInterface> &contrast)
 {
-    pending.contrast = contrast;
-    pending.contrastIsSet = true;
+    pending.extensions().contrast = contrast;
+    pending.committed |= SurfaceState::Contrast;
 }
 
 void SurfaceInterfacePrivate::installPointerConstraint(LockedPointerV1Interface *lock)
@@ -240,25 +251,26 @@ void SurfaceInterfacePrivate::surface_destroy(Resource *resource)
 void SurfaceInterfacePrivate::surface_attach(Resource *resource, struct ::wl_resource *buffer, int32_t x, int32_t y)
 {
     Q_UNUSED(resource)
-    pending.bufferIsSet = true;
+    pending.committed |= SurfaceState::Buffer;
     pending.offset = QPoint(x, y);
     if (!buffer) {
         // got a null buffer, deletes content in next frame
         pending.buffer = nullptr;
-        pending.damage = QRegion();
-        pending.bufferDamage = QRegion();
+        pending.damage.clear();
+        pending.bufferDamage.clear();
         return;
     }
     pending.buffer = compositor->display()->clientBufferForResource(buffer);
 
     // set default damage to force initial rendering
     auto bufferSize = pending.buffer->size();
-    pending.damage = QRegion(0, 0, bufferSize.width(), bufferSize.height());
+    pending.damage.clear();
+    pending.damage.add(QRect(0, 0, bufferSize.width(), bufferSize.height()));
 }
 
 void SurfaceInterfacePrivate::surface_damage(Resource *, int32_t x, int32_t y, int32_t width, int32_t height)
 {
-    pending.damage |= QRect(x, y, width, height);
+    pending.damage.add(QRect(x, y, width, height));
 }
 
 void SurfaceInterfacePrivate::surface_frame(Resource *resource, uint32_t callback)
@@ -284,7 +296,7 @@ void SurfaceInterfacePrivate::surface_set_opaque_region(Resource *resource, stru
     Q_UNUSED(resource)
     RegionInterface *r = RegionInterface::get(region);
     pending.opaque = r ? r->region() : QRegion();
-    pending.opaqueIsSet = true;
+    pending.committed |= SurfaceState::Opaque;
 }
 
 void SurfaceInterfacePrivate::surface_set_input_region(Resource *resource, struct ::wl_resource *region)
@@ -292,7 +304,7 @@ void SurfaceInterfacePrivate::surface_set_input_region(Resource *resource, struc
     Q_UNUSED(resource)
     RegionInterface *r = RegionInterface::get(region);
     pending.input = r ? r->region() : infiniteRegion();
-    pending.inputIsSet = true;
+    pending.committed |= SurfaceState::Input;
 }
 
 void SurfaceInterfacePrivate::surface_commit(Resource *resource)
@@ -312,7 +324,7 @@ void SurfaceInterfacePrivate::surface_set_buffer_transform(Resource *resource, i
         return;
     }
     pending.bufferTransform = OutputInterface::Transform(transform);
-    pending.bufferTransformIsSet = true;
+    pending.committed |= SurfaceState::BufferTransform;
 }
 
 void SurfaceInterfacePrivate::surface_set_buffer_scale(Resource *resource, int32_t scale)
@@ -322,13 +334,13 @@ void SurfaceInterfacePrivate::surface_set_buffer_scale(Resource *resource, int32
         return;
     }
     pending.bufferScale = scale;
-    pending.bufferScaleIsSet = true;
+    pending.committed |= SurfaceState::BufferScale;
 }
 
 void SurfaceInterfacePrivate::surface_damage_buffer(Resource *resource, int32_t x, int32_t y, int32_t width, int32_t height)
 {
     Q_UNUSED(resource)
-    pending.bufferDamage |= QRect(x, y, width, height);
+    pending.bufferDamage.add(QRect(x, y, width, height));
 }
 
 SurfaceInterface::SurfaceInterface(CompositorInterface *compositor, wl_resource *resource)
@@ -366,27 +378,192 @@ CompositorInterface *SurfaceInterface::compositor() const
 
 void SurfaceInterface::frameRendered(quint32 msec)
 {
-    // notify all callbacks
+    d->frameRendered(msec, d->occlusionThrottleInterval());
+}
+
+std::optional<quint32> SurfaceInterfacePrivate::occlusionThrottleInterval() const
+{
+    // The nearest occluded ancestor decides how the whole subtree is throttled.
+    for (const SurfaceInterfacePrivate *surface = this; surface;) {
+        if (surface->occluded) {
+            return surface->occludedFrameCallbackInterval;
+        }
+        SurfaceInterface *parent = surface->subSurface ? surface->subSurface->parentSurface() : nullptr;
+        surface = parent ? get(parent) : nullptr;
+    }
+    return std::nullopt;
+}
+
+void SurfaceInterfacePrivate::frameRendered(const QVector<SurfaceInterface *> &surfaces, quint32 msec)
+{
+    // The surfaces painted on an output often share subtrees, e.g. a window is listed
+    // together with its sub-surfaces. Every surface is notified only once.
+    QSet<SurfaceInterfacePrivate *> visited;
+    visited.reserve(surfaces.count());
+
+    for (SurfaceInterface *surface : surfaces) {
+        if (!surface) {
+            continue;
+        }
+        SurfaceInterfacePrivate *surfacePrivate = get(surface);
+        if (!visited.contains(surfacePrivate)) {
+            surfacePrivate->frameRendered(msec, surfacePrivate->occlusionThrottleInterval(), &visited);
+        }
+    }
+}
+
+void SurfaceInterfacePrivate::frameRendered(quint32 msec, std::optional<quint32> throttleInterval, QSet<SurfaceInterfacePrivate *> *visited)
+{
+    if (visited) {
+        visited->insert(this);
+    }
+    if (occluded) {
+        throttleInterval = occludedFrameCallbackInterval;
+    }
+
+    if (!wl_list_empty(&current.frameCallbacks)) {
+        bool throttled = false;
+        if (throttleInterval) {
+            if (*throttleInterval == 0) {
+                throttled = true;
+            } else if (lastFrameCallbackTime) {
+                // unsigned arithmetic copes with the wrap around of the timestamp
+                throttled = quint32(msec - *lastFrameCallbackTime) < *throttleInterval;
+            }
+        }
+
+        if (throttled) {
+            // callbacks held back on an earlier frame are still queued, only count the new ones
+            const int pendingCount = wl_list_length(&current.frameCallbacks);
+            if (pendingCount > suppressedPendingFrameCallbacks) {
+                suppressedFrameCallbackCount += pendingCount - suppressedPendingFrameCallbacks;
+            }
+            suppressedPendingFrameCallbacks = pendingCount;
+        } else {
+            // notify all callbacks
+            wl_resource *resource;
+            wl_resource *tmp;
+
+            wl_resource_for_each_safe(resource, tmp, &current.frameCallbacks)
+            {
+                wl_callback_send_done(resource, msec);
+                wl_resource_destroy(resource);
+            }
+            lastFrameCallbackTime = msec;
+            suppressedPendingFrameCallbacks = 0;
+        }
+    }
+
+    for (SubSurfaceInterface *subsurface : qAsConst(current.below)) {
+        SurfaceInterfacePrivate *child = get(subsurface->surface());
+        if (!visited || !visited->contains(child)) {
+            child->frameRendered(msec, throttleInterval, visited);
+        }
+    }
+    for (SubSurfaceInterface *subsurface : qAsConst(current.above)) {
+        SurfaceInterfacePrivate *child = get(subsurface->surface());
+        if (!visited || !visited->contains(child)) {
+            child->frameRendered(msec, throttleInterval, visited);
+        }
+    }
+}
+
+void SurfaceInterface::setOccluded(bool occluded)
+{
+    d->occluded = occluded;
+}
+
+bool SurfaceInterface::isOccluded() const
+{
+    return d->occlusionThrottleInterval().has_value();
+}
+
+void SurfaceInterface::setOccludedFrameCallbackInterval(quint32 msec)
+{
+    d->occludedFrameCallbackInterval = msec;
+}
+
+quint32 SurfaceInterface::occludedFrameCallbackInterval() const
+{
+    return d->occludedFrameCallbackInterval;
+}
+
+quint64 SurfaceInterface::suppressedFrameCallbackCount() const
+{
+    return d->suppressedFrameCallbackCount;
+}
+
+bool SurfaceInterface::hasFrameCallbacks() const
+{
+    return !wl_list_empty(&d->current.frameCallbacks);
+}
+
+void SurfaceInterfacePrivate::discardPresentationFeedbacks(wl_list *feedbacks)
+{
     wl_resource *resource;
     wl_resource *tmp;
 
-    wl_resource_for_each_safe(resource, tmp, &d->current.frameCallbacks)
+    wl_resource_for_each_safe(resource, tmp, feedbacks)
     {
-        wl_callback_send_done(resource, msec);
+        wp_presentation_feedback_send_discarded(resource);
+        wl_resource_destroy(resource);
+    }
+}
+
+void SurfaceInterface::presented(OutputInterface *output,
+                                 std::chrono::nanoseconds timestamp,
+                                 std::chrono::nanoseconds refresh,
+                                 quint64 sequence,
+                                 PresentationKinds kinds)
+{
+    const std::chrono::seconds seconds = std::chrono::duration_cast<std::chrono::seconds>(timestamp);
+    const std::chrono::nanoseconds nanoseconds = timestamp - seconds;
+    const quint64 tvSec = seconds.count();
+
+    const QVector<wl_resource *> outputResources = output ? output->clientResources(client()) : QVector<wl_resource *>();
+
+    wl_resource *resource;
+    wl_resource *tmp;
+
+    wl_resource_for_each_safe(resource, tmp, &d->current.presentationFeedbacks)
+    {
+        for (wl_resource *outputResource : outputResources) {
+            wp_presentation_feedback_send_sync_output(resource, outputResource);
+        }
+        wp_presentation_feedback_send_presented(resource,
+                                                tvSec >> 32,
+                                                tvSec & 0xffffffff,
+                                                nanoseconds.count(),
+                                                refresh.count(),
+                                                sequence >> 32,
+                                                sequence & 0xffffffff,
+                                                uint32_t(kinds));
         wl_resource_destroy(resource);
     }
 
     for (SubSurfaceInterface *subsurface : qAsConst(d->current.below)) {
-        subsurface->surface()->frameRendered(msec);
+        subsurface->surface()->presented(output, timestamp, refresh, sequence, kinds);
     }
     for (SubSurfaceInterface *subsurface : qAsConst(d->current.above)) {
-        subsurface->surface()->frameRendered(msec);
+        subsurface->surface()->presented(output, timestamp, refresh, sequence, kinds);
     }
 }
 
-bool SurfaceInterface::hasFrameCallbacks() const
+void SurfaceInterface::discardPresentationFeedback()
 {
-    return !wl_list_empty(&d->current.frameCallbacks);
+    d->discardPresentationFeedbacks(&d->current.presentationFeedbacks);
+
+    for (SubSurfaceInterface *subsurface : qAsConst(d->current.below)) {
+        subsurface->surface()->discardPresentationFeedback();
+    }
+    for (SubSurfaceInterface *subsurface : qAsConst(d->current.above)) {
+        subsurface->surface()->discardPresentationFeedback();
+    }
+}
+
+bool SurfaceInterface::hasPresentationFeedback() const
+{
+    return !wl_list_empty(&d->current.presentationFeedbacks);
 }
 
 QMatrix4x4 SurfaceInterfacePrivate::buildSurfaceToBufferMatrix()
@@ -401,23 +578,27 @@ QMatrix4x4 SurfaceInterfacePrivate::buildSurfaceToBufferMatrix()
 
     surfaceToBufferMatrix.scale(current.bufferScale, current.bufferScale);
 
+    // Don't round, buffers whose size is not a multiple of the scale would be shifted otherwise.
+    const qreal bufferWidth = bufferSize.width() / qreal(current.bufferScale);
+    const qreal bufferHeight = bufferSize.height() / qreal(current.bufferScale);
+
     switch (current.bufferTransform) {
     case OutputInterface::Transform::Normal:
     case OutputInterface::Transform::Flipped:
         break;
     case OutputInterface::Transform::Rotated90:
     case OutputInterface::Transform::Flipped90:
-        surfaceToBufferMatrix.translate(0, bufferSize.height() / current.bufferScale);
+        surfaceToBufferMatrix.translate(0, bufferHeight);
         surfaceToBufferMatrix.rotate(-90, 0, 0, 1);
         break;
     case OutputInterface::Transform::Rotated180:
     case OutputInterface::Transform::Flipped180:
-        surfaceToBufferMatrix.translate(bufferSize.width() / current.bufferScale, bufferSize.height() / current.bufferScale);
+        surfaceToBufferMatrix.translate(bufferWidth, bufferHeight);
         surfaceToBufferMatrix.rotate(-180, 0, 0, 1);
         break;
     case OutputInterface::Transform::Rotated270:
     case OutputInterface::Transform::Flipped270:
-        surfaceToBufferMatrix.translate(bufferSize.width() / current.bufferScale, 0);
+        surfaceToBufferMatrix.translate(bufferWidth, 0);
         surfaceToBufferMatrix.rotate(-270, 0, 0, 1);
         break;
     }
@@ -425,27 +606,38 @@ QMatrix4x4 SurfaceInterfacePrivate::buildSurfaceToBufferMatrix()
     switch (current.bufferTransform) {
     case OutputInterface::Transform::Flipped:
     case OutputInterface::Transform::Flipped180:
-        surfaceToBufferMatrix.translate(bufferSize.width() / current.bufferScale, 0);
+        surfaceToBufferMatrix.translate(bufferWidth, 0);
         surfaceToBufferMatrix.scale(-1, 1);
         break;
     case OutputInterface::Transform::Flipped90:
     case OutputInterface::Transform::Flipped270:
-        surfaceToBufferMatrix.translate(bufferSize.height() / current.bufferScale, 0);
+        surfaceToBufferMatrix.translate(bufferHeight, 0);
         surfaceToBufferMatrix.scale(-1, 1);
         break;
     default:
         break;
     }
 
-    if (current.viewport.sourceGeometry.isValid()) {
-        surfaceToBufferMatrix.translate(current.viewport.sourceGeometry.x(), current.viewport.sourceGeometry.y());
+    const QRectF sourceGeometry = current.viewportSourceGeometry();
+    if (sourceGeometry.isValid()) {
+        surfaceToBufferMatrix.translate(sourceGeometry.x(), sourceGeometry.y());
     }
 
     QSizeF sourceSize;
-    if (current.viewport.sourceGeometry.isValid()) {
-        sourceSize = current.viewport.sourceGeometry.size();
+    if (sourceGeometry.isValid()) {
+        sourceSize = sourceGeometry.size();
     } else {
-        sourceSize = implicitSurfaceSize;
+        switch (current.bufferTransform) {
+        case OutputInterface::Transform::Rotated90:
+        case OutputInterface::Transform::Rotated270:
+        case OutputInterface::Transform::Flipped90:
+        case OutputInterface::Transform::Flipped270:
+            sourceSize = QSizeF(bufferHeight, bufferWidth);
+            break;
+        default:
+            sourceSize = QSizeF(bufferWidth, bufferHeight);
+            break;
+        }
     }
 
     if (sourceSize != surfaceSize) {
@@ -455,80 +647,105 @@ QMatrix4x4 SurfaceInterfacePrivate::buildSurfaceToBufferMatrix()
     return surfaceToBufferMatrix;
 }
 
+SurfaceState::Extensions &SurfaceState::extensions()
+{
+    if (!extensionState) {
+        extensionState = std::make_unique<Extensions>();
+    }
+    return *extensionState;
+}
+
+QRectF SurfaceState::viewportSourceGeometry() const
+{
+    return extensionState ? extensionState->viewportSourceGeometry : QRectF();
+}
+
+QSize SurfaceState::viewportDestinationSize() const
+{
+    return extensionState ? extensionState->viewportDestinationSize : QSize();
+}
+
 void SurfaceState::mergeInto(SurfaceState *target)
 {
-    if (bufferIsSet) {
+    // Only the committed fields are handed over; regions are swapped rather than copied.
+    if (committed & Buffer) {
         target->buffer = buffer;
         target->offset = offset;
-        target->damage = damage;
-        target->bufferDamage = bufferDamage;
-        target->bufferIsSet = bufferIsSet;
+        std::swap(target->damage, damage);
+        std::swap(target->bufferDamage, bufferDamage);
+        buffer.clear();
     }
-    if (viewport.sourceGeometryIsSet) {
-        target->viewport.sourceGeometry = viewport.sourceGeometry;
-        target->viewport.sourceGeometryIsSet = true;
-    }
-    if (viewport.destinationSizeIsSet) {
-        target->viewport.destinationSize = viewport.destinationSize;
-        target->viewport.destinationSizeIsSet = true;
-    }
-    if (childrenChanged) {
+    if (committed & Children) {
         target->below = below;
         target->above = above;
-        target->childrenChanged = true;
-    }
-    wl_list_insert_list(&target->frameCallbacks, &frameCallbacks);
-
-    if (shadowIsSet) {
-        target->shadow = shadow;
-        target->shadowIsSet = true;
-    }
-    if (blurIsSet) {
-        target->blur = blur;
-        target->blurIsSet = true;
-    }
-    if (contrastIsSet) {
-        target->contrast = contrast;
-        target->contrastIsSet = true;
     }
-    if (slideIsSet) {
-        target->slide = slide;
-        target->slideIsSet = true;
+    if (committed & Input) {
+        std::swap(target->input, input);
+        input = infiniteRegion();
     }
-    if (inputIsSet) {
-        target->input = input;
-        target->inputIsSet = true;
+    if (committed & Opaque) {
+        std::swap(target->opaque, opaque);
+        opaque = QRegion();
     }
-    if (opaqueIsSet) {
-        target->opaque = opaque;
-        target->opaqueIsSet = true;
-    }
-    if (bufferScaleIsSet) {
+    if (committed & BufferScale) {
         target->bufferScale = bufferScale;
-        target->bufferScaleIsSet = true;
     }
-    if (bufferTransformIsSet) {
+    if (committed & BufferTransform) {
         target->bufferTransform = bufferTransform;
-        target->bufferTransformIsSet = true;
     }
+    if (committed & (Shadow | Blur | Contrast | Slide | ViewportSource | ViewportDestination)) {
+        Extensions &targetExtensions = target->extensions();
+        if (committed & Shadow) {
+            targetExtensions.shadow = extensionState->shadow;
+        }
+        if (committed & Blur) {
+            targetExtensions.blur = extensionState->blur;
+        }
+        if (committed & Contrast) {
+            targetExtensions.contrast = extensionState->contrast;
+        }
+        if (committed & Slide) {
+            targetExtensions.slide = extensionState->slide;
+        }
+        if (committed & ViewportSource) {
+            targetExtensions.viewportSourceGeometry = extensionState->viewportSourceGeometry;
+        }
+        if (committed & ViewportDestination) {
+            targetExtensions.viewportDestinationSize = extensionState->viewportDestinationSize;
+        }
+        *extensionState = Extensions();
+    }
+    wl_list_insert_list(&target->frameCallbacks, &frameCallbacks);
+    wl_list_init(&frameCallbacks);
+
+    // A new content update supersedes the one the target state's feedback was asked for.
+    if ((committed & Buffer) || !wl_list_empty(&presentationFeedbacks)) {
+        SurfaceInterfacePrivate::discardPresentationFeedbacks(&target->presentationFeedbacks);
+    }
+    wl_list_insert_list(&target->presentationFeedbacks, &presentationFeedbacks);
+    wl_list_init(&presentationFeedbacks);
+
+    target->committed |= committed;
+    committed = None;
 
-    *this = SurfaceState{};
+    // damage without a new buffer is dropped
+    damage.clear();
+    bufferDamage.clear();
     below = target->below;
     above = target->above;
-    wl_list_init(&frameCallbacks);
 }
 
 void SurfaceInterfacePrivate::applyState(SurfaceState *next)
 {
-    const bool bufferChanged = next->bufferIsSet;
-    const bool opaqueRegionChanged = next->opaqueIsSet;
-    const bool scaleFactorChanged = next->bufferScaleIsSet && (current.bufferScale != next->bufferScale);
-    const bool transformChanged = next->bufferTransformIsSet && (current.bufferTransform != next->bufferTransform);
-    const bool shadowChanged = next->shadowIsSet;
-    const bool blurChanged = next->blurIsSet;
-    const bool contrastChanged = next->contrastIsSet;
-    const bool slideChanged = next->slideIsSet;
-    const bool childrenChanged = next->childrenChanged;
+    const bool bufferChanged = next->committed & SurfaceState::Buffer;
+    const bool opaqueRegionChanged = next->committed & SurfaceState::Opaque;
+    const bool scaleFactorChanged = (next->committed & SurfaceState::BufferScale) && (current.bufferScale != next->bufferScale);
+    const bool transformChanged = (next->committed & SurfaceState::BufferTransform) && (current.bufferTransform != next->bufferTransform);
+    const bool shadowChanged = next->committed & SurfaceState::Shadow;
+    const bool blurChanged = next->committed & SurfaceState::Blur;
+    const bool contrastChanged = next->committed & SurfaceState::Contrast;
+    const bool slideChanged = next->committed & SurfaceState::Slide;
+    const bool childrenChanged = next->committed & SurfaceState::Children;
     const bool visibilityChanged = bufferChanged && bool(current.buffer) != bool(next->buffer);
 
     const QSize oldSurfaceSize = surfaceSize;
@@ -576,10 +793,12 @@ void SurfaceInterfacePrivate::applyState(SurfaceState *next)
             break;
         }
 
-        if (current.viewport.destinationSize.isValid()) {
-            surfaceSize = current.viewport.destinationSize;
-        } else if (current.viewport.sourceGeometry.isValid()) {
-            surfaceSize = current.viewport.sourceGeometry.size().toSize();
+        const QSize destinationSize = current.viewportDestinationSize();
+        const QRectF sourceGeometry = current.viewportSourceGeometry();
+        if (destinationSize.isValid()) {
+            surfaceSize = destinationSize;
+        } else if (sourceGeometry.isValid()) {
+            surfaceSize = sourceGeometry.size().toSize();
         } else {
             surfaceSize = implicitSurfaceSize;
         }
@@ -609,12 +828,13 @@ void SurfaceInterfacePrivate::applyState(SurfaceState *next)
     }
     if (bufferChanged) {
         if (current.buffer && (!current.damage.isEmpty() || !current.bufferDamage.isEmpty())) {
-            const QRegion windowRegion = QRegion(0, 0, q->size().width(), q->size().height());
-            const QRegion bufferDamage = q->mapFromBuffer(current.bufferDamage);
-            current.damage = windowRegion.intersected(current.damage.united(bufferDamage));
-            Q_EMIT q->damaged(current.damage);
+            current.damage.add(q->mapFromBuffer(current.bufferDamage.region()));
+            current.damage.intersect(QRect(QPoint(0, 0), q->size()));
+            Q_EMIT q->damaged(current.damage.region());
         }
     }
+    recordDamage(bufferChanged ? current.damage.region() : QRegion(), oldSurfaceSize);
+    invalidatePaintList();
     if (surfaceToBufferMatrix != oldSurfaceToBufferMatrix) {
         Q_EMIT q->surfaceToBufferMatrixChanged();
     }
@@ -680,6 +900,56 @@ void SurfaceInterfacePrivate::commitFromCache()
     hasCacheState = false;
 }
 
+void SurfaceInterfacePrivate::recordDamage(const QRegion &damage, const QSize &oldSurfaceSize)
+{
+    QRegion changed = damage;
+    if (surfaceSize != oldSurfaceSize) {
+        // everything that got covered or uncovered by the resize needs to be repainted
+        changed += QRect(QPoint(0, 0), oldSurfaceSize.expandedTo(surfaceSize));
+    }
+    ++commitSequence;
+    damageHistory[commitSequence % DamageHistorySize] = changed;
+}
+
+void SurfaceInterfacePrivate::invalidatePaintList()
+{
+    // the lists of all ancestors embed this one
+    for (SurfaceInterfacePrivate *surface = this; surface && surface->paintListValid;) {
+        surface->paintListValid = false;
+        SurfaceInterface *parent = surface->subSurface ? surface->subSurface->parentSurface() : nullptr;
+        surface = parent ? SurfaceInterfacePrivate::get(parent) : nullptr;
+    }
+}
+
+void SurfaceInterfacePrivate::buildPaintList()
+{
+    paintList.clear();
+    paintListValid = true;
+    if (!mapped) {
+        return;
+    }
+
+    auto appendChildren = [this](const QList<SubSurfaceInterface *> &children) {
+        for (SubSurfaceInterface *subsurface : children) {
+            const QVector<SurfacePaintNode> &childList = subsurface->surface()->paintList();
+            const QPoint position = subsurface->position();
+            for (SurfacePaintNode node : childList) {
+                node.offset += position;
+                paintList.append(node);
+            }
+        }
+    };
+
+    appendChildren(current.below);
+    SurfacePaintNode node;
+    node.surface = q;
+    node.buffer = bufferRef;
+    node.bufferTransform = current.bufferTransform;
+    node.opaque = current.opaque;
+    paintList.append(node);
+    appendChildren(current.above);
+}
+
 bool SurfaceInterfacePrivate::computeEffectiveMapped() const
 {
     return bufferRef && (!subSurface || subSurface->parentSurface()->isMapped());
@@ -693,6 +963,7 @@ void SurfaceInterfacePrivate::updateEffectiveMapped()
     }
 
     mapped = effectiveMapped;
+    invalidatePaintList();
 
     if (mapped) {
         Q_EMIT q->mapped();
@@ -712,7 +983,27 @@ void SurfaceInterfacePrivate::updateEffectiveMapped()
 
 QRegion SurfaceInterface::damage() const
 {
-    return d->current.damage;
+    return d->current.damage.region();
+}
+
+quint64 SurfaceInterface::commitSequence() const
+{
+    return d->commitSequence;
+}
+
+QRegion SurfaceInterface::damageSince(quint64 sequence) const
+{
+    if (sequence >= d->commitSequence) {
+        return QRegion();
+    }
+    if (d->commitSequence - sequence > SurfaceInterfacePrivate::DamageHistorySize) {
+        return QRect(QPoint(0, 0), d->surfaceSize);
+    }
+    RegionBuilder builder;
+    for (quint64 i = sequence + 1; i <= d->commitSequence; ++i) {
+        builder.add(d->damageHistory[i % SurfaceInterfacePrivate::DamageHistorySize]);
+    }
+    return builder.region();
 }
 
 QRegion SurfaceInterface::opaque() const
@@ -761,6 +1052,14 @@ SurfaceInterface *SurfaceInterface::get(quint32 id, const ClientConnection *clie
     return nullptr;
 }
 
+const QVector<SurfacePaintNode> &SurfaceInterface::paintList() const
+{
+    if (!d->paintListValid) {
+        d->buildPaintList();
+    }
+    return d->paintList;
+}
+
 QList<SubSurfaceInterface *> SurfaceInterface::below() const
 {
     return d->current.below;
@@ -799,22 +1098,22 @@ QRect SurfaceInterface::boundingRect() const
 
 QPointer<ShadowInterface> SurfaceInterface::shadow() const
 {
-    return d->current.shadow;
+    return d->current.extensionState ? d->current.extensionState->shadow : QPointer<ShadowInterface>();
 }
 
 QPointer<BlurInterface> SurfaceInterface::blur() const
 {
-    return d->current.blur;
+    return d->current.extensionState ? d->current.extensionState->blur : QPointer<BlurInterface>();
 }
 
 QPointer<ContrastInterface> SurfaceInterface::contrast() const
 {
-    return d->current.contrast;
+    return d->current.extensionState ? d->current.extensionState->contrast : QPointer<ContrastInterface>();
 }
 
 QPointer<SlideInterface> SurfaceInterface::slideOnShowHide() const
 {
-    return d->current.slide;
+    return d->current.extensionState ? d->current.extensionState->slide : QPointer<SlideInterface>();
 }
 
 bool SurfaceInterface::isMapped() const
@@ -969,23 +1268,14 @@ QPointF SurfaceInterface::mapFromBuffer(const QPointF &point) const
     return d->bufferToSurfaceMatrix.map(point);
 }
 
-static QRegion map_helper(const QMatrix4x4 &matrix, const QRegion &region)
-{
-    QRegion result;
-    for (const QRect &rect : region) {
-        result += matrix.mapRect(rect);
-    }
-    return result;
-}
-
 QRegion SurfaceInterface::mapToBuffer(const QRegion &region) const
 {
-    return map_helper(d->surfaceToBufferMatrix, region);
+    return RegionBuilder::map(d->surfaceToBufferMatrix, region);
 }
 
 QRegion SurfaceInterface::mapFromBuffer(const QRegion &region) const
 {
-    return map_helper(d->bufferToSurfaceMatrix, region);
+    return RegionBuilder::map(d->bufferToSurfaceMatrix, region);
 }
 
 QMatrix4x4 SurfaceInterface::surfaceToBufferMatrix() const
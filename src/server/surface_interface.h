@@ -12,6 +12,9 @@
 #include <QObject>
 #include <QPointer>
 #include <QRegion>
+#include <QVector>
+
+#include <chrono>
 
 #include <DWayland/Server/kwaylandserver_export.h>
 
@@ -26,9 +29,30 @@ class LockedPointerV1Interface;
 class ShadowInterface;
 class SlideInterface;
 class SubSurfaceInterface;
+class SurfaceInterface;
 class SurfaceInterfacePrivate;
 class LinuxDmaBufV1Feedback;
 
+/**
+ * The SurfacePaintNode describes one mapped surface of a surface tree the way it needs
+ * to be painted.
+ *
+ * @see SurfaceInterface::paintList
+ */
+struct KWAYLANDSERVER_EXPORT SurfacePaintNode {
+    SurfaceInterface *surface = nullptr;
+    /**
+     * The position of the surface relative to the root surface of the tree.
+     */
+    QPoint offset;
+    ClientBuffer *buffer = nullptr;
+    OutputInterface::Transform bufferTransform = OutputInterface::Transform::Normal;
+    /**
+     * The opaque region in surface-local coordinates.
+     */
+    QRegion opaque;
+};
+
 /**
  * @brief Resource representing a wl_surface.
  *
@@ -74,6 +98,29 @@ class KWAYLANDSERVER_EXPORT SurfaceInterface : public QObject
     Q_PROPERTY(KWaylandServer::OutputInterface::Transform bufferTransform READ bufferTransform NOTIFY bufferTransformChanged)
     Q_PROPERTY(QSize size READ size NOTIFY sizeChanged)
 public:
+    /**
+     * Describes how a content update has been presented, see presented().
+     */
+    enum class PresentationKind {
+        /**
+         * The presentation was synchronized to the vertical retrace of the output.
+         */
+        VSync = 0x1,
+        /**
+         * The timestamp comes from a hardware clock rather than being sampled in software.
+         */
+        HwClock = 0x2,
+        /**
+         * The hardware signalled the completion of the presentation.
+         */
+        HwCompletion = 0x4,
+        /**
+         * The client buffer was scanned out directly, without compositing.
+         */
+        ZeroCopy = 0x8,
+    };
+    Q_DECLARE_FLAGS(PresentationKinds, PresentationKind)
+
     explicit SurfaceInterface(CompositorInterface *compositor, wl_resource *resource);
     ~SurfaceInterface() override;
 
@@ -157,10 +204,95 @@ public:
      */
     QPointF mapToChild(SurfaceInterface *child, const QPointF &point) const;
 
+    /**
+     * Notifies the frame callbacks of this surface and all its sub-surfaces that a frame has
+     * been rendered at @p msec.
+     *
+     * Surfaces that are occluded only get their callbacks notified at the throttled rate set
+     * with setOccludedFrameCallbackInterval().
+     *
+     * @see setOccluded()
+     */
     void frameRendered(quint32 msec);
     bool hasFrameCallbacks() const;
 
+    /**
+     * Marks this surface and its sub-surfaces as occluded, e.g. because the window is
+     * minimized or fully covered by other windows.
+     *
+     * While occluded, frameRendered() throttles the frame callbacks of the surface tree so
+     * that the client does not keep rendering at the full refresh rate.
+     *
+     * @see isOccluded(), setOccludedFrameCallbackInterval()
+     */
+    void setOccluded(bool occluded);
+    /**
+     * Returns @c true if this surface or any of its ancestors is marked as occluded.
+     */
+    bool isOccluded() const;
+    /**
+     * Sets the minimum time in milliseconds between two frame callback notifications while
+     * the surface is occluded. With an interval of @c 0 the frame callbacks are held back
+     * until the surface is no longer occluded. The default is 1000.
+     *
+     * The interval of the nearest occluded surface applies to its whole sub-surface tree.
+     */
+    void setOccludedFrameCallbackInterval(quint32 msec);
+    quint32 occludedFrameCallbackInterval() const;
+    /**
+     * Returns how many frame callbacks of this surface have been held back by
+     * frameRendered() because the surface was occluded. A callback that stays held back
+     * over several frames is counted once.
+     */
+    quint64 suppressedFrameCallbackCount() const;
+
+    /**
+     * Reports to the client that the current content of this surface and of all its
+     * sub-surfaces has been shown on the @p output.
+     *
+     * The @p timestamp is the time when the content turned into light, measured with the clock
+     * announced by the PresentationTimeInterface. The @p refresh is the duration of one refresh
+     * cycle of the @p output, or zero if it is not known. The @p sequence is the vertical retrace
+     * counter of the @p output, if there is one.
+     *
+     * Every pending presentation feedback request is consumed by this call.
+     *
+     * @see discardPresentationFeedback(), hasPresentationFeedback()
+     */
+    void presented(OutputInterface *output, std::chrono::nanoseconds timestamp, std::chrono::nanoseconds refresh, quint64 sequence, PresentationKinds kinds);
+    /**
+     * Reports to the client that the current content of this surface and of all its
+     * sub-surfaces will never be shown, e.g. because the surface is hidden.
+     *
+     * Content updates that get superseded by a later commit are discarded automatically.
+     */
+    void discardPresentationFeedback();
+    /**
+     * Returns @c true if the client asked for presentation feedback on the current content
+     * of this surface.
+     */
+    bool hasPresentationFeedback() const;
+
     QRegion damage() const;
+    /**
+     * Returns the sequence number of the last commit applied to this surface. The number
+     * starts at zero and is incremented with every applied commit.
+     *
+     * @see damageSince
+     */
+    quint64 commitSequence() const;
+    /**
+     * Returns the region of this surface, in surface-local coordinates, that changed in the
+     * commits applied after the commit with the given @p sequence number.
+     *
+     * A compositor using buffer age can remember the commitSequence() that a back buffer was
+     * last painted with and only repaint the returned region when the buffer is reused.
+     * Only a limited number of commits is remembered; if @p sequence is older than that,
+     * the whole surface is returned.
+     *
+     * @see commitSequence
+     */
+    QRegion damageSince(quint64 sequence) const;
     QRegion opaque() const;
     QRegion input() const;
     qint32 bufferScale() const;
@@ -197,6 +329,16 @@ public:
      */
     QSize bufferSize() const;
 
+    /**
+     * Returns the mapped surfaces of the tree rooted at this surface, sorted from bottom to
+     * top, in the order they need to be painted. This surface is included if it is mapped.
+     *
+     * The list is cached and only rebuilt when a commit or a sub-surface change touched the
+     * tree, so it is cheap to call it every frame. The returned reference is valid until the
+     * next commit of any surface in the tree.
+     */
+    const QVector<SurfacePaintNode> &paintList() const;
+
     /**
      * @returns The SubSurface for this Surface in case there is one.
      */
@@ -420,4 +562,5 @@ private:
 
 }
 
+Q_DECLARE_OPERATORS_FOR_FLAGS(KWaylandServer::SurfaceInterface::PresentationKinds)
 Q_DECLARE_METATYPE(KWaylandServer::SurfaceInterface *)
@@ -6,11 +6,18 @@
 */
 #pragma once
 
+#include "regionbuilder.h"
 #include "surface_interface.h"
 #include "utils.h"
 // Qt
 #include <QHash>
+#include <QPointer>
+#include <QSet>
 #include <QVector>
+// std
+#include <array>
+#include <memory>
+#include <optional>
 // Wayland
 #include "qwayland-server-wayland.h"
 
@@ -21,31 +28,50 @@ class SurfaceRole;
 class ViewportInterface;
 
 struct SurfaceState {
+    enum Field : quint32 {
+        None = 0,
+        Buffer = 1 << 0,
+        Opaque = 1 << 1,
+        Input = 1 << 2,
+        BufferScale = 1 << 3,
+        BufferTransform = 1 << 4,
+        Children = 1 << 5,
+        Shadow = 1 << 6,
+        Blur = 1 << 7,
+        Contrast = 1 << 8,
+        Slide = 1 << 9,
+        ViewportSource = 1 << 10,
+        ViewportDestination = 1 << 11,
+    };
+    Q_DECLARE_FLAGS(Fields, Field)
+
+    // State of rarely used extensions, only allocated once a client uses one of them.
+    struct Extensions {
+        QPointer<ShadowInterface> shadow;
+        QPointer<BlurInterface> blur;
+        QPointer<ContrastInterface> contrast;
+        QPointer<SlideInterface> slide;
+        QRectF viewportSourceGeometry = QRectF();
+        QSize viewportDestinationSize = QSize();
+    };
+
     void mergeInto(SurfaceState *target);
 
-    QRegion damage = QRegion();
-    QRegion bufferDamage = QRegion();
+    Extensions &extensions();
+    QRectF viewportSourceGeometry() const;
+    QSize viewportDestinationSize() const;
+
+    Fields committed = None;
+    RegionBuilder damage = RegionBuilder(RegionBuilder::DamageRectLimit);
+    RegionBuilder bufferDamage = RegionBuilder(RegionBuilder::DamageRectLimit);
     QRegion opaque = QRegion();
     QRegion input = infiniteRegion();
-    bool inputIsSet = false;
-    bool opaqueIsSet = false;
-    bool bufferIsSet = false;
-    bool shadowIsSet = false;
-    bool blurIsSet = false;
-    bool contrastIsSet = false;
-    bool slideIsSet = false;
-    bool childrenChanged = false;
-    bool bufferScaleIsSet = false;
-    bool bufferTransformIsSet = false;
     qint32 bufferScale = 1;
     OutputInterface::Transform bufferTransform = OutputInterface::Transform::Normal;
     wl_list frameCallbacks;
+    wl_list presentationFeedbacks;
     QPoint offset = QPoint();
     QPointer<ClientBuffer> buffer;
-    QPointer<ShadowInterface> shadow;
-    QPointer<BlurInterface> blur;
-    QPointer<ContrastInterface> contrast;
-    QPointer<SlideInterface> slide;
 
     // Subsurfaces are stored in two lists. The below list contains subsurfaces that
     // are below their parent surface; the above list contains subsurfaces that are
@@ -53,12 +79,7 @@ struct SurfaceState {
     QList<SubSurfaceInterface *> below;
     QList<SubSurfaceInterface *> above;
 
-    struct {
-        QRectF sourceGeometry = QRectF();
-        QSize destinationSize = QSize();
-        bool sourceGeometryIsSet = false;
-        bool destinationSizeIsSet = false;
-    } viewport;
+    std::unique_ptr<Extensions> extensionState;
 };
 
 class SurfaceInterfacePrivate : public QtWaylandServer::wl_surface
@@ -91,9 +112,38 @@ public:
     QMatrix4x4 buildSurfaceToBufferMatrix();
     void applyState(SurfaceState *next);
 
+    static void discardPresentationFeedbacks(wl_list *feedbacks);
+    static void frameRendered(const QVector<SurfaceInterface *> &surfaces, quint32 msec);
+    void frameRendered(quint32 msec, std::optional<quint32> throttleInterval, QSet<SurfaceInterfacePrivate *> *visited = nullptr);
+    std::optional<quint32> occlusionThrottleInterval() const;
+
+    void recordDamage(const QRegion &damage, const QSize &oldSurfaceSize);
+
+    void invalidatePaintList();
+    void buildPaintList();
+
     bool computeEffectiveMapped() const;
     void updateEffectiveMapped();
 
+    /**
+     * Returns the extension object of type T attached to the surface, or @c null if there is none.
+     */
+    template<typename T>
+    T *extension() const
+    {
+        return static_cast<T *>(extensions.value(&T::staticMetaObject).data());
+    }
+
+    /**
+     * Attaches the extension @p object to the surface. The extension is detached automatically
+     * when the @p object is destroyed.
+     */
+    template<typename T>
+    void setExtension(T *object)
+    {
+        extensions.insert(&T::staticMetaObject, object);
+    }
+
     CompositorInterface *compositor;
     SurfaceInterface *q;
     SurfaceRole *role = nullptr;
@@ -111,6 +161,21 @@ public:
     bool mapped = false;
     bool hasCacheState = false;
 
+    bool occluded = false;
+    quint32 occludedFrameCallbackInterval = 1000;
+    std::optional<quint32> lastFrameCallbackTime;
+    quint64 suppressedFrameCallbackCount = 0;
+    int suppressedPendingFrameCallbacks = 0;
+
+    // Damage of the last commits, indexed by commit sequence modulo the history size.
+    static constexpr int DamageHistorySize = 8;
+    std::array<QRegion, DamageHistorySize> damageHistory;
+    quint64 commitSequence = 0;
+
+    // Flattened surface tree, valid lists imply valid lists of all sub-surfaces.
+    QVector<SurfacePaintNode> paintList;
+    bool paintListValid = false;
+
     QVector<OutputInterface *> outputs;
 
     LockedPointerV1Interface *lockedPointer = nullptr;
@@ -123,6 +188,9 @@ public:
     QScopedPointer<LinuxDmaBufV1Feedback> dmabufFeedbackV1;
     ClientConnection *client = nullptr;
 
+    // Per-surface objects of protocol extensions, keyed by their type.
+    QHash<const QMetaObject *, QPointer<QObject>> extensions;
+
 protected:
     void surface_destroy_resource(Resource *resource) override;
     void surface_destroy(Resource *resource) override;
@@ -142,3 +210,5 @@ private:
 };
 
 } // namespace KWaylandServer
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(KWaylandServer::SurfaceState::Fields)
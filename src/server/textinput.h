@@ -148,6 +148,24 @@ enum class TextInputChangeCause {
 };
 Q_ENUM_NS(TextInputChangeCause)
 
+/**
+ * Describes how the surrounding text changed between two commits.
+ *
+ * The @c removedLength bytes starting at byte offset @c position of the UTF-8 encoded
+ * previous surrounding text were replaced by the UTF-8 encoded @c inserted text. A delta
+ * without removed and inserted text describes a change of only the cursor or the anchor.
+ */
+struct TextInputSurroundingTextDelta {
+    quint32 position = 0;
+    quint32 removedLength = 0;
+    QByteArray inserted;
+
+    bool isEmpty() const
+    {
+        return removedLength == 0 && inserted.isEmpty();
+    }
+};
+
 }
 
 Q_DECLARE_METATYPE(KWaylandServer::TextInputContentHint)
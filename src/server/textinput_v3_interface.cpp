@@ -293,14 +293,15 @@ void TextInputV3InterfacePrivate::zwp_text_input_v3_disable(Resource *resource)
     defaultPending();
 }
 
-void TextInputV3InterfacePrivate::zwp_text_input_v3_set_surrounding_text(Resource *resource, const QString &text, int32_t cursor, int32_t anchor)
+void TextInputV3InterfacePrivate::zwp_text_input_v3_set_surrounding_text(Resource *resource, QtWaylandServer::Utf8StringView text, int32_t cursor, int32_t anchor)
 {
     Q_UNUSED(resource)
     // zwp_text_input_v3_set_surrounding_text is no-op if enabled request is not pending
     if (!pending.enabled) {
         return;
     }
-    pending.surroundingText = text;
+    pending.surroundingText = text.toByteArray();
+    pending.surroundingTextSet = true;
     pending.surroundingTextCursorPosition = cursor;
     pending.surroundingTextSelectionAnchor = anchor;
 }
@@ -344,6 +345,11 @@ void TextInputV3InterfacePrivate::zwp_text_input_v3_commit(Resource *resource)
     auto &resourceEnabled = enabled[resource];
     if (resourceEnabled != pending.enabled) {
         resourceEnabled = pending.enabled;
+        if (!resourceEnabled) {
+            // the first delta after enabling the text input again covers the whole text
+            reportedSurroundingTextUtf8 = QByteArray();
+            surroundingTextChangedSinceReport = true;
+        }
     }
 
     if (surroundingTextChangeCause != pending.surroundingTextChangeCause) {
@@ -366,12 +372,20 @@ void TextInputV3InterfacePrivate::zwp_text_input_v3_commit(Resource *resource)
         }
     }
 
-    if (surroundingText != pending.surroundingText || surroundingTextCursorPosition != pending.surroundingTextCursorPosition
+    // the text is only compared if the client sent it again since the last commit
+    const bool surroundingTextTextChanged = pending.surroundingTextSet && surroundingTextUtf8 != pending.surroundingText;
+    pending.surroundingTextSet = false;
+    if (surroundingTextTextChanged || surroundingTextCursorPosition != pending.surroundingTextCursorPosition
         || surroundingTextSelectionAnchor != pending.surroundingTextSelectionAnchor) {
-        surroundingText = pending.surroundingText;
+        if (surroundingTextTextChanged) {
+            surroundingTextUtf8 = pending.surroundingText;
+            surroundingTextDecoded = false;
+            surroundingTextChangedSinceReport = true;
+        }
         surroundingTextCursorPosition = pending.surroundingTextCursorPosition;
         surroundingTextSelectionAnchor = pending.surroundingTextSelectionAnchor;
         if (resourceEnabled) {
+            updateSurroundingTextDelta();
             Q_EMIT q->surroundingTextChanged();
         }
     }
@@ -379,6 +393,45 @@ void TextInputV3InterfacePrivate::zwp_text_input_v3_commit(Resource *resource)
     Q_EMIT q->stateCommitted(serialHash[resource]);
 }
 
+void TextInputV3InterfacePrivate::updateSurroundingTextDelta()
+{
+    if (!surroundingTextChangedSinceReport) {
+        surroundingTextDelta = TextInputSurroundingTextDelta();
+        return;
+    }
+    const QByteArray &previous = reportedSurroundingTextUtf8;
+    const QByteArray &utf8 = surroundingTextUtf8;
+    const auto isContinuationByte = [](const QByteArray &data, int index) {
+        return index < data.size() && (uchar(data.at(index)) & 0xc0) == 0x80;
+    };
+
+    // Find the changed range by skipping the common prefix and suffix, keeping both on
+    // UTF-8 character boundaries so the inserted text is valid UTF-8 on its own.
+    const int maxLength = qMin(previous.size(), utf8.size());
+    int prefix = 0;
+    while (prefix < maxLength && previous.at(prefix) == utf8.at(prefix)) {
+        ++prefix;
+    }
+    while (prefix > 0 && (isContinuationByte(utf8, prefix) || isContinuationByte(previous, prefix))) {
+        --prefix;
+    }
+
+    int suffix = 0;
+    while (suffix < maxLength - prefix && previous.at(previous.size() - suffix - 1) == utf8.at(utf8.size() - suffix - 1)) {
+        ++suffix;
+    }
+    while (suffix > 0 && isContinuationByte(utf8, utf8.size() - suffix)) {
+        --suffix;
+    }
+
+    surroundingTextDelta.position = prefix;
+    surroundingTextDelta.removedLength = previous.size() - prefix - suffix;
+    surroundingTextDelta.inserted = utf8.mid(prefix, utf8.size() - prefix - suffix);
+
+    reportedSurroundingTextUtf8 = surroundingTextUtf8;
+    surroundingTextChangedSinceReport = false;
+}
+
 void TextInputV3InterfacePrivate::defaultPending()
 {
     pending.cursorRectangle = QRect();
@@ -386,7 +439,8 @@ void TextInputV3InterfacePrivate::defaultPending()
     pending.contentHints = TextInputContentHints(TextInputContentHint::None);
     pending.contentPurpose = TextInputContentPurpose::Normal;
     pending.enabled = false;
-    pending.surroundingText = QString();
+    pending.surroundingText = QByteArray();
+    pending.surroundingTextSet = true;
     pending.surroundingTextCursorPosition = 0;
     pending.surroundingTextSelectionAnchor = 0;
 }
@@ -411,6 +465,10 @@ TextInputContentPurpose TextInputV3Interface::contentPurpose() const
 
 QString TextInputV3Interface::surroundingText() const
 {
+    if (!d->surroundingTextDecoded) {
+        d->surroundingText = QString::fromUtf8(d->surroundingTextUtf8);
+        d->surroundingTextDecoded = true;
+    }
     return d->surroundingText;
 }
 
@@ -424,6 +482,16 @@ qint32 TextInputV3Interface::surroundingTextSelectionAnchor() const
     return d->surroundingTextSelectionAnchor;
 }
 
+QByteArray TextInputV3Interface::surroundingTextUtf8() const
+{
+    return d->surroundingTextUtf8;
+}
+
+TextInputSurroundingTextDelta TextInputV3Interface::surroundingTextDelta() const
+{
+    return d->surroundingTextDelta;
+}
+
 void TextInputV3Interface::deleteSurroundingText(quint32 beforeLength, quint32 afterLength)
 {
     d->deleteSurroundingText(beforeLength, afterLength);
@@ -95,6 +95,25 @@ public:
      */
     qint32 surroundingTextSelectionAnchor() const;
 
+    /**
+     * @returns The UTF-8 encoded {@link surroundingText}.
+     *
+     * The cursor position and the selection anchor are byte offsets within this text, so it
+     * can be forwarded to an input method without encoding the text again.
+     * @see surroundingText
+     */
+    QByteArray surroundingTextUtf8() const;
+
+    /**
+     * @returns How the surrounding text changed between the previous and the last emission of
+     * {@link surroundingTextChanged}. Once the text input got disabled, the next delta covers
+     * the whole text.
+     *
+     * If only the cursor position or the selection anchor changed, the delta is empty.
+     * @see surroundingTextChanged
+     */
+    TextInputSurroundingTextDelta surroundingTextDelta() const;
+
     /**
      * @return The surface the TextInputV3Interface is enabled on
      * @see isEnabled
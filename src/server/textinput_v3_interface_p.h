@@ -58,7 +58,14 @@ public:
     SeatInterface *seat = nullptr;
     QPointer<SurfaceInterface> surface;
 
+    // the surrounding text is only decoded when it's requested
     QString surroundingText;
+    bool surroundingTextDecoded = true;
+    QByteArray surroundingTextUtf8;
+    // the surrounding text when surroundingTextChanged was last emitted, the delta refers to it
+    QByteArray reportedSurroundingTextUtf8;
+    bool surroundingTextChangedSinceReport = false;
+    TextInputSurroundingTextDelta surroundingTextDelta;
     qint32 surroundingTextCursorPosition = 0;
     qint32 surroundingTextSelectionAnchor = 0;
     TextInputChangeCause surroundingTextChangeCause = TextInputChangeCause::InputMethod;
@@ -69,7 +76,9 @@ public:
         TextInputContentHints contentHints = TextInputContentHint::None;
         TextInputContentPurpose contentPurpose = TextInputContentPurpose::Normal;
         bool enabled = false;
-        QString surroundingText;
+        QByteArray surroundingText;
+        // whether surroundingText may differ from the current one
+        bool surroundingTextSet = false;
         qint32 surroundingTextCursorPosition = 0;
         qint32 surroundingTextSelectionAnchor = 0;
     } pending;
@@ -78,6 +87,7 @@ public:
     QHash<Resource *, bool> enabled;
 
     void defaultPending();
+    void updateSurroundingTextDelta();
 
     TextInputV3Interface *q;
 
@@ -87,7 +97,7 @@ protected:
     // requests
     void zwp_text_input_v3_enable(Resource *resource) override;
     void zwp_text_input_v3_disable(Resource *resource) override;
-    void zwp_text_input_v3_set_surrounding_text(Resource *resource, const QString &text, int32_t cursor, int32_t anchor) override;
+    void zwp_text_input_v3_set_surrounding_text(Resource *resource, QtWaylandServer::Utf8StringView text, int32_t cursor, int32_t anchor) override;
     void zwp_text_input_v3_set_content_type(Resource *resource, uint32_t hint, uint32_t purpose) override;
     void zwp_text_input_v3_set_text_change_cause(Resource *resource, uint32_t cause) override;
     void zwp_text_input_v3_set_cursor_rectangle(Resource *resource, int32_t x, int32_t y, int32_t width, int32_t height) override;
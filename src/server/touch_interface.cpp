@@ -35,6 +35,47 @@ QList<TouchInterfacePrivate::Resource *> TouchInterfacePrivate::touchesForClient
     return resourceMap().values(client->client());
 }
 
+void TouchInterfacePrivate::sendDown(const QList<Resource *> &resources, qint32 id, quint32 serial, const QPointF &localPos)
+{
+    if (resources.isEmpty()) {
+        return;
+    }
+    const quint32 time = seat->timestamp();
+    const wl_fixed_t x = wl_fixed_from_double(localPos.x());
+    const wl_fixed_t y = wl_fixed_from_double(localPos.y());
+    for (Resource *resource : resources) {
+        send_down(resource->handle, serial, time, focusedSurface->resource(), id, x, y);
+    }
+}
+
+void TouchInterfacePrivate::sendUp(const QList<Resource *> &resources, qint32 id, quint32 serial)
+{
+    const quint32 time = seat->timestamp();
+    for (Resource *resource : resources) {
+        send_up(resource->handle, serial, time, id);
+    }
+}
+
+void TouchInterfacePrivate::sendMotion(const QList<Resource *> &resources, qint32 id, const QPointF &localPos)
+{
+    if (resources.isEmpty()) {
+        return;
+    }
+    const quint32 time = seat->timestamp();
+    const wl_fixed_t x = wl_fixed_from_double(localPos.x());
+    const wl_fixed_t y = wl_fixed_from_double(localPos.y());
+    for (Resource *resource : resources) {
+        send_motion(resource->handle, time, id, x, y);
+    }
+}
+
+void TouchInterfacePrivate::sendFrame(const QList<Resource *> &resources)
+{
+    for (Resource *resource : resources) {
+        send_frame(resource->handle);
+    }
+}
+
 TouchInterface::TouchInterface(SeatInterface *seat)
     : d(new TouchInterfacePrivate(this, seat))
 {
@@ -71,11 +112,7 @@ void TouchInterface::sendFrame()
     if (!d->focusedSurface) {
         return;
     }
-
-    const auto touchResources = d->touchesForClient(d->focusedSurface->client());
-    for (TouchInterfacePrivate::Resource *resource : touchResources) {
-        d->send_frame(resource->handle);
-    }
+    d->sendFrame(d->touchesForClient(d->focusedSurface->client()));
 }
 
 void TouchInterface::sendMotion(qint32 id, const QPointF &localPos)
@@ -83,11 +120,7 @@ void TouchInterface::sendMotion(qint32 id, const QPointF &localPos)
     if (!d->focusedSurface) {
         return;
     }
-
-    const auto touchResources = d->touchesForClient(d->focusedSurface->client());
-    for (TouchInterfacePrivate::Resource *resource : touchResources) {
-        d->send_motion(resource->handle, d->seat->timestamp(), id, wl_fixed_from_double(localPos.x()), wl_fixed_from_double(localPos.y()));
-    }
+    d->sendMotion(d->touchesForClient(d->focusedSurface->client()), id, localPos);
 }
 
 void TouchInterface::sendUp(qint32 id, quint32 serial)
@@ -95,11 +128,7 @@ void TouchInterface::sendUp(qint32 id, quint32 serial)
     if (!d->focusedSurface) {
         return;
     }
-
-    const auto touchResources = d->touchesForClient(d->focusedSurface->client());
-    for (TouchInterfacePrivate::Resource *resource : touchResources) {
-        d->send_up(resource->handle, serial, d->seat->timestamp(), id);
-    }
+    d->sendUp(d->touchesForClient(d->focusedSurface->client()), id, serial);
 }
 
 void TouchInterface::sendDown(qint32 id, quint32 serial, const QPointF &localPos)
@@ -107,17 +136,7 @@ void TouchInterface::sendDown(qint32 id, quint32 serial, const QPointF &localPos
     if (!d->focusedSurface) {
         return;
     }
-
-    const auto touchResources = d->touchesForClient(d->focusedSurface->client());
-    for (TouchInterfacePrivate::Resource *resource : touchResources) {
-        d->send_down(resource->handle,
-                     serial,
-                     d->seat->timestamp(),
-                     d->focusedSurface->resource(),
-                     id,
-                     wl_fixed_from_double(localPos.x()),
-                     wl_fixed_from_double(localPos.y()));
-    }
+    d->sendDown(d->touchesForClient(d->focusedSurface->client()), id, serial, localPos);
 }
 
 } // namespace KWaylandServer
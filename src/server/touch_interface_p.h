@@ -22,6 +22,11 @@ public:
 
     QList<Resource *> touchesForClient(ClientConnection *client) const;
 
+    void sendDown(const QList<Resource *> &resources, qint32 id, quint32 serial, const QPointF &localPos);
+    void sendUp(const QList<Resource *> &resources, qint32 id, quint32 serial);
+    void sendMotion(const QList<Resource *> &resources, qint32 id, const QPointF &localPos);
+    void sendFrame(const QList<Resource *> &resources);
+
     TouchInterface *q;
     QPointer<SurfaceInterface> focusedSurface;
     SeatInterface *seat;
@@ -71,10 +71,10 @@ void ViewportInterface::wp_viewport_destroy(Resource *resource)
 {
     if (surface) {
         SurfaceInterfacePrivate *surfacePrivate = SurfaceInterfacePrivate::get(surface);
-        surfacePrivate->pending.viewport.sourceGeometry = QRectF();
-        surfacePrivate->pending.viewport.sourceGeometryIsSet = true;
-        surfacePrivate->pending.viewport.destinationSize = QSize();
-        surfacePrivate->pending.viewport.destinationSizeIsSet = true;
+        surfacePrivate->pending.extensions().viewportSourceGeometry = QRectF();
+        surfacePrivate->pending.committed |= SurfaceState::ViewportSource;
+        surfacePrivate->pending.extensions().viewportDestinationSize = QSize();
+        surfacePrivate->pending.committed |= SurfaceState::ViewportDestination;
     }
 
     wl_resource_destroy(resource->handle);
@@ -94,8 +94,8 @@ void ViewportInterface::wp_viewport_set_source(Resource *resource, wl_fixed_t x_
 
     if (x == -1 && y == -1 && width == -1 && height == -1) {
         SurfaceInterfacePrivate *surfacePrivate = SurfaceInterfacePrivate::get(surface);
-        surfacePrivate->pending.viewport.sourceGeometry = QRectF();
-        surfacePrivate->pending.viewport.sourceGeometryIsSet = true;
+        surfacePrivate->pending.extensions().viewportSourceGeometry = QRectF();
+        surfacePrivate->pending.committed |= SurfaceState::ViewportSource;
         return;
     }
 
@@ -105,8 +105,8 @@ void ViewportInterface::wp_viewport_set_source(Resource *resource, wl_fixed_t x_
     }
 
     SurfaceInterfacePrivate *surfacePrivate = SurfaceInterfacePrivate::get(surface);
-    surfacePrivate->pending.viewport.sourceGeometry = QRectF(x, y, width, height);
-    surfacePrivate->pending.viewport.sourceGeometryIsSet = true;
+    surfacePrivate->pending.extensions().viewportSourceGeometry = QRectF(x, y, width, height);
+    surfacePrivate->pending.committed |= SurfaceState::ViewportSource;
 }
 
 void ViewportInterface::wp_viewport_set_destination(Resource *resource, int32_t width, int32_t height)
@@ -118,8 +118,8 @@ void ViewportInterface::wp_viewport_set_destination(Resource *resource, int32_t
 
     if (width == -1 && height == -1) {
         SurfaceInterfacePrivate *surfacePrivate = SurfaceInterfacePrivate::get(surface);
-        surfacePrivate->pending.viewport.destinationSize = QSize();
-        surfacePrivate->pending.viewport.destinationSizeIsSet = true;
+        surfacePrivate->pending.extensions().viewportDestinationSize = QSize();
+        surfacePrivate->pending.committed |= SurfaceState::ViewportDestination;
         return;
     }
 
@@ -129,8 +129,8 @@ void ViewportInterface::wp_viewport_set_destination(Resource *resource, int32_t
     }
 
     SurfaceInterfacePrivate *surfacePrivate = SurfaceInterfacePrivate::get(surface);
-    surfacePrivate->pending.viewport.destinationSize = QSize(width, height);
-    surfacePrivate->pending.viewport.destinationSizeIsSet = true;
+    surfacePrivate->pending.extensions().viewportDestinationSize = QSize(width, height);
+    surfacePrivate->pending.committed |= SurfaceState::ViewportDestination;
 }
 
 ViewporterInterface::ViewporterInterface(Display *display, QObject *parent)
@@ -17,6 +17,7 @@
 namespace KWaylandServer
 {
 static const int s_version = 3;
+static const int s_maxOutstandingConfigures = 32;
 
 XdgShellInterfacePrivate::XdgShellInterfacePrivate(XdgShellInterface *shell)
     : q(shell)
@@ -152,6 +153,13 @@ void XdgSurfaceInterfacePrivate::commit()
     if (next.acknowledgedConfigureIsSet) {
         current.acknowledgedConfigure = next.acknowledgedConfigure;
         next.acknowledgedConfigureIsSet = false;
+
+        // Acknowledging a configure event implicitly acknowledges all configure events sent before it.
+        const int index = outstandingConfigures.indexOf(current.acknowledgedConfigure);
+        if (index != -1) {
+            outstandingConfigures.remove(0, index + 1);
+        }
+
         Q_EMIT q->configureAcknowledged(current.acknowledgedConfigure);
     }
 
@@ -166,11 +174,25 @@ void XdgSurfaceInterfacePrivate::reset()
 {
     firstBufferAttached = false;
     isConfigured = false;
+    outstandingConfigures.clear();
     current = XdgSurfaceState{};
     next = XdgSurfaceState{};
     Q_EMIT q->resetOccurred();
 }
 
+void XdgSurfaceInterfacePrivate::sendConfigure(quint32 serial)
+{
+    send_configure(serial);
+    // A client that never acknowledges configure events must not make the list grow without
+    // bound. Forgetting the oldest serials is fine, acknowledging one of them would not make
+    // the newer configure events acknowledged anyway.
+    if (outstandingConfigures.count() == s_maxOutstandingConfigures) {
+        outstandingConfigures.removeFirst();
+    }
+    outstandingConfigures.append(serial);
+    isConfigured = true;
+}
+
 XdgSurfaceInterfacePrivate *XdgSurfaceInterfacePrivate::get(XdgSurfaceInterface *surface)
 {
     return surface->d.data();
@@ -300,6 +322,27 @@ QRect XdgSurfaceInterface::windowGeometry() const
     return d->current.windowGeometry;
 }
 
+bool XdgSurfaceInterface::hasOutstandingConfigure() const
+{
+    return !d->outstandingConfigures.isEmpty();
+}
+
+bool XdgSurfaceInterface::isConfigurePacingEnabled() const
+{
+    return d->configurePacing;
+}
+
+void XdgSurfaceInterface::setConfigurePacingEnabled(bool enabled)
+{
+    if (d->configurePacing == enabled) {
+        return;
+    }
+    d->configurePacing = enabled;
+    if (!enabled && d->toplevel) {
+        XdgToplevelInterfacePrivate::get(d->toplevel)->flushHeldConfigure();
+    }
+}
+
 XdgSurfaceInterface *XdgSurfaceInterface::get(::wl_resource *resource)
 {
     if (auto surfacePrivate = resource_cast<XdgSurfaceInterfacePrivate *>(resource)) {
@@ -325,6 +368,10 @@ void XdgToplevelInterfacePrivate::commit()
 
     xdgSurfacePrivate->commit();
 
+    if (heldConfigure && !xdgSurface->hasOutstandingConfigure()) {
+        flushHeldConfigure();
+    }
+
     if (current.minimumSize != next.minimumSize) {
         current.minimumSize = next.minimumSize;
         Q_EMIT q->minimumSizeChanged(current.minimumSize);
@@ -346,7 +393,11 @@ void XdgToplevelInterfacePrivate::reset()
 
     windowTitle = QString();
     windowClass = QString();
+    windowTitleUtf8 = QByteArray();
+    windowClassUtf8 = QByteArray();
     current = next = State();
+    heldConfigure.reset();
+    lastConfiguredSize = QSize();
 
     Q_EMIT q->resetOccurred();
 }
@@ -374,24 +425,34 @@ void XdgToplevelInterfacePrivate::xdg_toplevel_set_parent(Resource *resource, ::
     Q_EMIT q->parentXdgToplevelChanged();
 }
 
-void XdgToplevelInterfacePrivate::xdg_toplevel_set_title(Resource *resource, const QString &title)
+void XdgToplevelInterfacePrivate::xdg_toplevel_set_title(Resource *resource, QtWaylandServer::Utf8StringView title)
 {
     Q_UNUSED(resource)
-    if (windowTitle == title) {
+    if (windowTitleUtf8 == title) {
+        return;
+    }
+    windowTitleUtf8 = title.toByteArray();
+    const QString decoded = title.toString();
+    if (windowTitle == decoded) {
         return;
     }
-    windowTitle = title;
-    Q_EMIT q->windowTitleChanged(title);
+    windowTitle = decoded;
+    Q_EMIT q->windowTitleChanged(decoded);
 }
 
-void XdgToplevelInterfacePrivate::xdg_toplevel_set_app_id(Resource *resource, const QString &app_id)
+void XdgToplevelInterfacePrivate::xdg_toplevel_set_app_id(Resource *resource, QtWaylandServer::Utf8StringView app_id)
 {
     Q_UNUSED(resource)
-    if (windowClass == app_id) {
+    if (windowClassUtf8 == app_id) {
         return;
     }
-    windowClass = app_id;
-    Q_EMIT q->windowClassChanged(app_id);
+    windowClassUtf8 = app_id.toByteArray();
+    const QString decoded = app_id.toString();
+    if (windowClass == decoded) {
+        return;
+    }
+    windowClass = decoded;
+    Q_EMIT q->windowClassChanged(decoded);
 }
 
 void XdgToplevelInterfacePrivate::xdg_toplevel_show_window_menu(Resource *resource, ::wl_resource *seatResource, uint32_t serial, int32_t x, int32_t y)
@@ -482,6 +543,65 @@ void XdgToplevelInterfacePrivate::xdg_toplevel_set_minimized(Resource *resource)
     Q_EMIT q->minimizeRequested();
 }
 
+quint32 XdgToplevelInterfacePrivate::sendConfigure(const QSize &size, const XdgToplevelInterface::States &states)
+{
+    // Note that the states listed in the configure event must be an array of uint32_t.
+
+    uint32_t statesData[8] = {0};
+    int i = 0;
+
+    if (states & XdgToplevelInterface::State::MaximizedHorizontal && states & XdgToplevelInterface::State::MaximizedVertical) {
+        statesData[i++] = QtWaylandServer::xdg_toplevel::state_maximized;
+    }
+    if (states & XdgToplevelInterface::State::FullScreen) {
+        statesData[i++] = QtWaylandServer::xdg_toplevel::state_fullscreen;
+    }
+    if (states & XdgToplevelInterface::State::Resizing) {
+        statesData[i++] = QtWaylandServer::xdg_toplevel::state_resizing;
+    }
+    if (states & XdgToplevelInterface::State::Activated) {
+        statesData[i++] = QtWaylandServer::xdg_toplevel::state_activated;
+    }
+
+    if (resource()->version() >= XDG_TOPLEVEL_STATE_TILED_LEFT_SINCE_VERSION) {
+        if (states & XdgToplevelInterface::State::TiledLeft) {
+            statesData[i++] = QtWaylandServer::xdg_toplevel::state_tiled_left;
+        }
+        if (states & XdgToplevelInterface::State::TiledTop) {
+            statesData[i++] = QtWaylandServer::xdg_toplevel::state_tiled_top;
+        }
+        if (states & XdgToplevelInterface::State::TiledRight) {
+            statesData[i++] = QtWaylandServer::xdg_toplevel::state_tiled_right;
+        }
+        if (states & XdgToplevelInterface::State::TiledBottom) {
+            statesData[i++] = QtWaylandServer::xdg_toplevel::state_tiled_bottom;
+        }
+    }
+
+    const QByteArray xdgStates = QByteArray::fromRawData(reinterpret_cast<char *>(statesData), sizeof(uint32_t) * i);
+    const quint32 serial = xdgSurface->shell()->display()->nextSerial();
+
+    send_configure(size.width(), size.height(), xdgStates);
+    lastConfiguredSize = size;
+
+    auto xdgSurfacePrivate = XdgSurfaceInterfacePrivate::get(xdgSurface);
+    xdgSurfacePrivate->sendConfigure(serial);
+
+    return serial;
+}
+
+void XdgToplevelInterfacePrivate::flushHeldConfigure()
+{
+    if (!heldConfigure) {
+        return;
+    }
+    const HeldConfigure configure = *heldConfigure;
+    heldConfigure.reset();
+
+    const quint32 serial = sendConfigure(configure.size, configure.states);
+    Q_EMIT q->pacedConfigureSent(serial, configure.size, configure.states);
+}
+
 XdgToplevelInterfacePrivate *XdgToplevelInterfacePrivate::get(XdgToplevelInterface *toplevel)
 {
     return toplevel->d.data();
@@ -549,49 +669,18 @@ QSize XdgToplevelInterface::maximumSize() const
 
 quint32 XdgToplevelInterface::sendConfigure(const QSize &size, const States &states)
 {
-    // Note that the states listed in the configure event must be an array of uint32_t.
-
-    uint32_t statesData[8] = {0};
-    int i = 0;
-
-    if (states & State::MaximizedHorizontal && states & State::MaximizedVertical) {
-        statesData[i++] = QtWaylandServer::xdg_toplevel::state_maximized;
-    }
-    if (states & State::FullScreen) {
-        statesData[i++] = QtWaylandServer::xdg_toplevel::state_fullscreen;
-    }
-    if (states & State::Resizing) {
-        statesData[i++] = QtWaylandServer::xdg_toplevel::state_resizing;
-    }
-    if (states & State::Activated) {
-        statesData[i++] = QtWaylandServer::xdg_toplevel::state_activated;
-    }
-
-    if (d->resource()->version() >= XDG_TOPLEVEL_STATE_TILED_LEFT_SINCE_VERSION) {
-        if (states & State::TiledLeft) {
-            statesData[i++] = QtWaylandServer::xdg_toplevel::state_tiled_left;
-        }
-        if (states & State::TiledTop) {
-            statesData[i++] = QtWaylandServer::xdg_toplevel::state_tiled_top;
-        }
-        if (states & State::TiledRight) {
-            statesData[i++] = QtWaylandServer::xdg_toplevel::state_tiled_right;
-        }
-        if (states & State::TiledBottom) {
-            statesData[i++] = QtWaylandServer::xdg_toplevel::state_tiled_bottom;
+    // A configure that doesn't change the size is sent right away so state changes, e.g.
+    // activation, are not delayed. Otherwise, only the newest configure is kept until the
+    // client catches up with the outstanding one.
+    if (xdgSurface()->isConfigurePacingEnabled() && xdgSurface()->hasOutstandingConfigure()) {
+        if (d->heldConfigure || size != d->lastConfiguredSize) {
+            d->heldConfigure = XdgToplevelInterfacePrivate::HeldConfigure{size, states};
+            return 0;
         }
     }
 
-    const QByteArray xdgStates = QByteArray::fromRawData(reinterpret_cast<char *>(statesData), sizeof(uint32_t) * i);
-    const quint32 serial = xdgSurface()->shell()->display()->nextSerial();
-
-    d->send_configure(size.width(), size.height(), xdgStates);
-
-    auto xdgSurfacePrivate = XdgSurfaceInterfacePrivate::get(xdgSurface());
-    xdgSurfacePrivate->send_configure(serial);
-    xdgSurfacePrivate->isConfigured = true;
-
-    return serial;
+    d->heldConfigure.reset();
+    return d->sendConfigure(size, states);
 }
 
 void XdgToplevelInterface::sendClose()
@@ -724,8 +813,7 @@ quint32 XdgPopupInterface::sendConfigure(const QRect &rect)
     d->send_configure(rect.x(), rect.y(), rect.width(), rect.height());
 
     auto xdgSurfacePrivate = XdgSurfaceInterfacePrivate::get(xdgSurface());
-    xdgSurfacePrivate->send_configure(serial);
-    xdgSurfacePrivate->isConfigured = true;
+    xdgSurfacePrivate->sendConfigure(serial);
 
     return serial;
 }
@@ -154,6 +154,36 @@ public:
      */
     QRect windowGeometry() const;
 
+    /**
+     * Returns \c true if a configure event has been sent to the client that has not been
+     * acknowledged and committed yet; otherwise returns \c false.
+     *
+     * A configure event is considered to be committed after the client has sent an
+     * ack_configure request with its serial, or the serial of a later configure event, and
+     * has committed the surface state.
+     */
+    bool hasOutstandingConfigure() const;
+
+    /**
+     * Returns \c true if configure pacing is enabled; otherwise returns \c false.
+     *
+     * @see setConfigurePacingEnabled
+     */
+    bool isConfigurePacingEnabled() const;
+
+    /**
+     * Sets whether configure events that change the size of the surface should be paced
+     * according to how quickly the client acknowledges them.
+     *
+     * If pacing is enabled and there is an outstanding configure event, new size configures
+     * are held back until the client commits the outstanding one. Only the newest held back
+     * configure is sent to the client. This is useful during interactive resize, where slow
+     * clients would otherwise fall behind and keep rendering stale sizes.
+     *
+     * Disabling pacing sends any held back configure immediately. Pacing is disabled by default.
+     */
+    void setConfigurePacingEnabled(bool enabled);
+
     /**
      * Returns the XdgSurfaceInterface for the specified wayland resource object \a resource.
      */
@@ -282,6 +312,12 @@ public:
     /**
      * Sends a configure event to the client. \a size specifies the new window geometry size. A size
      * of zero means the client should decide its own window dimensions.
+     *
+     * If configure pacing is enabled on the xdg-surface and the configure event has been held
+     * back, this method returns \c 0. The serial of the configure event that is eventually sent
+     * is reported by the pacedConfigureSent() signal.
+     *
+     * @see XdgSurfaceInterface::setConfigurePacingEnabled
      */
     quint32 sendConfigure(const QSize &size, const States &states);
 
@@ -381,6 +417,13 @@ Q_SIGNALS:
      */
     void parentXdgToplevelChanged();
 
+    /**
+     * This signal is emitted when a configure event that has been held back due to configure
+     * pacing is sent to the client. \a serial is the serial of the configure event, \a size
+     * and \a states are the window geometry size and the states sent to the client.
+     */
+    void pacedConfigureSent(quint32 serial, const QSize &size, KWaylandServer::XdgToplevelInterface::States states);
+
 private:
     QScopedPointer<XdgToplevelInterfacePrivate> d;
     friend class XdgToplevelInterfacePrivate;
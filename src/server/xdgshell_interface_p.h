@@ -12,6 +12,8 @@
 #include "surface_interface.h"
 #include "surfacerole_p.h"
 
+#include <optional>
+
 namespace KWaylandServer
 {
 class XdgToplevelDecorationV1Interface;
@@ -97,6 +99,7 @@ public:
 
     void commit();
     void reset();
+    void sendConfigure(quint32 serial);
 
     XdgSurfaceInterface *q;
     XdgShellInterface *shell;
@@ -105,6 +108,8 @@ public:
     QPointer<SurfaceInterface> surface;
     bool firstBufferAttached = false;
     bool isConfigured = false;
+    bool configurePacing = false;
+    QVector<quint32> outstandingConfigures;
 
     XdgSurfaceState next;
     XdgSurfaceState current;
@@ -128,6 +133,9 @@ public:
     void commit() override;
     void reset();
 
+    quint32 sendConfigure(const QSize &size, const XdgToplevelInterface::States &states);
+    void flushHeldConfigure();
+
     static XdgToplevelInterfacePrivate *get(XdgToplevelInterface *toplevel);
     static XdgToplevelInterfacePrivate *get(::wl_resource *resource);
 
@@ -138,6 +146,9 @@ public:
 
     QString windowTitle;
     QString windowClass;
+    // as sent by the client, clients often set the same title again, e.g. on every redraw
+    QByteArray windowTitleUtf8;
+    QByteArray windowClassUtf8;
 
     struct State {
         QSize minimumSize;
@@ -147,12 +158,20 @@ public:
     State next;
     State current;
 
+    struct HeldConfigure {
+        QSize size;
+        XdgToplevelInterface::States states;
+    };
+
+    std::optional<HeldConfigure> heldConfigure;
+    QSize lastConfiguredSize;
+
 protected:
     void xdg_toplevel_destroy_resource(Resource *resource) override;
     void xdg_toplevel_destroy(Resource *resource) override;
     void xdg_toplevel_set_parent(Resource *resource, ::wl_resource *parent) override;
-    void xdg_toplevel_set_title(Resource *resource, const QString &title) override;
-    void xdg_toplevel_set_app_id(Resource *resource, const QString &app_id) override;
+    void xdg_toplevel_set_title(Resource *resource, QtWaylandServer::Utf8StringView title) override;
+    void xdg_toplevel_set_app_id(Resource *resource, QtWaylandServer::Utf8StringView app_id) override;
     void xdg_toplevel_show_window_menu(Resource *resource, ::wl_resource *seat, uint32_t serial, int32_t x, int32_t y) override;
     void xdg_toplevel_move(Resource *resource, ::wl_resource *seat, uint32_t serial) override;
     void xdg_toplevel_resize(Resource *resource, ::wl_resource *seat, uint32_t serial, uint32_t edges) override;
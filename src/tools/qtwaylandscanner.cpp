@@ -6,6 +6,7 @@
 #include <QFile>
 #include <QXmlStreamReader>
 
+#include <algorithm>
 #include <vector>
 
 class Scanner
@@ -45,6 +46,9 @@ private:
         QByteArray name;
         QByteArray type;
         std::vector<WaylandArgument> arguments;
+        // requests: the handler receives string arguments as Utf8StringView instead of QString
+        // events: an additional send_ overload takes string arguments as UTF-8 encoded QByteArray
+        bool utf8Strings;
     };
 
     struct WaylandInterface {
@@ -69,7 +73,8 @@ private:
     QByteArray waylandToQtType(const QByteArray &waylandType, const QByteArray &interface, bool cStyleArray);
     const Scanner::WaylandArgument *newIdArgument(const std::vector<WaylandArgument> &arguments);
 
-    void printEvent(const WaylandEvent &e, bool omitNames = false, bool withResource = false);
+    void printEvent(const WaylandEvent &e, bool omitNames = false, bool withResource = false, bool utf8Overload = false);
+    void printSendEvent(const WaylandEvent &e, size_t opcode, const char *interfaceName, bool utf8Overload);
     void printEventHandlerSignature(const WaylandEvent &e, const char *interfaceName, bool deepIndent = true);
     void printEnums(const std::vector<WaylandEnum> &enums);
 
@@ -89,6 +94,9 @@ private:
     QByteArray m_headerPath;
     QByteArray m_prefix;
     QVector <QByteArray> m_includes;
+    QVector<QByteArray> m_utf8Requests;
+    QVector<QByteArray> m_utf8Events;
+    bool m_trace = false;
     QXmlStreamReader *m_xml = nullptr;
 };
 
@@ -115,16 +123,31 @@ bool Scanner::parseArguments(int argc, char **argv)
         // --header-path=<path> (14 characters)
         // --prefix=<prefix> (9 characters)
         // --add-include=<include> (14 characters)
+        // --utf8-request=<interface>.<request> (15 characters)
+        // --utf8-event=<interface>.<event> (13 characters)
+        // --trace
         for (int pos = 3; pos < argc; pos++) {
             const QByteArray &option = args[pos];
             if (option.startsWith("--header-path=")) {
                 m_headerPath = option.mid(14);
             } else if (option.startsWith("--prefix=")) {
-                m_prefix = option.mid(10);
+                m_prefix = option.mid(9);
             } else if (option.startsWith("--add-include=")) {
                 auto include = option.mid(14);
                 if (!include.isEmpty())
                     m_includes << include;
+            } else if (option.startsWith("--utf8-request=")) {
+                auto request = option.mid(15);
+                if (!request.contains('.'))
+                    return false;
+                m_utf8Requests << request;
+            } else if (option.startsWith("--utf8-event=")) {
+                auto event = option.mid(13);
+                if (!event.contains('.'))
+                    return false;
+                m_utf8Events << event;
+            } else if (option == "--trace") {
+                m_trace = true;
             } else {
                 return false;
             }
@@ -136,7 +159,7 @@ bool Scanner::parseArguments(int argc, char **argv)
 
 void Scanner::printUsage()
 {
-    fprintf(stderr, "Usage: %s [client-header|server-header|client-code|server-code] specfile [--header-path=<path>] [--prefix=<prefix>] [--add-include=<include>]\n", m_scannerName.constData());
+    fprintf(stderr, "Usage: %s [client-header|server-header|client-code|server-code] specfile [--header-path=<path>] [--prefix=<prefix>] [--add-include=<include>] [--utf8-request=<interface>.<request>] [--utf8-event=<interface>.<event>] [--trace]\n", m_scannerName.constData());
 }
 
 bool Scanner::isServerSide()
@@ -186,6 +209,7 @@ Scanner::WaylandEvent Scanner::readEvent(QXmlStreamReader &xml, bool request)
         .name = byteArrayValue(xml, "name"),
         .type = byteArrayValue(xml, "type"),
         .arguments = {},
+        .utf8Strings = false,
     };
     while (xml.readNextStartElement()) {
         if (xml.name() == "arg") {
@@ -238,10 +262,16 @@ Scanner::WaylandInterface Scanner::readInterface(QXmlStreamReader &xml)
     };
 
     while (xml.readNextStartElement()) {
-        if (xml.name() == "event")
-            interface.events.push_back(readEvent(xml, false));
-        else if (xml.name() == "request")
-            interface.requests.push_back(readEvent(xml, true));
+        if (xml.name() == "event") {
+            WaylandEvent event = readEvent(xml, false);
+            event.utf8Strings = isServerSide() && m_utf8Events.contains(interface.name + '.' + event.name);
+            interface.events.push_back(std::move(event));
+        }
+        else if (xml.name() == "request") {
+            WaylandEvent request = readEvent(xml, true);
+            request.utf8Strings = isServerSide() && m_utf8Requests.contains(interface.name + '.' + request.name);
+            interface.requests.push_back(std::move(request));
+        }
         else if (xml.name() == "enum")
             interface.enums.push_back(readEnum(xml));
         else
@@ -294,7 +324,7 @@ const Scanner::WaylandArgument *Scanner::newIdArgument(const std::vector<Wayland
     return nullptr;
 }
 
-void Scanner::printEvent(const WaylandEvent &e, bool omitNames, bool withResource)
+void Scanner::printEvent(const WaylandEvent &e, bool omitNames, bool withResource, bool utf8Overload)
 {
     printf("%s(", e.name.constData());
     bool needsComma = false;
@@ -330,7 +360,13 @@ void Scanner::printEvent(const WaylandEvent &e, bool omitNames, bool withResourc
             }
         }
 
-        QByteArray qtType = waylandToQtType(a.type, a.interface, e.request == isServerSide());
+        QByteArray qtType;
+        if (a.type == "string" && e.request && e.utf8Strings)
+            qtType = "Utf8StringView ";
+        else if (a.type == "string" && utf8Overload)
+            qtType = "const QByteArray &";
+        else
+            qtType = waylandToQtType(a.type, a.interface, e.request == isServerSide());
         printf("%s%s%s", qtType.constData(), qtType.endsWith("&") || qtType.endsWith("*") ? "" : " ", omitNames ? "" : a.name.constData());
     }
     printf(")");
@@ -360,6 +396,70 @@ void Scanner::printEventHandlerSignature(const WaylandEvent &e, const char *inte
     printf(")");
 }
 
+void Scanner::printSendEvent(const WaylandEvent &e, size_t opcode, const char *interfaceName, bool utf8Overload)
+{
+    printf("\n");
+    printf("    void %s::send_", interfaceName);
+    printEvent(e, false, false, utf8Overload);
+    printf("\n");
+    printf("    {\n");
+    printf("        Q_ASSERT_X(m_resource, \"%s::%s\", \"Uninitialised resource\");\n", interfaceName, e.name.constData());
+    printf("        if (Q_UNLIKELY(!m_resource)) {\n");
+    printf("            qWarning(\"could not call %s::%s as it's not initialised\");\n", interfaceName, e.name.constData());
+    printf("            return;\n");
+    printf("        }\n");
+    printf("        send_%s(\n", e.name.constData());
+    printf("            m_resource->handle");
+    for (const WaylandArgument &a : e.arguments) {
+        printf(",\n");
+        printf("            %s", a.name.constData());
+    }
+    printf(");\n");
+    printf("    }\n");
+    printf("\n");
+
+    printf("    void %s::send_", interfaceName);
+    printEvent(e, false, true, utf8Overload);
+    printf("\n");
+    printf("    {\n");
+    if (m_trace)
+        printf("        QTWAYLANDSERVER_TRACE_EVENT(\"%s\", \"%s\", %zu, resource);\n", interfaceName, e.name.constData(), opcode);
+
+    for (const WaylandArgument &a : e.arguments) {
+        if (a.type != "array")
+            continue;
+        QByteArray array = a.name + "_data";
+        const char *arrayName = array.constData();
+        const char *variableName = a.name.constData();
+        printf("        struct wl_array %s;\n", arrayName);
+        printf("        %s.size = %s.size();\n", arrayName, variableName);
+        printf("        %s.data = static_cast<void *>(const_cast<char *>(%s.constData()));\n", arrayName, variableName);
+        printf("        %s.alloc = 0;\n", arrayName);
+        printf("\n");
+    }
+
+    printf("        %s_send_%s(\n", interfaceName, e.name.constData());
+    printf("            resource");
+
+    for (const WaylandArgument &a : e.arguments) {
+        printf(",\n");
+        QByteArray cType = waylandToCType(a.type, a.interface);
+        QByteArray qtType = waylandToQtType(a.type, a.interface, e.request);
+        if (a.type == "string" && utf8Overload)
+            printf("            %s.constData()", a.name.constData());
+        else if (a.type == "string")
+            printf("            %s.toUtf8().constData()", a.name.constData());
+        else if (a.type == "array")
+            printf("            &%s_data", a.name.constData());
+        else if (cType == qtType)
+            printf("            %s", a.name.constData());
+    }
+
+    printf(");\n");
+    printf("    }\n");
+    printf("\n");
+}
+
 void Scanner::printEnums(const std::vector<WaylandEnum> &enums)
 {
     for (const WaylandEnum &e : enums) {
@@ -483,6 +583,44 @@ bool Scanner::process()
         printf("\n");
         printf("namespace QtWaylandServer {\n");
 
+        const bool needsUtf8StringView = std::any_of(interfaces.cbegin(), interfaces.cend(), [](const WaylandInterface &interface) {
+            return std::any_of(interface.requests.cbegin(), interface.requests.cend(), [](const WaylandEvent &request) {
+                return request.utf8Strings;
+            });
+        });
+        if (needsUtf8StringView) {
+            // shared by all the protocols that pass --utf8-request
+            printf("#ifndef QTWAYLANDSERVER_UTF8STRINGVIEW\n");
+            printf("#define QTWAYLANDSERVER_UTF8STRINGVIEW\n");
+            printf("    // A string argument of a request, encoded in UTF-8. It points into the buffer of the\n");
+            printf("    // connection and is only valid until the request handler returns.\n");
+            printf("    class Utf8StringView\n");
+            printf("    {\n");
+            printf("    public:\n");
+            printf("        Utf8StringView() = default;\n");
+            printf("        explicit Utf8StringView(const char *data) : m_data(data), m_size(data ? int(qstrlen(data)) : 0) {}\n");
+            printf("\n");
+            printf("        const char *data() const { return m_data; }\n");
+            printf("        int size() const { return m_size; }\n");
+            printf("        bool isNull() const { return !m_data; }\n");
+            printf("        bool isEmpty() const { return !m_size; }\n");
+            printf("\n");
+            printf("        QString toString() const { return QString::fromUtf8(m_data, m_size); }\n");
+            printf("        QByteArray toByteArray() const { return QByteArray(m_data, m_size); }\n");
+            printf("\n");
+            printf("        friend bool operator==(Utf8StringView a, const QByteArray &b) { return a.m_size == b.size() && (!a.m_size || !memcmp(a.m_data, b.constData(), a.m_size)); }\n");
+            printf("        friend bool operator!=(Utf8StringView a, const QByteArray &b) { return !(a == b); }\n");
+            printf("        friend bool operator==(const QByteArray &a, Utf8StringView b) { return b == a; }\n");
+            printf("        friend bool operator!=(const QByteArray &a, Utf8StringView b) { return !(b == a); }\n");
+            printf("\n");
+            printf("    private:\n");
+            printf("        const char *m_data = nullptr;\n");
+            printf("        int m_size = 0;\n");
+            printf("    };\n");
+            printf("#endif\n");
+            printf("\n");
+        }
+
         bool needsNewLine = false;
         for (const WaylandInterface &interface : interfaces) {
 
@@ -561,6 +699,14 @@ bool Scanner::process()
                     printf("        void send_");
                     printEvent(e, false, true);
                     printf(";\n");
+                    if (e.utf8Strings) {
+                        printf("        void send_");
+                        printEvent(e, false, false, true);
+                        printf(";\n");
+                        printf("        void send_");
+                        printEvent(e, false, true, true);
+                        printf(";\n");
+                    }
                 }
             }
 
@@ -634,6 +780,16 @@ bool Scanner::process()
         else
             printf("#include <%s/qwayland-server-%s.h>\n", m_headerPath.constData(), QByteArray(m_protocolName).replace('_', '-').constData());
         printf("\n");
+        if (m_trace) {
+            // The hooks are provided by a header passed with --add-include, fall back to no-ops
+            printf("#ifndef QTWAYLANDSERVER_TRACE_REQUEST\n");
+            printf("#define QTWAYLANDSERVER_TRACE_REQUEST(interface, message, opcode, client)\n");
+            printf("#endif\n");
+            printf("#ifndef QTWAYLANDSERVER_TRACE_EVENT\n");
+            printf("#define QTWAYLANDSERVER_TRACE_EVENT(interface, message, opcode, resource)\n");
+            printf("#endif\n");
+            printf("\n");
+        }
         printf("QT_BEGIN_NAMESPACE\n");
         printf("QT_WARNING_PUSH\n");
         printf("QT_WARNING_DISABLE_GCC(\"-Wmissing-field-initializers\")\n");
@@ -903,7 +1059,8 @@ bool Scanner::process()
                 }
                 printf("\n");
 
-                for (const WaylandEvent &e : interface.requests) {
+                for (size_t opcode = 0; opcode < interface.requests.size(); ++opcode) {
+                    const WaylandEvent &e = interface.requests[opcode];
                     printf("\n");
                     printf("    void %s::", interfaceName);
 
@@ -912,6 +1069,8 @@ bool Scanner::process()
                     printf("\n");
                     printf("    {\n");
                     printf("        Q_UNUSED(client);\n");
+                    if (m_trace)
+                        printf("        QTWAYLANDSERVER_TRACE_REQUEST(\"%s\", \"%s\", %zu, client);\n", interfaceName, e.name.constData(), opcode);
                     printf("        Resource *r = Resource::fromResource(resource);\n");
                     printf("        if (Q_UNLIKELY(!r->%s_object)) {\n", interfaceNameStripped);
                     for (const WaylandArgument &a : e.arguments) {
@@ -929,7 +1088,9 @@ bool Scanner::process()
                         QByteArray cType = waylandToCType(a.type, a.interface);
                         QByteArray qtType = waylandToQtType(a.type, a.interface, e.request);
                         const char *argumentName = a.name.constData();
-                        if (cType == qtType)
+                        if (a.type == "string" && e.utf8Strings)
+                            printf("            Utf8StringView(%s)", argumentName);
+                        else if (cType == qtType)
                             printf("            %s", argumentName);
                         else if (a.type == "string")
                             printf("            QString::fromUtf8(%s)", argumentName);
@@ -939,63 +1100,11 @@ bool Scanner::process()
                 }
             }
 
-            for (const WaylandEvent &e : interface.events) {
-                printf("\n");
-                printf("    void %s::send_", interfaceName);
-                printEvent(e);
-                printf("\n");
-                printf("    {\n");
-                printf("        Q_ASSERT_X(m_resource, \"%s::%s\", \"Uninitialised resource\");\n", interfaceName, e.name.constData());
-                printf("        if (Q_UNLIKELY(!m_resource)) {\n");
-                printf("            qWarning(\"could not call %s::%s as it's not initialised\");\n", interfaceName, e.name.constData());
-                printf("            return;\n");
-                printf("        }\n");
-                printf("        send_%s(\n", e.name.constData());
-                printf("            m_resource->handle");
-                for (const WaylandArgument &a : e.arguments) {
-                    printf(",\n");
-                    printf("            %s", a.name.constData());
-                }
-                printf(");\n");
-                printf("    }\n");
-                printf("\n");
-
-                printf("    void %s::send_", interfaceName);
-                printEvent(e, false, true);
-                printf("\n");
-                printf("    {\n");
-
-                for (const WaylandArgument &a : e.arguments) {
-                    if (a.type != "array")
-                        continue;
-                    QByteArray array = a.name + "_data";
-                    const char *arrayName = array.constData();
-                    const char *variableName = a.name.constData();
-                    printf("        struct wl_array %s;\n", arrayName);
-                    printf("        %s.size = %s.size();\n", arrayName, variableName);
-                    printf("        %s.data = static_cast<void *>(const_cast<char *>(%s.constData()));\n", arrayName, variableName);
-                    printf("        %s.alloc = 0;\n", arrayName);
-                    printf("\n");
-                }
-
-                printf("        %s_send_%s(\n", interfaceName, e.name.constData());
-                printf("            resource");
-
-                for (const WaylandArgument &a : e.arguments) {
-                    printf(",\n");
-                    QByteArray cType = waylandToCType(a.type, a.interface);
-                    QByteArray qtType = waylandToQtType(a.type, a.interface, e.request);
-                    if (a.type == "string")
-                        printf("            %s.toUtf8().constData()", a.name.constData());
-                    else if (a.type == "array")
-                        printf("            &%s_data", a.name.constData());
-                    else if (cType == qtType)
-                        printf("            %s", a.name.constData());
-                }
-
-                printf(");\n");
-                printf("    }\n");
-                printf("\n");
+            for (size_t opcode = 0; opcode < interface.events.size(); ++opcode) {
+                const WaylandEvent &e = interface.events[opcode];
+                printSendEvent(e, opcode, interfaceName, false);
+                if (e.utf8Strings)
+                    printSendEvent(e, opcode, interfaceName, true);
             }
         }
         printf("}\n");
@@ -0,0 +1,401 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+// Records the traffic of Wayland clients through a proxy socket placed in front of a
+// compositor, see README.md in this directory.
+
+#include "sessionrecording.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSocketNotifier>
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+
+#include <fcntl.h>
+
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static int s_signalPipe[2];
+
+static void handleSignal(int)
+{
+    const char byte = 0;
+    const ssize_t written = write(s_signalPipe[1], &byte, 1);
+    Q_UNUSED(written)
+}
+
+static QString socketPath(const QString &name)
+{
+    if (QDir::isAbsolutePath(name)) {
+        return name;
+    }
+    return QDir(qEnvironmentVariable("XDG_RUNTIME_DIR")).filePath(name);
+}
+
+static bool fillAddress(const QString &path, sockaddr_un *address)
+{
+    const QByteArray encoded = QFile::encodeName(path);
+    if (encoded.size() >= int(sizeof(address->sun_path))) {
+        return false;
+    }
+    *address = {};
+    address->sun_family = AF_UNIX;
+    std::memcpy(address->sun_path, encoded.constData(), encoded.size());
+    return true;
+}
+
+class Recorder;
+
+/**
+ * Forwards the traffic between one client and the compositor and records it.
+ */
+class ProxyConnection : public QObject
+{
+public:
+    ProxyConnection(quint32 id, int clientFd, int serverFd, Recorder *recorder);
+    ~ProxyConnection() override;
+
+private:
+    /**
+     * The traffic in one direction. What the receiving end does not take right away is kept
+     * until its socket gets writable again, meanwhile nothing more is read from the sending end.
+     */
+    struct Direction {
+        int from = -1;
+        int to = -1;
+        SessionRecord::Type type = SessionRecord::Type::Requests;
+        QSocketNotifier *readNotifier = nullptr;
+        QSocketNotifier *writeNotifier = nullptr;
+        QByteArray pending;
+        QVector<int> pendingFds;
+    };
+
+    void setupDirection(Direction &direction, int from, int to, SessionRecord::Type type);
+    void forward(Direction &direction);
+    void flush(Direction &direction);
+    void captureSentFile(const QPair<int, qint32> &file);
+    void closeConnection();
+
+    quint32 m_id;
+    int m_clientFd;
+    int m_serverFd;
+    Recorder *m_recorder;
+    bool m_closed = false;
+    Direction m_requests;
+    Direction m_events;
+    // the file descriptors sent by the client, captured when the connection closes as shm
+    // pools only get their content and final size after they were sent
+    QVector<QPair<int, qint32>> m_sentFiles;
+};
+
+// keeping every file descriptor a client sent open runs into the limit of open files, the
+// oldest ones get captured early beyond this
+static const int s_maxSentFiles = 256;
+
+class Recorder : public QObject
+{
+public:
+    ~Recorder() override;
+
+    bool listen(const QString &socketName);
+    void setUpstream(const QString &socketName);
+    bool startRecording(const QString &directory);
+
+    void record(SessionRecord record);
+    qint32 nextFileIndex();
+    bool captureFile(int fd, qint32 index);
+
+private:
+    void handleNewConnection();
+
+    int m_listenFd = -1;
+    QString m_socketPath;
+    QString m_upstreamPath;
+    quint32 m_nextConnectionId = 1;
+    qint32 m_nextFileIndex = 0;
+    QElapsedTimer m_clock;
+    SessionWriter m_writer;
+};
+
+ProxyConnection::ProxyConnection(quint32 id, int clientFd, int serverFd, Recorder *recorder)
+    : QObject(recorder)
+    , m_id(id)
+    , m_clientFd(clientFd)
+    , m_serverFd(serverFd)
+    , m_recorder(recorder)
+{
+    SessionRecord record;
+    record.type = SessionRecord::Type::Connected;
+    record.connection = m_id;
+    m_recorder->record(record);
+
+    setupDirection(m_requests, m_clientFd, m_serverFd, SessionRecord::Type::Requests);
+    setupDirection(m_events, m_serverFd, m_clientFd, SessionRecord::Type::Events);
+}
+
+ProxyConnection::~ProxyConnection()
+{
+    for (const auto &file : qAsConst(m_sentFiles)) {
+        captureSentFile(file);
+    }
+
+    SessionRecord record;
+    record.type = SessionRecord::Type::Disconnected;
+    record.connection = m_id;
+    m_recorder->record(record);
+
+    for (int fd : qAsConst(m_requests.pendingFds)) {
+        close(fd);
+    }
+    for (int fd : qAsConst(m_events.pendingFds)) {
+        close(fd);
+    }
+    close(m_clientFd);
+    close(m_serverFd);
+}
+
+void ProxyConnection::setupDirection(Direction &direction, int from, int to, SessionRecord::Type type)
+{
+    direction.from = from;
+    direction.to = to;
+    direction.type = type;
+    direction.readNotifier = new QSocketNotifier(from, QSocketNotifier::Read, this);
+    connect(direction.readNotifier, &QSocketNotifier::activated, this, [this, &direction]() {
+        forward(direction);
+    });
+    direction.writeNotifier = new QSocketNotifier(to, QSocketNotifier::Write, this);
+    direction.writeNotifier->setEnabled(false);
+    connect(direction.writeNotifier, &QSocketNotifier::activated, this, [this, &direction]() {
+        flush(direction);
+    });
+}
+
+void ProxyConnection::forward(Direction &direction)
+{
+    if (m_closed) {
+        return;
+    }
+    SessionRecord record;
+    record.type = direction.type;
+    record.connection = m_id;
+    QVector<int> fds;
+    const qint64 count = Wire::receive(direction.from, &record.data, &fds, false);
+    if (count <= 0) {
+        const bool wouldBlock = count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+        for (int fd : qAsConst(fds)) {
+            close(fd);
+        }
+        if (!wouldBlock) {
+            closeConnection();
+        }
+        return;
+    }
+
+    if (direction.type == SessionRecord::Type::Requests) {
+        for (int fd : qAsConst(fds)) {
+            const qint32 index = m_recorder->nextFileIndex();
+            const int copy = dup(fd);
+            if (copy == -1) {
+                // out of file descriptors, the content at the time it was sent is the best we get
+                record.files.append(m_recorder->captureFile(fd, index) ? index : -1);
+                continue;
+            }
+            record.files.append(index);
+            if (m_sentFiles.count() == s_maxSentFiles) {
+                qWarning("Connection %u sent more than %d file descriptors, capturing the oldest ones early", m_id, s_maxSentFiles);
+            }
+            if (m_sentFiles.count() >= s_maxSentFiles) {
+                captureSentFile(m_sentFiles.takeFirst());
+            }
+            m_sentFiles.append(qMakePair(copy, index));
+        }
+    }
+    m_recorder->record(record);
+
+    direction.pending.append(record.data);
+    direction.pendingFds.append(fds);
+    flush(direction);
+}
+
+void ProxyConnection::flush(Direction &direction)
+{
+    if (m_closed) {
+        return;
+    }
+    while (!direction.pending.isEmpty()) {
+        const qint64 count = Wire::trySend(direction.to, direction.pending.constData(), direction.pending.size(), &direction.pendingFds);
+        if (count < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // a peer that does not read must not make us buffer without bounds
+                direction.readNotifier->setEnabled(false);
+                direction.writeNotifier->setEnabled(true);
+            } else {
+                closeConnection();
+            }
+            return;
+        }
+        direction.pending.remove(0, count);
+    }
+    direction.writeNotifier->setEnabled(false);
+    direction.readNotifier->setEnabled(true);
+}
+
+void ProxyConnection::captureSentFile(const QPair<int, qint32> &file)
+{
+    if (!m_recorder->captureFile(file.first, file.second)) {
+        qWarning("Could not capture file descriptor %d of connection %u", file.second, m_id);
+    }
+    close(file.first);
+}
+
+void ProxyConnection::closeConnection()
+{
+    m_closed = true;
+    // we are called from one of the socket notifiers
+    deleteLater();
+}
+
+Recorder::~Recorder()
+{
+    // finish the connections while the writer is still around
+    qDeleteAll(findChildren<ProxyConnection *>(QString(), Qt::FindDirectChildrenOnly));
+    if (m_listenFd != -1) {
+        close(m_listenFd);
+        unlink(QFile::encodeName(m_socketPath).constData());
+    }
+}
+
+bool Recorder::listen(const QString &socketName)
+{
+    sockaddr_un address;
+    m_socketPath = socketPath(socketName);
+    if (!fillAddress(m_socketPath, &address)) {
+        return false;
+    }
+    m_listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (m_listenFd == -1) {
+        return false;
+    }
+    if (bind(m_listenFd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || ::listen(m_listenFd, 128) != 0) {
+        close(m_listenFd);
+        m_listenFd = -1;
+        return false;
+    }
+    auto notifier = new QSocketNotifier(m_listenFd, QSocketNotifier::Read, this);
+    connect(notifier, &QSocketNotifier::activated, this, &Recorder::handleNewConnection);
+    return true;
+}
+
+void Recorder::setUpstream(const QString &socketName)
+{
+    m_upstreamPath = socketPath(socketName);
+}
+
+bool Recorder::startRecording(const QString &directory)
+{
+    m_clock.start();
+    return m_writer.open(directory);
+}
+
+void Recorder::record(SessionRecord record)
+{
+    record.timestamp = m_clock.nsecsElapsed();
+    m_writer.write(record);
+}
+
+qint32 Recorder::nextFileIndex()
+{
+    return m_nextFileIndex++;
+}
+
+bool Recorder::captureFile(int fd, qint32 index)
+{
+    return m_writer.captureFile(fd, index);
+}
+
+void Recorder::handleNewConnection()
+{
+    const int clientFd = accept4(m_listenFd, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+    if (clientFd == -1) {
+        return;
+    }
+
+    sockaddr_un address;
+    const int serverFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (serverFd == -1 || !fillAddress(m_upstreamPath, &address)
+        || ::connect(serverFd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+        qWarning("Could not connect to the compositor at %s", qPrintable(m_upstreamPath));
+        if (serverFd != -1) {
+            close(serverFd);
+        }
+        close(clientFd);
+        return;
+    }
+    fcntl(serverFd, F_SETFL, fcntl(serverFd, F_GETFL) | O_NONBLOCK);
+    new ProxyConnection(m_nextConnectionId++, clientFd, serverFd, this);
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("kwayland-session-record"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Records the requests of Wayland clients connecting to the proxy socket"));
+    parser.addHelpOption();
+    QCommandLineOption socketOption(QStringLiteral("socket"),
+                                    QStringLiteral("The name of the proxy socket the clients connect to."),
+                                    QStringLiteral("name"),
+                                    QStringLiteral("wayland-record"));
+    QCommandLineOption upstreamOption(QStringLiteral("upstream"),
+                                      QStringLiteral("The socket of the compositor, by default $WAYLAND_DISPLAY."),
+                                      QStringLiteral("name"),
+                                      qEnvironmentVariable("WAYLAND_DISPLAY", QStringLiteral("wayland-0")));
+    parser.addOption(socketOption);
+    parser.addOption(upstreamOption);
+    parser.addPositionalArgument(QStringLiteral("directory"), QStringLiteral("The directory to write the recording to."));
+    parser.process(app);
+
+    if (parser.positionalArguments().count() != 1) {
+        parser.showHelp(1);
+    }
+
+    // every connection keeps the file descriptors its client sent open until it closes
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    Recorder recorder;
+    recorder.setUpstream(parser.value(upstreamOption));
+    if (!recorder.startRecording(parser.positionalArguments().constFirst())) {
+        qCritical("Could not create the recording in %s", qPrintable(parser.positionalArguments().constFirst()));
+        return 1;
+    }
+    if (!recorder.listen(parser.value(socketOption))) {
+        qCritical("Could not listen on %s", qPrintable(socketPath(parser.value(socketOption))));
+        return 1;
+    }
+
+    // stop on Ctrl+C, so the open connections get finished and their files captured
+    if (pipe2(s_signalPipe, O_CLOEXEC) != 0) {
+        return 1;
+    }
+    QSocketNotifier signalNotifier(s_signalPipe[0], QSocketNotifier::Read);
+    QObject::connect(&signalNotifier, &QSocketNotifier::activated, &app, &QCoreApplication::quit);
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGTERM, handleSignal);
+
+    qInfo("Recording clients connecting to WAYLAND_DISPLAY=%s", qPrintable(parser.value(socketOption)));
+    return app.exec();
+}
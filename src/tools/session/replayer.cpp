@@ -0,0 +1,162 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+// Replays a session recorded with kwayland-session-record against an in-process Display and
+// reports the time the server spent on every kind of request, see README.md in this directory.
+
+#include "sessionreplayer.h"
+
+#include "../../server/appmenu_interface.h"
+#include "../../server/blur_interface.h"
+#include "../../server/compositor_interface.h"
+#include "../../server/contrast_interface.h"
+#include "../../server/datadevicemanager_interface.h"
+#include "../../server/display.h"
+#include "../../server/idleinhibit_v1_interface.h"
+#include "../../server/output_interface.h"
+#include "../../server/plasmashell_interface.h"
+#include "../../server/pointerconstraints_v1_interface.h"
+#include "../../server/pointergestures_v1_interface.h"
+#include "../../server/primaryselectiondevicemanager_v1_interface.h"
+#include "../../server/protocoltracer.h"
+#include "../../server/relativepointer_v1_interface.h"
+#include "../../server/seat_interface.h"
+#include "../../server/server_decoration_interface.h"
+#include "../../server/shadow_interface.h"
+#include "../../server/slide_interface.h"
+#include "../../server/subcompositor_interface.h"
+#include "../../server/textinput_v2_interface.h"
+#include "../../server/textinput_v3_interface.h"
+#include "../../server/viewporter_interface.h"
+#include "../../server/xdgactivation_v1_interface.h"
+#include "../../server/xdgdecoration_v1_interface.h"
+#include "../../server/xdgoutput_v1_interface.h"
+#include "../../server/xdgshell_interface.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QTextStream>
+
+using namespace KWaylandServer;
+
+/**
+ * The globals a desktop session usually offers. Surfaces get configured right away, nothing
+ * is rendered.
+ */
+class ReplayCompositor : public QObject
+{
+public:
+    explicit ReplayCompositor(Display *display)
+    {
+        display->createShm();
+        new CompositorInterface(display, this);
+        new SubCompositorInterface(display, this);
+        new DataDeviceManagerInterface(display, this);
+        new PrimarySelectionDeviceManagerV1Interface(display, this);
+        new ViewporterInterface(display, this);
+        new RelativePointerManagerV1Interface(display, this);
+        new PointerConstraintsV1Interface(display, this);
+        new PointerGesturesV1Interface(display, this);
+        new IdleInhibitManagerV1Interface(display, this);
+        new XdgActivationV1Interface(display, this);
+        new TextInputManagerV2Interface(display, this);
+        new TextInputManagerV3Interface(display, this);
+        new ServerSideDecorationManagerInterface(display, this);
+        new BlurManagerInterface(display, this);
+        new ContrastManagerInterface(display, this);
+        new SlideManagerInterface(display, this);
+        new ShadowManagerInterface(display, this);
+        new AppMenuManagerInterface(display, this);
+        new PlasmaShellInterface(display, this);
+
+        auto output = new OutputInterface(display, this);
+        output->setMode(QSize(1920, 1080));
+        output->setPhysicalSize(QSize(520, 290));
+        auto xdgOutputManager = new XdgOutputManagerV1Interface(display, this);
+        auto xdgOutput = xdgOutputManager->createXdgOutput(output, this);
+        xdgOutput->setLogicalSize(QSize(1920, 1080));
+
+        auto seat = new SeatInterface(display, this);
+        seat->setName(QStringLiteral("seat0"));
+        seat->setHasPointer(true);
+        seat->setHasKeyboard(true);
+        seat->setHasTouch(true);
+
+        auto xdgShell = new XdgShellInterface(display, this);
+        connect(xdgShell, &XdgShellInterface::toplevelCreated, this, [](XdgToplevelInterface *toplevel) {
+            connect(toplevel, &XdgToplevelInterface::initializeRequested, toplevel, [toplevel]() {
+                toplevel->sendConfigure(QSize(), XdgToplevelInterface::States());
+            });
+        });
+        connect(xdgShell, &XdgShellInterface::popupCreated, this, [](XdgPopupInterface *popup) {
+            connect(popup, &XdgPopupInterface::initializeRequested, popup, [popup]() {
+                popup->sendConfigure(QRect(QPoint(0, 0), popup->positioner().size()));
+            });
+        });
+        new XdgDecorationManagerV1Interface(display, this);
+    }
+};
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("kwayland-session-replay"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Replays a recorded Wayland session and reports the server time per request"));
+    parser.addHelpOption();
+    QCommandLineOption realTimeOption(QStringLiteral("real-time"), QStringLiteral("Keep the recorded timing instead of replaying as fast as possible."));
+    QCommandLineOption traceOption(QStringLiteral("trace"),
+                                   QStringLiteral("Write a Chrome trace of the replay, needs a server library built with KWAYLAND_PROTOCOL_TRACING."),
+                                   QStringLiteral("file"));
+    parser.addOption(realTimeOption);
+    parser.addOption(traceOption);
+    parser.addPositionalArgument(QStringLiteral("directory"), QStringLiteral("The directory of the recording."));
+    parser.process(app);
+
+    if (parser.positionalArguments().count() != 1) {
+        parser.showHelp(1);
+    }
+
+    SessionReader reader;
+    if (!reader.open(parser.positionalArguments().constFirst())) {
+        qCritical("%s is not a session recording", qPrintable(parser.positionalArguments().constFirst()));
+        return 1;
+    }
+
+    const QString traceFile = parser.value(traceOption);
+    if (!traceFile.isEmpty()) {
+        if (!ProtocolTracer::isAvailable()) {
+            qCritical("The server library was built without KWAYLAND_PROTOCOL_TRACING");
+            return 1;
+        }
+        ProtocolTracer::setEnabled(true);
+    }
+
+    Display display;
+    ReplayCompositor compositor(&display);
+    // clients are created on socket pairs, the display does not need a socket
+    if (!display.start()) {
+        return 1;
+    }
+
+    Replayer replayer(&display);
+    if (!replayer.probeGlobals()) {
+        qCritical("Could not look up the globals of the replay compositor");
+        return 1;
+    }
+    replayer.replay(&reader, parser.isSet(realTimeOption));
+
+    QTextStream out(stdout);
+    replayer.printReport(out);
+
+    if (!traceFile.isEmpty()) {
+        QFile file(traceFile);
+        if (!file.open(QIODevice::WriteOnly) || !ProtocolTracer::writeChromeTrace(&file)) {
+            qCritical("Could not write the trace to %s", qPrintable(traceFile));
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,246 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#include "sessionrecording.h"
+
+#include <QDir>
+
+#include <cerrno>
+#include <cstring>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char s_magic[] = "KWWIRE01";
+static const int s_streamVersion = QDataStream::Qt_5_15;
+
+static QDataStream &operator<<(QDataStream &stream, const SessionRecord &record)
+{
+    return stream << quint8(record.type) << record.connection << record.timestamp << record.data << record.files;
+}
+
+static QDataStream &operator>>(QDataStream &stream, SessionRecord &record)
+{
+    quint8 type;
+    stream >> type >> record.connection >> record.timestamp >> record.data >> record.files;
+    record.type = SessionRecord::Type(type);
+    return stream;
+}
+
+bool SessionWriter::open(const QString &directory)
+{
+    if (!QDir().mkpath(directory)) {
+        return false;
+    }
+    m_directory = directory;
+    m_file.setFileName(QDir(directory).filePath(QStringLiteral("session.wire")));
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    m_stream.setDevice(&m_file);
+    m_stream.setVersion(s_streamVersion);
+    m_stream.writeRawData(s_magic, sizeof(s_magic) - 1);
+    return true;
+}
+
+void SessionWriter::write(const SessionRecord &record)
+{
+    m_stream << record;
+    // keep the recording usable if the recorder gets killed
+    m_file.flush();
+}
+
+bool SessionWriter::captureFile(int fd, qint32 index)
+{
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        return false;
+    }
+    QFile file(QDir(m_directory).filePath(QStringLiteral("fd-%1.bin").arg(index)));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    QByteArray buffer(64 * 1024, Qt::Uninitialized);
+    off_t offset = 0;
+    while (offset < info.st_size) {
+        const ssize_t count = pread(fd, buffer.data(), buffer.size(), offset);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0 || file.write(buffer.constData(), count) != count) {
+            return false;
+        }
+        offset += count;
+    }
+    return true;
+}
+
+bool SessionReader::open(const QString &directory)
+{
+    m_directory = directory;
+    m_file.setFileName(QDir(directory).filePath(QStringLiteral("session.wire")));
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    m_stream.setDevice(&m_file);
+    m_stream.setVersion(s_streamVersion);
+    char magic[sizeof(s_magic) - 1];
+    return m_stream.readRawData(magic, sizeof(magic)) == sizeof(magic) && std::memcmp(magic, s_magic, sizeof(magic)) == 0;
+}
+
+bool SessionReader::read(SessionRecord *record)
+{
+    if (m_stream.atEnd()) {
+        return false;
+    }
+    m_stream >> *record;
+    return m_stream.status() == QDataStream::Ok;
+}
+
+QString SessionReader::capturedFilePath(qint32 index) const
+{
+    return QDir(m_directory).filePath(QStringLiteral("fd-%1.bin").arg(index));
+}
+
+namespace Wire
+{
+static quint32 word(const char *data, int index)
+{
+    quint32 value;
+    std::memcpy(&value, data + index * sizeof(quint32), sizeof(value));
+    return value;
+}
+
+int messageSize(const QByteArray &data)
+{
+    if (data.size() < headerSize) {
+        return 0;
+    }
+    const int size = word(data.constData(), 1) >> 16;
+    if (size < headerSize || data.size() < size) {
+        return 0;
+    }
+    return size;
+}
+
+quint32 objectId(const char *message)
+{
+    return word(message, 0);
+}
+
+quint16 opcode(const char *message)
+{
+    return word(message, 1) & 0xffff;
+}
+
+quint32 argument(const char *message, int index)
+{
+    return word(message, 2 + index);
+}
+
+QByteArray stringArgument(const char *message, int size, int *offset)
+{
+    if (*offset + int(sizeof(quint32)) > size) {
+        return QByteArray();
+    }
+    quint32 length;
+    std::memcpy(&length, message + *offset, sizeof(length));
+    *offset += sizeof(quint32);
+    // the length includes the terminating null byte, the string is padded to 32 bits
+    const int padded = (length + 3) & ~3u;
+    if (length == 0 || *offset + padded > size) {
+        *offset += padded;
+        return QByteArray();
+    }
+    const QByteArray string(message + *offset, length - 1);
+    *offset += padded;
+    return string;
+}
+
+qint64 receive(int fd, QByteArray *data, QVector<int> *fds, bool blocking)
+{
+    char buffer[4096];
+    iovec io = {buffer, sizeof(buffer)};
+    char control[CMSG_SPACE(sizeof(int) * maxFileDescriptors)];
+
+    msghdr message = {};
+    message.msg_iov = &io;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+
+    ssize_t count;
+    do {
+        count = recvmsg(fd, &message, MSG_CMSG_CLOEXEC | (blocking ? 0 : MSG_DONTWAIT));
+    } while (count < 0 && errno == EINTR);
+    if (count < 0) {
+        return -1;
+    }
+
+    for (cmsghdr *header = CMSG_FIRSTHDR(&message); header; header = CMSG_NXTHDR(&message, header)) {
+        if (header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS) {
+            continue;
+        }
+        const int received = (header->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        const int *receivedFds = reinterpret_cast<const int *>(CMSG_DATA(header));
+        for (int i = 0; i < received; ++i) {
+            fds->append(receivedFds[i]);
+        }
+    }
+    if (message.msg_flags & MSG_CTRUNC) {
+        // the kernel closed the file descriptors that did not fit, the stream is broken
+        errno = EMSGSIZE;
+        return -1;
+    }
+    data->append(buffer, count);
+    return count;
+}
+
+qint64 trySend(int fd, const char *data, qint64 size, QVector<int> *fds)
+{
+    char control[CMSG_SPACE(sizeof(int) * maxFileDescriptors)] = {};
+    const int fdCount = fds ? qMin(fds->count(), maxFileDescriptors) : 0;
+    iovec io = {const_cast<char *>(data), size_t(fds && fds->count() > fdCount ? qMin<qint64>(size, 1) : size)};
+    msghdr message = {};
+    message.msg_iov = &io;
+    message.msg_iovlen = 1;
+    if (fdCount > 0) {
+        message.msg_control = control;
+        message.msg_controllen = CMSG_SPACE(sizeof(int) * fdCount);
+        cmsghdr *header = CMSG_FIRSTHDR(&message);
+        header->cmsg_level = SOL_SOCKET;
+        header->cmsg_type = SCM_RIGHTS;
+        header->cmsg_len = CMSG_LEN(sizeof(int) * fdCount);
+        std::memcpy(CMSG_DATA(header), fds->constData(), sizeof(int) * fdCount);
+    }
+
+    ssize_t count;
+    do {
+        count = sendmsg(fd, &message, MSG_NOSIGNAL);
+    } while (count < 0 && errno == EINTR);
+    if (count < 0) {
+        return -1;
+    }
+    for (int i = 0; i < fdCount; ++i) {
+        close(fds->at(i));
+    }
+    if (fdCount > 0) {
+        fds->remove(0, fdCount);
+    }
+    return count;
+}
+
+bool send(int fd, const QByteArray &data, QVector<int> *fds)
+{
+    qint64 offset = 0;
+    while (offset < data.size()) {
+        const qint64 count = trySend(fd, data.constData() + offset, data.size() - offset, fds);
+        if (count < 0) {
+            return false;
+        }
+        offset += count;
+    }
+    return true;
+}
+}
@@ -0,0 +1,120 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#pragma once
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+/**
+ * One entry of a session recording.
+ *
+ * The traffic is stored in the chunks it was read from the sockets, not split into messages,
+ * so a record can end in the middle of a message. The file descriptors sent along with a chunk
+ * of requests are referenced by the index of the file their content was captured to, or -1 if
+ * the descriptor could not be captured, e.g. a pipe or a dma-buf.
+ */
+struct SessionRecord {
+    enum class Type : quint8 {
+        Connected,
+        Disconnected,
+        Requests,
+        Events,
+    };
+
+    Type type = Type::Connected;
+    // the id of the client connection, unique within a recording
+    quint32 connection = 0;
+    // nanoseconds since the recording started
+    qint64 timestamp = 0;
+    QByteArray data;
+    QVector<qint32> files;
+};
+
+/**
+ * A recording is a directory with a @c session.wire file holding the records and a
+ * @c fd-<index>.bin file for every captured file descriptor.
+ */
+class SessionWriter
+{
+public:
+    bool open(const QString &directory);
+    void write(const SessionRecord &record);
+    /**
+     * Stores the content of @p fd, read from the start without moving the file offset, as
+     * the file with the given @p index.
+     */
+    bool captureFile(int fd, qint32 index);
+
+private:
+    QString m_directory;
+    QFile m_file;
+    QDataStream m_stream;
+};
+
+class SessionReader
+{
+public:
+    bool open(const QString &directory);
+    /**
+     * Reads the next record, returns @c false at the end of the recording.
+     */
+    bool read(SessionRecord *record);
+    QString capturedFilePath(qint32 index) const;
+
+private:
+    QString m_directory;
+    QFile m_file;
+    QDataStream m_stream;
+};
+
+/**
+ * Helpers to split the raw traffic of a connection into Wayland messages.
+ */
+namespace Wire
+{
+// every message starts with the object id and the size and opcode packed into one word
+constexpr int headerSize = 8;
+// libwayland never sends more file descriptors with one chunk
+constexpr int maxFileDescriptors = 28;
+
+/**
+ * Returns the size of the message at the start of @p data or 0 if @p data does not hold
+ * a complete message yet.
+ */
+int messageSize(const QByteArray &data);
+quint32 objectId(const char *message);
+quint16 opcode(const char *message);
+quint32 argument(const char *message, int index);
+/**
+ * Reads the string argument starting at the @p offset-th byte of the message.
+ * @p offset is advanced past the string.
+ */
+QByteArray stringArgument(const char *message, int size, int *offset);
+
+/**
+ * Reads from the socket @p fd, appending the received file descriptors to @p fds.
+ * Returns the number of bytes read, 0 once the peer closed the connection or -1 on error with
+ * @c errno set, @c EAGAIN if nothing can be read without blocking and @c EMSGSIZE if file
+ * descriptors got lost because more than maxFileDescriptors were sent with one chunk.
+ */
+qint64 receive(int fd, QByteArray *data, QVector<int> *fds, bool blocking);
+/**
+ * Writes as much of @p data to the socket @p fd as it takes with one call, sending up to
+ * maxFileDescriptors of @p fds along with it. The sent file descriptors are removed from
+ * @p fds and closed. If more than that many are queued, only one byte is written, so the
+ * remaining ones can follow with the next bytes.
+ * Returns the number of bytes written or -1 on error with @c errno set, @c EAGAIN if the
+ * non-blocking socket is full.
+ */
+qint64 trySend(int fd, const char *data, qint64 size, QVector<int> *fds);
+/**
+ * Writes all of @p data to the socket @p fd, sending @p fds with the first bytes. Fails with
+ * @c EAGAIN once a non-blocking socket is full. @p fds may be @c nullptr, the file
+ * descriptors that were not sent are left in it.
+ */
+bool send(int fd, const QByteArray &data, QVector<int> *fds);
+}
@@ -0,0 +1,353 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#include "sessionreplayer.h"
+
+#include "../../server/display.h"
+
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QTemporaryFile>
+#include <QTextStream>
+#include <QTimer>
+
+#include <algorithm>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace KWaylandServer;
+
+Replayer::Replayer(Display *display)
+    : m_display(display)
+{
+    m_logger = wl_display_add_protocol_logger(*m_display, loggerCallback, this);
+}
+
+Replayer::~Replayer()
+{
+    for (const Client &client : qAsConst(m_clients)) {
+        close(client.fd);
+        for (int fd : client.fds) {
+            close(fd);
+        }
+    }
+    wl_protocol_logger_destroy(m_logger);
+}
+
+void Replayer::loggerCallback(void *data, wl_protocol_logger_type type, const wl_protocol_logger_message *message)
+{
+    if (type != WL_PROTOCOL_LOGGER_REQUEST) {
+        return;
+    }
+    auto replayer = static_cast<Replayer *>(data);
+    replayer->m_dispatchedRequests.append(QByteArray(wl_resource_get_class(message->resource)) + '.' + message->message->name);
+}
+
+bool Replayer::probeGlobals()
+{
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0 || !m_display->createClient(fds[1])) {
+        return false;
+    }
+
+    // wl_display.get_registry(2) and wl_display.sync(3)
+    const quint32 request[] = {1, (12 << 16) | 1, 2, 1, (12 << 16) | 0, 3};
+    Wire::send(fds[0], QByteArray(reinterpret_cast<const char *>(request), sizeof(request)), nullptr);
+    m_display->dispatchEvents();
+    wl_display_flush_clients(*m_display);
+
+    QByteArray events;
+    bool done = false;
+    while (!done) {
+        QVector<int> received;
+        if (Wire::receive(fds[0], &events, &received, true) <= 0) {
+            break;
+        }
+        for (int fd : qAsConst(received)) {
+            close(fd);
+        }
+        while (const int size = Wire::messageSize(events)) {
+            const char *message = events.constData();
+            if (Wire::objectId(message) == 2 && Wire::opcode(message) == 0) {
+                int offset = Wire::headerSize + 4;
+                const QByteArray interface = Wire::stringArgument(message, size, &offset);
+                quint32 version;
+                std::memcpy(&version, message + offset, sizeof(version));
+                m_globals[interface].append(Global{Wire::argument(message, 0), version});
+            } else if (Wire::objectId(message) == 3) {
+                done = true;
+            }
+            events.remove(0, size);
+        }
+    }
+    close(fds[0]);
+    m_display->dispatchEvents();
+    m_dispatchedRequests.clear();
+    return done;
+}
+
+bool Replayer::replay(SessionReader *reader, bool realTime)
+{
+    QElapsedTimer clock;
+    clock.start();
+    qint64 firstTimestamp = -1;
+
+    SessionRecord record;
+    while (reader->read(&record)) {
+        if (firstTimestamp == -1) {
+            firstTimestamp = record.timestamp;
+        }
+        if (realTime && record.type == SessionRecord::Type::Requests) {
+            const qint64 delay = (record.timestamp - firstTimestamp - clock.nsecsElapsed()) / 1000000;
+            if (delay > 0) {
+                // keep the timers of the compositor running while waiting
+                QEventLoop loop;
+                QTimer::singleShot(delay, &loop, &QEventLoop::quit);
+                loop.exec();
+            }
+        }
+
+        switch (record.type) {
+        case SessionRecord::Type::Connected:
+            connectClient(record.connection);
+            break;
+        case SessionRecord::Type::Disconnected:
+            disconnectClient(record.connection);
+            break;
+        case SessionRecord::Type::Requests:
+            replayRequests(record.connection, record, reader);
+            break;
+        case SessionRecord::Type::Events:
+            if (m_clients.contains(record.connection)) {
+                recordGlobals(m_clients[record.connection], record.data);
+            }
+            break;
+        }
+    }
+    m_wallTime = clock.nsecsElapsed();
+    return true;
+}
+
+void Replayer::connectClient(quint32 id)
+{
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0) {
+        return;
+    }
+    if (!m_display->createClient(fds[1])) {
+        close(fds[0]);
+        close(fds[1]);
+        return;
+    }
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    Client client;
+    client.fd = fds[0];
+    m_clients.insert(id, client);
+}
+
+void Replayer::disconnectClient(quint32 id)
+{
+    auto it = m_clients.find(id);
+    if (it == m_clients.end()) {
+        return;
+    }
+    close(it->fd);
+    for (int fd : qAsConst(it->fds)) {
+        close(fd);
+    }
+    m_clients.erase(it);
+    // let the server clean up the client
+    m_display->dispatchEvents();
+    m_dispatchedRequests.clear();
+}
+
+void Replayer::replayRequests(quint32 id, const SessionRecord &record, SessionReader *reader)
+{
+    auto it = m_clients.find(id);
+    if (it == m_clients.end()) {
+        return;
+    }
+    Client &client = *it;
+    for (qint32 index : record.files) {
+        client.fds.append(openCapturedFile(reader, index));
+    }
+    client.requests.append(record.data);
+
+    while (const int size = Wire::messageSize(client.requests)) {
+        QByteArray message = client.requests.left(size);
+        client.requests.remove(0, size);
+        if (!client.alive || !rewrite(client, message)) {
+            ++m_droppedRequests;
+            continue;
+        }
+        sendRequest(client, message);
+    }
+}
+
+void Replayer::recordGlobals(Client &client, const QByteArray &data)
+{
+    client.recordedEvents.append(data);
+    while (const int size = Wire::messageSize(client.recordedEvents)) {
+        const char *message = client.recordedEvents.constData();
+        // wl_registry.global(name, interface, version)
+        if (client.registries.contains(Wire::objectId(message)) && Wire::opcode(message) == 0) {
+            const quint32 name = Wire::argument(message, 0);
+            int offset = Wire::headerSize + 4;
+            const QByteArray interface = Wire::stringArgument(message, size, &offset);
+            if (!m_recordedGlobals.contains(name)) {
+                m_recordedGlobals.insert(name, m_recordedGlobalCounts[interface]++);
+            }
+        }
+        client.recordedEvents.remove(0, size);
+    }
+}
+
+bool Replayer::rewrite(Client &client, QByteArray &message)
+{
+    const quint32 objectId = Wire::objectId(message.constData());
+    if (client.droppedObjects.contains(objectId)) {
+        return false;
+    }
+    const quint16 opcode = Wire::opcode(message.constData());
+
+    // wl_display.get_registry(registry)
+    if (objectId == 1 && opcode == 1) {
+        client.registries.insert(Wire::argument(message.constData(), 0));
+        return true;
+    }
+    // wl_registry.bind(name, interface, version, id)
+    if (!client.registries.contains(objectId) || opcode != 0) {
+        return true;
+    }
+    int offset = Wire::headerSize + 4;
+    const QByteArray interface = Wire::stringArgument(message.constData(), message.size(), &offset);
+    if (offset + 8 > message.size()) {
+        return false;
+    }
+    quint32 version;
+    quint32 newId;
+    std::memcpy(&version, message.constData() + offset, sizeof(version));
+    std::memcpy(&newId, message.constData() + offset + 4, sizeof(newId));
+
+    const QVector<Global> globals = m_globals.value(interface);
+    if (globals.isEmpty()) {
+        if (!m_missingGlobals.contains(interface)) {
+            qWarning("The replay compositor does not offer %s, dropping its requests", interface.constData());
+            m_missingGlobals.insert(interface);
+        }
+        client.droppedObjects.insert(newId);
+        return false;
+    }
+    const quint32 recordedName = Wire::argument(message.constData(), 0);
+    const Global &global = globals[qMin(m_recordedGlobals.value(recordedName), globals.count() - 1)];
+    version = qMin(version, global.version);
+    std::memcpy(message.data() + Wire::headerSize, &global.name, sizeof(global.name));
+    std::memcpy(message.data() + offset, &version, sizeof(version));
+    return true;
+}
+
+void Replayer::sendRequest(Client &client, const QByteArray &message)
+{
+    // the file descriptors go with the first request, libwayland queues them until they are used
+    const bool sent = Wire::send(client.fd, message, &client.fds);
+    // sent file descriptors are closed already, the others are not needed anymore
+    for (int fd : qAsConst(client.fds)) {
+        close(fd);
+    }
+    client.fds.clear();
+    if (!sent) {
+        client.alive = false;
+        return;
+    }
+
+    m_dispatchedRequests.clear();
+    QElapsedTimer timer;
+    timer.start();
+    m_display->dispatchEvents();
+    wl_display_flush_clients(*m_display);
+    const qint64 elapsed = timer.nsecsElapsed();
+    m_serverTime += elapsed;
+
+    // one request is written at a time, anything else is split evenly
+    const int count = m_dispatchedRequests.count();
+    for (const QByteArray &request : qAsConst(m_dispatchedRequests)) {
+        RequestStatistics &statistics = m_statistics[request];
+        ++statistics.count;
+        statistics.total += elapsed / count;
+        statistics.longest = std::max(statistics.longest, elapsed / count);
+    }
+    drainEvents();
+}
+
+void Replayer::drainEvents()
+{
+    for (auto it = m_clients.begin(); it != m_clients.end(); ++it) {
+        Client &client = *it;
+        while (client.alive) {
+            QVector<int> fds;
+            const qint64 count = Wire::receive(client.fd, &client.events, &fds, false);
+            for (int fd : qAsConst(fds)) {
+                close(fd);
+            }
+            if (count < 0) {
+                break;
+            }
+            if (count == 0) {
+                client.alive = false;
+                ++m_killedClients;
+            }
+        }
+        while (const int size = Wire::messageSize(client.events)) {
+            const char *message = client.events.constData();
+            // wl_display.error(object_id, code, message)
+            if (Wire::objectId(message) == 1 && Wire::opcode(message) == 0) {
+                int offset = Wire::headerSize + 8;
+                qWarning("Protocol error on object %u of connection %u: %s",
+                         Wire::argument(message, 0),
+                         it.key(),
+                         Wire::stringArgument(message, size, &offset).constData());
+            }
+            client.events.remove(0, size);
+        }
+    }
+}
+
+int Replayer::openCapturedFile(SessionReader *reader, qint32 index) const
+{
+    // the captured content is copied, so the replay cannot modify the recording
+    QFile captured(reader->capturedFilePath(index));
+    if (index != -1 && captured.open(QIODevice::ReadOnly)) {
+        QTemporaryFile copy;
+        if (copy.open() && copy.write(captured.readAll()) == captured.size() && copy.flush()) {
+            return dup(copy.handle());
+        }
+    }
+    // uncaptured file descriptors are replaced, e.g. pipes of data transfers
+    return open("/dev/null", O_RDWR | O_CLOEXEC);
+}
+
+void Replayer::printReport(QTextStream &stream) const
+{
+    QVector<QByteArray> requests = m_statistics.keys().toVector();
+    std::sort(requests.begin(), requests.end(), [this](const QByteArray &a, const QByteArray &b) {
+        return m_statistics[a].total > m_statistics[b].total;
+    });
+
+    stream << qSetFieldWidth(48) << Qt::left << "request" << qSetFieldWidth(10) << Qt::right << "count"
+           << qSetFieldWidth(14) << "total [ms]" << "mean [us]" << "max [us]" << qSetFieldWidth(0) << Qt::endl;
+    for (const QByteArray &request : qAsConst(requests)) {
+        const RequestStatistics &statistics = m_statistics[request];
+        stream << qSetFieldWidth(48) << Qt::left << request << qSetFieldWidth(10) << Qt::right << statistics.count
+               << qSetFieldWidth(14) << QString::number(statistics.total / 1e6, 'f', 3)
+               << QString::number(statistics.total / 1e3 / statistics.count, 'f', 1)
+               << QString::number(statistics.longest / 1e3, 'f', 1) << qSetFieldWidth(0) << Qt::endl;
+    }
+    stream << Qt::endl
+           << "server time: " << QString::number(m_serverTime / 1e6, 'f', 3) << " ms, replay time: " << QString::number(m_wallTime / 1e6, 'f', 3)
+           << " ms" << Qt::endl
+           << "dropped requests: " << m_droppedRequests << ", clients killed by protocol errors: " << m_killedClients << Qt::endl;
+}
@@ -0,0 +1,87 @@
+/*
+    SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only OR LicenseRef-KDE-Accepted-LGPL
+*/
+#pragma once
+
+#include "sessionrecording.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+
+#include <wayland-server-core.h>
+
+class QTextStream;
+
+namespace KWaylandServer
+{
+class Display;
+}
+
+/**
+ * Feeds the requests of a session recording to the clients of a Display, one request at a
+ * time, and measures the time the server spends on them.
+ */
+class Replayer
+{
+public:
+    explicit Replayer(KWaylandServer::Display *display);
+    ~Replayer();
+
+    /**
+     * Looks up the globals of the replay compositor, the recorded clients bind them under
+     * different names.
+     */
+    bool probeGlobals();
+    bool replay(SessionReader *reader, bool realTime);
+    void printReport(QTextStream &stream) const;
+
+private:
+    struct Global {
+        quint32 name;
+        quint32 version;
+    };
+    struct Client {
+        int fd = -1;
+        bool alive = true;
+        QByteArray requests;
+        QVector<int> fds;
+        QByteArray recordedEvents;
+        QByteArray events;
+        QSet<quint32> registries;
+        // objects created by binding globals the replay compositor does not offer
+        QSet<quint32> droppedObjects;
+    };
+    struct RequestStatistics {
+        quint64 count = 0;
+        qint64 total = 0;
+        qint64 longest = 0;
+    };
+
+    void connectClient(quint32 id);
+    void disconnectClient(quint32 id);
+    void replayRequests(quint32 id, const SessionRecord &record, SessionReader *reader);
+    void recordGlobals(Client &client, const QByteArray &data);
+    bool rewrite(Client &client, QByteArray &message);
+    void sendRequest(Client &client, const QByteArray &message);
+    void drainEvents();
+    int openCapturedFile(SessionReader *reader, qint32 index) const;
+
+    static void loggerCallback(void *data, wl_protocol_logger_type type, const wl_protocol_logger_message *message);
+
+    KWaylandServer::Display *m_display;
+    wl_protocol_logger *m_logger = nullptr;
+    QHash<QByteArray, QVector<Global>> m_globals;
+    // the recorded global names, mapped to their index among the globals of the same interface
+    QHash<quint32, int> m_recordedGlobals;
+    QHash<QByteArray, int> m_recordedGlobalCounts;
+    QHash<quint32, Client> m_clients;
+    QVector<QByteArray> m_dispatchedRequests;
+    QHash<QByteArray, RequestStatistics> m_statistics;
+    QSet<QByteArray> m_missingGlobals;
+    quint64 m_droppedRequests = 0;
+    quint64 m_killedClients = 0;
+    qint64 m_serverTime = 0;
+    qint64 m_wallTime = 0;
+};